@@ -15,6 +15,16 @@
 
 #include <benchmark/benchmark.h>
 #include <xci/core/string.h>
+#include <xci/core/log.h>
+#include <xci/core/event.h>
+#include <xci/core/ArgParser.h>
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <string>
+#include <filesystem>
+#include <fstream>
 
 using namespace xci::core;
 
@@ -27,4 +37,311 @@ static void bm_utf8_codepoint(benchmark::State& state) {
 BENCHMARK(bm_utf8_codepoint);
 
 
+// Sample text for UTF-8 benchmarks, about 64 KiB:
+// 0 = ASCII, 1 = mixed (Czech), 2 = CJK
+static std::string utf8_sample(int64_t kind) {
+    const char* piece[] = {
+        "The quick brown fox jumps over the lazy dog. ",
+        "Příliš žluťoučký kůň úpěl ďábelské ódy. ",
+        "河北梆子是中国北方的主要戏曲剧种之一。",
+    };
+    std::string text;
+    while (text.size() < 64 * 1024)
+        text += piece[kind];
+    return text;
+}
+
+static const char* utf8_sample_label(int64_t kind) {
+    const char* label[] = {"ascii", "mixed", "cjk"};
+    return label[kind];
+}
+
+
+static void bm_utf8_length(benchmark::State& state) {
+    const std::string text = utf8_sample(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(utf8_length(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(utf8_sample_label(state.range(0)));
+}
+BENCHMARK(bm_utf8_length)->DenseRange(0, 2);
+
+
+static void bm_utf8_validate(benchmark::State& state) {
+    const std::string text = utf8_sample(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(utf8_validate(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(utf8_sample_label(state.range(0)));
+}
+BENCHMARK(bm_utf8_validate)->DenseRange(0, 2);
+
+
+static void bm_to_utf32(benchmark::State& state) {
+    const std::string text = utf8_sample(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(to_utf32(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(utf8_sample_label(state.range(0)));
+}
+BENCHMARK(bm_to_utf32)->DenseRange(0, 2);
+
+
+// A list of paths, like the input of FileTree::walk
+static std::string path_list_sample() {
+    std::string text;
+    for (int i = 0; i != 1000; ++i)
+        text += "/usr/share/xcikit/fonts/Hack-Regular-" + std::to_string(i) + ".ttf\n";
+    return text;
+}
+
+
+static void bm_split_vector(benchmark::State& state) {
+    const std::string text = path_list_sample();
+    for (auto _ : state) {
+        size_t total = 0;
+        for (auto line : split(text, '\n'))
+            for (auto component : split(line, '/'))
+                total += component.size();
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(bm_split_vector);
+
+
+static void bm_split_view(benchmark::State& state) {
+    const std::string text = path_list_sample();
+    for (auto _ : state) {
+        size_t total = 0;
+        for (auto line : split_view(text, '\n'))
+            for (auto component : split_view(line, '/'))
+                total += component.size();
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(bm_split_view);
+
+
+static void bm_find_first_of(benchmark::State& state) {
+    const std::string text = std::string(4096, 'x') + ";";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(text.find_first_of(",;: "));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(bm_find_first_of);
+
+
+static void bm_charset_find_in(benchmark::State& state) {
+    const std::string text = std::string(4096, 'x') + ";";
+    const CharSet delims(",;: ");
+    for (auto _ : state)
+        benchmark::DoNotOptimize(delims.find_in(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(bm_charset_find_in);
+
+
+static void bm_rstripped(benchmark::State& state) {
+    const std::string path = "/usr/share/xcikit/fonts/Hack-Regular.ttf///";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(rstripped(path, '/'));
+}
+BENCHMARK(bm_rstripped);
+
+
+static void bm_rstrip_view(benchmark::State& state) {
+    const std::string path = "/usr/share/xcikit/fonts/Hack-Regular.ttf///";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(rstrip_view(path, '/'));
+}
+BENCHMARK(bm_rstrip_view);
+
+
+static void null_log_handler(Logger::Level, std::string_view msg) {
+    benchmark::DoNotOptimize(msg.data());
+}
+
+
+static void bm_log_suppressed(benchmark::State& state) {
+    auto& logger = Logger::default_instance(Logger::Level::Error);
+    logger.set_level(Logger::Level::Info);
+    logger.set_handler(null_log_handler);
+    std::string path = "/usr/share/xcikit/fonts/Hack-Regular.ttf";
+    for (auto _ : state)
+        log::debug("Vfs: try read {} with {} loader(s)", path, 2);
+    logger.set_handler(Logger::default_handler);
+}
+BENCHMARK(bm_log_suppressed);
+
+
+static void bm_log_emitted(benchmark::State& state) {
+    auto& logger = Logger::default_instance(Logger::Level::Error);
+    logger.set_level(Logger::Level::Trace);
+    logger.set_handler(null_log_handler);
+    std::string path = "/usr/share/xcikit/fonts/Hack-Regular.ttf";
+    for (auto _ : state)
+        log::debug("Vfs: try read {} with {} loader(s)", path, 2);
+    logger.set_handler(Logger::default_handler);
+}
+BENCHMARK(bm_log_emitted);
+
+
+// Log from N threads, measure the time spent in the logging threads.
+// Run with stderr redirected: `bm_core 2>/dev/null`
+static void log_from_threads(benchmark::State& state) {
+    constexpr int messages_per_thread = 1000;
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t != state.range(0); ++t) {
+            threads.emplace_back([] {
+                for (int i = 0; i != messages_per_thread; ++i)
+                    log::info("message {} from the thread", i);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * messages_per_thread);
+}
+
+
+static void bm_log_sync_mt(benchmark::State& state) {
+    auto& logger = Logger::default_instance(Logger::Level::Error);
+    logger.set_level(Logger::Level::Info);
+    log_from_threads(state);
+}
+BENCHMARK(bm_log_sync_mt)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+
+static void bm_log_async_mt(benchmark::State& state) {
+    auto& logger = Logger::default_instance(Logger::Level::Error);
+    logger.set_level(Logger::Level::Info);
+    auto sink = std::make_unique<AsyncLogSink>(logger);
+    log_from_threads(state);
+    state.counters["dropped"] = double(sink->dropped());
+}
+BENCHMARK(bm_log_async_mt)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+
+static void bm_timer_create(benchmark::State& state) {
+    EventLoop loop;
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<TimerWatch>> timers;
+        timers.reserve(state.range(0));
+        for (int i = 0; i != state.range(0); ++i)
+            timers.push_back(std::make_unique<TimerWatch>(loop,
+                    std::chrono::milliseconds{1000 + i % 5000}, []{}));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_timer_create)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
+static void bm_timer_restart(benchmark::State& state) {
+    EventLoop loop;
+    std::vector<std::unique_ptr<TimerWatch>> timers;
+    timers.reserve(state.range(0));
+    for (int i = 0; i != state.range(0); ++i)
+        timers.push_back(std::make_unique<TimerWatch>(loop,
+                std::chrono::milliseconds{1000 + i % 5000}, []{}));
+    for (auto _ : state) {
+        for (auto& timer : timers)
+            timer->restart();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_timer_restart)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
+// Command line with 100k file paths, like `ff -- FILE ...` from a job runner
+static std::vector<std::string> make_file_args(int64_t n) {
+    std::vector<std::string> paths;
+    paths.reserve(n);
+    for (int64_t i = 0; i != n; ++i)
+        paths.push_back("src/xci/module" + std::to_string(i % 100) + "/file" + std::to_string(i) + ".cpp");
+    return paths;
+}
+
+static std::vector<const char*> make_argv(const std::vector<std::string>& args, const char* first) {
+    std::vector<const char*> argv {first};
+    for (const auto& arg : args)
+        argv.push_back(arg.c_str());
+    argv.push_back(nullptr);
+    return argv;
+}
+
+
+static void bm_argparser_positional(benchmark::State& state) {
+    const auto paths = make_file_args(state.range(0));
+    const auto argv = make_argv(paths, "-v");
+    for (auto _ : state) {
+        bool verbose = false;
+        std::vector<std::string> files;
+        argparser::ArgParser {
+                argparser::Option("-v, --verbose", "Verbose", verbose),
+                argparser::Option("FILE ...", "Files", files),
+        }.parse_args(const_cast<const char**>(argv.data()));
+        benchmark::DoNotOptimize(files.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_argparser_positional)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
+static void bm_argparser_remainder_cb(benchmark::State& state) {
+    const auto paths = make_file_args(state.range(0));
+    const auto argv = make_argv(paths, "--");
+    for (auto _ : state) {
+        std::vector<std::string> files;
+        argparser::ArgParser {
+                argparser::Option("-- FILE ...", "Files", [&files](const char* arg)
+                    { files.emplace_back(arg); return true; }),
+        }.parse_args(const_cast<const char**>(argv.data()));
+        benchmark::DoNotOptimize(files.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_argparser_remainder_cb)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
+static void bm_argparser_remainder_bulk(benchmark::State& state) {
+    const auto paths = make_file_args(state.range(0));
+    const auto argv = make_argv(paths, "--");
+    for (auto _ : state) {
+        std::vector<const char*> files;
+        argparser::ArgParser {
+                argparser::Option("-- FILE ...", "Files", files),
+        }.parse_args(const_cast<const char**>(argv.data()));
+        benchmark::DoNotOptimize(files.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_argparser_remainder_bulk)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
+static void bm_argparser_response_file(benchmark::State& state) {
+    const auto path = (std::filesystem::temp_directory_path() / "bm_core_args.rsp").string();
+    {
+        std::ofstream f(path);
+        f << "--\n";
+        for (const auto& arg : make_file_args(state.range(0)))
+            f << arg << '\n';
+    }
+    const std::string arg = "@" + path;
+    const char* argv[] = {arg.c_str(), nullptr};
+    for (auto _ : state) {
+        std::vector<const char*> files;
+        argparser::ArgParser {
+                argparser::Option("-- FILE ...", "Files", files),
+        }.enable_response_files().parse_args(argv);
+        benchmark::DoNotOptimize(files.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove(path);
+}
+BENCHMARK(bm_argparser_response_file)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+
 BENCHMARK_MAIN();
@@ -0,0 +1,292 @@
+// bm_data.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include <benchmark/benchmark.h>
+#include <xci/data/BinaryWriter.h>
+#include <xci/data/BinaryReader.h>
+#include <xci/data/BinaryBufferReader.h>
+
+#include <streambuf>
+#include <ostream>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <string>
+
+using namespace xci::data;
+
+
+/// Discards all output, counts the bytes
+class NullBuffer : public std::streambuf {
+public:
+    size_t written() const { return m_written; }
+
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { m_written += n; return n; }
+    int_type overflow(int_type ch) override { ++m_written; return ch; }
+
+private:
+    size_t m_written = 0;
+};
+
+
+struct Leaf {
+    int32_t id = 0;
+    float x = 1.f, y = 2.f;
+    std::string name = "leaf";
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(id, x, y, name); }
+};
+
+struct Branch {
+    int32_t id = 0;
+    std::vector<Leaf> leaves;
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(id, leaves); }
+};
+
+struct Tree {
+    std::vector<Branch> branches;
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(branches); }
+};
+
+struct Forest {
+    std::vector<Tree> trees;
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(trees); }
+};
+
+
+static Forest make_forest(int n) {
+    Forest forest;
+    forest.trees.resize(n);
+    for (auto& tree : forest.trees) {
+        tree.branches.resize(n);
+        for (auto& branch : tree.branches)
+            branch.leaves.resize(n);
+    }
+    return forest;
+}
+
+
+static void bm_binary_writer_buffered(benchmark::State& state) {
+    auto forest = make_forest(state.range(0));
+    NullBuffer buf;
+    std::ostream os(&buf);
+    for (auto _ : state) {
+        BinaryWriter writer(os, true);
+        writer(forest);
+    }
+    state.SetBytesProcessed(buf.written());
+}
+BENCHMARK(bm_binary_writer_buffered)->Arg(10)->Arg(40)->Unit(benchmark::kMicrosecond);
+
+
+static void bm_binary_writer_single_pass(benchmark::State& state) {
+    auto forest = make_forest(state.range(0));
+    NullBuffer buf;
+    std::ostream os(&buf);
+    for (auto _ : state) {
+        BinaryWriter writer(os, true);
+        writer.write_single_pass(forest);
+    }
+    state.SetBytesProcessed(buf.written());
+}
+BENCHMARK(bm_binary_writer_single_pass)->Arg(10)->Arg(40)->Unit(benchmark::kMicrosecond);
+
+
+static std::string write_forest(int n) {
+    auto forest = make_forest(n);
+    std::ostringstream os;
+    {
+        BinaryWriter writer(os, true);
+        writer(forest);
+    }
+    return os.str();
+}
+
+
+static void bm_binary_reader_istream(benchmark::State& state) {
+    const std::string data = write_forest(state.range(0));
+    for (auto _ : state) {
+        std::istringstream is(data);
+        BinaryReader reader(is);
+        Forest forest;
+        reader(forest);
+        reader.finish_and_check();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(bm_binary_reader_istream)->Arg(10)->Arg(40)->Unit(benchmark::kMicrosecond);
+
+
+static void bm_binary_reader_buffer(benchmark::State& state) {
+    const std::string data = write_forest(state.range(0));
+    for (auto _ : state) {
+        BinaryBufferReader reader(std::span{(const std::byte*) data.data(), data.size()});
+        Forest forest;
+        reader(forest);
+        reader.finish_and_check();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(bm_binary_reader_buffer)->Arg(10)->Arg(40)->Unit(benchmark::kMicrosecond);
+
+
+// DialogState from examples/data/demo_serialize.cpp,
+// serialized by serialize() method (XCI_ARCHIVE) or compile-time schema
+struct DialogReply {
+    std::string text;
+    unsigned int next;
+
+    template <class Archive>
+    void serialize(Archive& ar) { XCI_ARCHIVE(ar, text, next); }
+};
+
+struct DialogState {
+    unsigned int id = 0;
+    std::string text;
+    std::vector<DialogReply> re;
+
+    template <class Archive>
+    void serialize(Archive& ar) { XCI_ARCHIVE(ar, id, text, re); }
+};
+
+struct SchemaDialogReply {
+    std::string text;
+    unsigned int next;
+
+    XCI_ARCHIVE_SCHEMA(SchemaDialogReply, text, next)
+};
+
+struct SchemaDialogState {
+    unsigned int id = 0;
+    std::string text;
+    std::vector<SchemaDialogReply> re;
+
+    XCI_ARCHIVE_SCHEMA(SchemaDialogState, id, text, re)
+};
+
+
+template <class TState>
+static std::vector<TState> make_dialog(size_t n) {
+    std::vector<TState> states(n);
+    for (size_t i = 0; i != n; ++i) {
+        states[i].id = unsigned(i);
+        states[i].text = "Use the stabilizers!";
+        states[i].re = {{"It doesn't have stabilizers!", 1}, {"What is a stabilizer?", 2}};
+    }
+    return states;
+}
+
+
+template <class TState>
+static void bm_dialog_write(benchmark::State& state) {
+    auto states = make_dialog<TState>(state.range(0));
+    NullBuffer buf;
+    std::ostream os(&buf);
+    for (auto _ : state) {
+        BinaryWriter writer(os);
+        writer.write_single_pass(states);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(bm_dialog_write, DialogState)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(bm_dialog_write, SchemaDialogState)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+
+
+template <class TState>
+static void bm_dialog_read(benchmark::State& state) {
+    std::ostringstream os;
+    {
+        auto states = make_dialog<TState>(state.range(0));
+        BinaryWriter writer(os);
+        writer(states);
+    }
+    const std::string data = os.str();
+    for (auto _ : state) {
+        BinaryBufferReader reader(std::span{(const std::byte*) data.data(), data.size()});
+        std::vector<TState> states;
+        reader(states);
+        benchmark::DoNotOptimize(states.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(bm_dialog_read, DialogState)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(bm_dialog_read, SchemaDialogState)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+
+
+// std::vector<float> is written as single Array chunk,
+// std::deque<float> item by item (non-contiguous)
+template <class TContainer>
+static void bm_float_array_write(benchmark::State& state) {
+    TContainer floats(state.range(0), 1.5f);
+    NullBuffer buf;
+    std::ostream os(&buf);
+    for (auto _ : state) {
+        BinaryWriter writer(os);
+        writer(floats);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(bm_float_array_write, std::vector<float>)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_float_array_write, std::deque<float>)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+
+template <class TContainer>
+static void bm_float_array_read(benchmark::State& state) {
+    std::ostringstream os;
+    {
+        TContainer floats(state.range(0), 1.5f);
+        BinaryWriter writer(os);
+        writer(floats);
+    }
+    const std::string data = os.str();
+    for (auto _ : state) {
+        BinaryBufferReader reader(std::span{(const std::byte*) data.data(), data.size()});
+        TContainer floats;
+        reader(floats);
+        benchmark::DoNotOptimize(floats.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(bm_float_array_read, std::vector<float>)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_float_array_read, std::deque<float>)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+
+static void bm_crc32(benchmark::State& state) {
+    std::vector<std::byte> data(state.range(0));
+    for (size_t i = 0; i != data.size(); ++i)
+        data[i] = std::byte(i * 7);
+    for (auto _ : state) {
+        Crc32 crc;
+        benchmark::DoNotOptimize(crc(data));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(bm_crc32)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMicrosecond);
+
+
+static void bm_crc32c(benchmark::State& state) {
+    std::vector<std::byte> data(state.range(0));
+    for (size_t i = 0; i != data.size(); ++i)
+        data[i] = std::byte(i * 7);
+    for (auto _ : state) {
+        Crc32 crc(Crc32::Variant::Castagnoli);
+        benchmark::DoNotOptimize(crc(data));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.SetLabel(Crc32::has_hw_crc32c() ? "hw" : "sw");
+}
+BENCHMARK(bm_crc32c)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMicrosecond);
+
+
+BENCHMARK_MAIN();
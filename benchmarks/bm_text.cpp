@@ -0,0 +1,412 @@
+// bm_text.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include <benchmark/benchmark.h>
+#include <xci/text/Layout.h>
+#include <xci/text/Markup.h>
+#include <xci/text/Font.h>
+#include <xci/text/FontLibrary.h>
+#include <xci/text/GlyphRasterizer.h>
+#include <xci/graphics/Window.h>
+#include <xci/core/Vfs.h>
+#include <xci/core/string.h>
+#include <xci/config.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace xci::text;
+using namespace xci::graphics;
+using namespace xci::core;
+
+
+// Allocation counters for memory usage (see bm_layout_markup)
+// The counting is enabled only by the benchmark which reports them.
+static std::atomic_bool g_alloc_counting {false};
+static std::atomic<size_t> g_alloc_count {0};
+static std::atomic<size_t> g_alloc_bytes {0};
+
+void* operator new(size_t size)
+{
+    if (g_alloc_counting.load(std::memory_order_relaxed)) {
+        g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+        g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+
+// Renderer, window and font are created once for all benchmarks
+struct TextEnv {
+    Vfs vfs;
+    Renderer renderer {vfs};
+    Window window {renderer};
+    View view {&window};
+    Font font {renderer};
+
+    TextEnv() {
+        vfs.mount(XCI_SHARE);
+        window.create({800, 600}, "bm_text");
+        view.set_screen_size({800, 600});
+        font.add_face(vfs, "fonts/ShareTechMono/ShareTechMono-Regular.ttf", 0);
+    }
+
+    static TextEnv& instance() {
+        static TextEnv env;
+        return env;
+    }
+};
+
+
+// Page of text: `words` words, with a color change every 50 words
+static void fill_layout(Layout& layout, Font& font, int64_t words)
+{
+    static const char* sample[] = {
+        "One", "morning,", "when", "Gregor", "Samsa", "woke", "from",
+        "troubled", "dreams,", "he", "found", "himself", "transformed",
+    };
+    layout.set_default_font(&font);
+    layout.set_default_font_size(0.05f);
+    layout.set_default_page_width(2.5f);
+    for (int64_t i = 0; i != words; ++i) {
+        if (i % 50 == 0)
+            layout.set_color(i % 100 == 0 ? Color::White() : Color::Yellow());
+        layout.add_word(sample[i % std::size(sample)]);
+        layout.add_space();
+    }
+}
+
+
+// Layout::update - recreate graphics objects of the page
+// Arg 0: number of words, Arg 1: batched mode
+static void bm_layout_update(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    Layout layout;
+    layout.set_batched(state.range(1) != 0);
+    fill_layout(layout, env.font, state.range(0));
+    layout.typeset(env.view);
+
+    for (auto _ : state) {
+        layout.update(env.view);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_layout_update)
+        ->ArgNames({"words", "batched"})
+        ->ArgsProduct({{100, 1000}, {0, 1}})
+        ->Unit(benchmark::kMicrosecond);
+
+
+// Layout::typeset after appending a line to a page of 10k lines
+// Arg: 0 = full typeset (default style reset), 1 = incremental
+static void bm_layout_append(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    const bool incremental = state.range(0) != 0;
+    Layout layout;
+    fill_layout(layout, env.font, 0);
+    const auto add_line = [&layout] {
+        for (const char* word : {"he", "lay", "on", "his", "armour-like", "back"}) {
+            layout.add_word(word);
+            layout.add_space();
+        }
+        layout.finish_line();
+    };
+    for (int i = 0; i != 10'000; ++i)
+        add_line();
+    layout.typeset(env.view);
+
+    for (auto _ : state) {
+        add_line();
+        if (!incremental)
+            layout.set_default_font_size(0.05f);
+        layout.typeset(env.view);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(bm_layout_append)->ArgName("incremental")->Arg(0)->Arg(1)
+        ->Unit(benchmark::kMicrosecond);
+
+
+// Scrolling through 100k lines: move the visible region by one line, then update
+// Arg: 0 = whole page is updated, 1 = visible region of 50 lines
+static void bm_layout_scroll(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    const bool culling = state.range(0) != 0;
+    Layout layout;
+    fill_layout(layout, env.font, 0);
+    for (int i = 0; i != 100'000; ++i) {
+        for (const char* word : {"log", "line", "number"}) {
+            layout.add_word(word);
+            layout.add_space();
+        }
+        layout.add_word(std::to_string(i));
+        layout.finish_line();
+    }
+    layout.typeset(env.view);
+    const auto line_height = layout.bbox().h / 100'000;
+
+    ViewportRect region {0.f, 0.f, 2.5f, 50 * line_height};
+    for (auto _ : state) {
+        region.y += line_height;
+        if (culling)
+            layout.set_visible_region(region);
+        layout.update(env.view);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(bm_layout_scroll)->ArgName("culling")->Arg(0)->Arg(1)
+        ->Unit(benchmark::kMicrosecond);
+
+
+// Markup document of `size` bytes: paragraphs with tabs and line breaks
+static std::string make_markup_document(size_t size)
+{
+    static const char* paragraph =
+        "One morning, when Gregor Samsa woke from troubled dreams, he found "
+        "himself transformed in his bed into a horrible vermin.{br}"
+        "{tab}He lay on his armour-like back, and if he lifted his head "
+        "a little he could see his brown belly, slightly domed and divided "
+        "by arches into stiff sections.\n\n";
+    std::string doc;
+    doc.reserve(size + 512);
+    for (unsigned n = 0; doc.size() < size; ++n) {
+        doc += paragraph;
+        doc += std::to_string(n);  // some distinct words
+        doc += "\n\n";
+    }
+    return doc;
+}
+
+
+// Parse 1 MB markup document into Layout and typeset it
+// Counters: number of elements, heap allocations and allocated bytes
+// per document in parse and typeset phase
+static void bm_layout_markup(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    const std::string doc = make_markup_document(1024 * 1024);
+    size_t elements = 0;
+    size_t parse_allocs = 0, parse_bytes = 0;
+    size_t typeset_allocs = 0, typeset_bytes = 0;
+    g_alloc_counting = true;
+    for (auto _ : state) {
+        Layout layout;
+        fill_layout(layout, env.font, 0);
+
+        const size_t count0 = g_alloc_count, bytes0 = g_alloc_bytes;
+        Markup markup(layout, doc);
+        const size_t count1 = g_alloc_count, bytes1 = g_alloc_bytes;
+        layout.typeset(env.view);
+        const size_t count2 = g_alloc_count, bytes2 = g_alloc_bytes;
+
+        elements = layout.element_count();
+        parse_allocs += count1 - count0;
+        parse_bytes += bytes1 - bytes0;
+        typeset_allocs += count2 - count1;
+        typeset_bytes += bytes2 - bytes1;
+    }
+    g_alloc_counting = false;
+    using benchmark::Counter;
+    state.counters["elements"] = Counter(double(elements));
+    state.counters["parse_allocs"] = Counter(double(parse_allocs), Counter::kAvgIterations);
+    state.counters["parse_bytes"] = Counter(double(parse_bytes), Counter::kAvgIterations, Counter::kIs1024);
+    state.counters["typeset_allocs"] = Counter(double(typeset_allocs), Counter::kAvgIterations);
+    state.counters["typeset_bytes"] = Counter(double(typeset_bytes), Counter::kAvgIterations, Counter::kIs1024);
+    state.SetBytesProcessed(int64_t(state.iterations() * doc.size()));
+}
+BENCHMARK(bm_layout_markup)->Unit(benchmark::kMillisecond);
+
+
+// English (Latin-1) and Czech paragraph
+static const char* c_paragraph[] = {
+    "One morning, when Gregor Samsa woke from troubled dreams, he found "
+    "himself transformed in his bed into a horrible vermin. He lay on his "
+    "armour-like back, and if he lifted his head a little he could see his "
+    "brown belly, slightly domed and divided by arches into stiff sections.",
+    "Když se Řehoř Samsa jednoho rána probudil z nepokojných snů, shledal, "
+    "že se v posteli proměnil v jakýsi nestvůrný hmyz. Ležel na zádech "
+    "tvrdých jako pancíř, a když trochu pozvedl hlavu, uviděl své klenuté "
+    "hnědé břicho rozdělené obloukovitými výztuhami.",
+};
+
+
+// Font::get_glyph for each character of a paragraph
+// Arg 0: Latin-1 text (direct-mapped table), 1: Czech text (hash table)
+static void bm_font_get_glyph(benchmark::State& state)
+{
+    const char* const* paragraph = c_paragraph;
+    auto& env = TextEnv::instance();
+    const auto code_points = to_utf32(paragraph[state.range(0)]);
+    env.font.set_size(20);
+    // warm up the cache
+    for (auto c : code_points)
+        env.font.get_glyph(c);
+
+    for (auto _ : state) {
+        for (auto c : code_points)
+            benchmark::DoNotOptimize(env.font.get_glyph(c));
+    }
+    state.SetItemsProcessed(state.iterations() * code_points.size());
+}
+BENCHMARK(bm_font_get_glyph)->Arg(0)->Arg(1);
+
+
+// Font::shape for each word of both paragraphs, in several sizes
+// Arg: shape cache capacity (0 = no cache)
+static void bm_font_shape(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    std::vector<std::string_view> words;
+    for (std::string_view text : c_paragraph) {
+        while (!text.empty()) {
+            const auto space = text.find(' ');
+            words.push_back(text.substr(0, space));
+            text.remove_prefix(space == std::string_view::npos ? text.size() : space + 1);
+        }
+    }
+    const auto capacity = env.font.shape_cache().capacity();
+    env.font.shape_cache().set_capacity(size_t(state.range(0)));
+    for (auto _ : state) {
+        for (unsigned size = 12; size <= 24; size += 4) {
+            env.font.set_size(size);
+            for (auto word : words)
+                benchmark::DoNotOptimize(env.font.shape(word).size());
+        }
+    }
+    env.font.shape_cache().set_capacity(capacity);
+    state.SetItemsProcessed(int64_t(state.iterations() * 4 * words.size()));
+}
+BENCHMARK(bm_font_shape)->ArgName("cache")->Arg(0)->Arg(4096);
+
+
+// Render all glyphs of a font in several sizes (CPU only, no Vulkan)
+// Arg: number of worker threads, 0 = render synchronously
+static void bm_glyph_rasterizer(benchmark::State& state)
+{
+    Vfs vfs;
+    vfs.mount(XCI_SHARE);
+    auto face = FontLibrary::default_instance()->create_font_face();
+    auto file = vfs.read_file("fonts/Enriqueta/Enriqueta-Regular.ttf");
+    if (!file.is_open() || !face->load_from_memory(file.content(), 0)) {
+        state.SkipWithError("font not found");
+        return;
+    }
+
+    std::vector<GlyphRasterizer::Job> jobs;
+    for (unsigned size = 16; size <= 64; size += 8) {
+        for (CodePoint c = 0x20; c != 0x10000; ++c) {
+            if (face->get_glyph_index(c) != 0)
+                jobs.push_back({face.get(), size, c, jobs.size()});
+        }
+    }
+
+    const auto num_threads = unsigned(state.range(0));
+    std::vector<GlyphRasterizer::Result> results;
+    for (auto _ : state) {
+        if (num_threads == 0) {
+            unsigned size = 0;
+            for (const auto& job : jobs) {
+                if (job.size != size)
+                    face->set_size(size = job.size);
+                FontFace::Glyph glyph;
+                face->render_glyph(face->get_glyph_index(job.code_point), glyph);
+                benchmark::DoNotOptimize(glyph.bitmap_buffer);
+            }
+        } else {
+            GlyphRasterizer rasterizer(num_threads);
+            rasterizer.submit(jobs);
+            rasterizer.wait();
+            results.clear();
+            rasterizer.collect(results);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * jobs.size());
+}
+BENCHMARK(bm_glyph_rasterizer)->ArgName("threads")->Arg(0)->Arg(1)->Arg(2)->Arg(4)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+// Fill glyph cache of a new Font: Latin-1 and Latin Extended-A in three sizes
+// Arg 0: render the glyphs, 1: load them from persistent cache
+static void bm_font_cold_start(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    const auto cache_path = (std::filesystem::temp_directory_path() / "bm_text_glyphs.cache").string();
+    const char* font_path = "fonts/ShareTechMono/ShareTechMono-Regular.ttf";
+    auto fill_cache = [](Font& font) {
+        for (unsigned size : {14, 20, 32}) {
+            font.set_size(size);
+            for (CodePoint c = 0x20; c != 0x180; ++c)
+                font.get_glyph(c);
+        }
+    };
+    {
+        Font font {env.renderer};
+        if (!font.add_face(env.vfs, font_path, 0)) {
+            state.SkipWithError("font not found");
+            return;
+        }
+        fill_cache(font);
+        font.save_cache(cache_path);
+    }
+
+    const bool use_cache = state.range(0) != 0;
+    for (auto _ : state) {
+        Font font {env.renderer};
+        font.add_face(env.vfs, font_path, 0);
+        if (use_cache)
+            font.load_cache(cache_path);
+        else
+            fill_cache(font);
+        benchmark::DoNotOptimize(font.cache_stats());
+    }
+    std::filesystem::remove(cache_path);
+}
+BENCHMARK(bm_font_cold_start)->ArgName("cached")->Arg(0)->Arg(1)
+        ->Unit(benchmark::kMillisecond);
+
+
+// Zoom: printable ASCII in 13 font sizes, with a new Font each iteration
+// Arg: render mode (0 = normal, 1 = SDF)
+static void bm_font_zoom(benchmark::State& state)
+{
+    auto& env = TextEnv::instance();
+    const auto mode = RenderMode(state.range(0));
+    uint64_t rendered = 0;
+    for (auto _ : state) {
+        Font font {env.renderer};
+        if (!font.set_render_mode(mode)
+        || !font.add_face(env.vfs, "fonts/ShareTechMono/ShareTechMono-Regular.ttf", 0)) {
+            state.SkipWithError("font not found");
+            return;
+        }
+        for (unsigned size = 12; size <= 60; size += 4) {
+            font.set_size(size);
+            for (CodePoint c = 0x20; c != 0x7F; ++c)
+                benchmark::DoNotOptimize(font.get_glyph(c));
+        }
+        rendered += font.cache_stats().misses;
+    }
+    state.counters["rendered"] = benchmark::Counter(double(rendered), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * 13 * (0x7F - 0x20));
+}
+BENCHMARK(bm_font_zoom)->ArgName("sdf")->Arg(0)->Arg(1)
+        ->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,17 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 1) uniform sampler2D u_tex_sampler;
+
+layout(location = 0) in vec4 in_color;
+layout(location = 1) in vec2 in_tex_coord;
+
+layout(location = 0) out vec4 out_color;
+
+// Signed distance field, see sprite_sdf.frag
+void main() {
+    float dist = texture(u_tex_sampler, in_tex_coord).r;
+    float width = fwidth(dist);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+    out_color = vec4(in_color.rgb, in_color.a * alpha);
+}
@@ -0,0 +1,18 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 1) uniform Uniform { vec4 color; } uni;
+layout(binding = 2) uniform sampler2D u_tex_sampler;
+
+layout(location = 0) in vec2 in_tex_coord;
+
+layout(location = 0) out vec4 out_color;
+
+// The texture contains signed distance field: 0.5 is the edge, inside is > 0.5.
+// The edge is smoothed over one screen pixel, whatever the scale is.
+void main() {
+    float dist = texture(u_tex_sampler, in_tex_coord).r;
+    float width = fwidth(dist);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+    out_color = vec4(uni.color.rgb, uni.color.a * alpha);
+}
@@ -12,6 +12,7 @@
 #include <fmt/core.h>
 #include <iostream>
 #include <utility>
+#include <memory>
 #include <cstring>
 #include <cassert>
 #include <algorithm>
@@ -111,6 +112,15 @@ bool Option::has_long(const char* arg) const
 }
 
 
+bool Option::receive_all(const char* const* args, size_t count)
+{
+    m_received += int(count);
+    if (m_bulk_cb)
+        return m_bulk_cb(args, count);
+    return std::all_of(args, args + count, [this](const char* arg) { return m_cb(arg); });
+}
+
+
 int Option::missing_args() const
 {
     return max(m_required - m_received, 0);
@@ -334,20 +344,19 @@ bool ArgParser::parse_program_name(const char* arg0)
 
 void ArgParser::parse_env()
 {
-    char** env = environ;
-    while (*env) {
-        auto s = split(*env, '=', 1);
-        if (s.size() != 2)
+    for (char** env = environ; *env; ++env) {
+        const std::string_view entry(*env);
+        const auto eq = entry.find('=');
+        if (eq == std::string_view::npos)
             continue;
-        auto key = s[0];
-        auto val = s[1];
+        auto key = entry.substr(0, eq);
+        auto val = entry.substr(eq + 1);
         auto it = find_if(m_opts.begin(), m_opts.end(),
                 [&key](const Option& opt) { return opt.has_env(key); });
         if (it != m_opts.end()) {
             assert(!it->is_show_help());  // help can't be invoked via env
             it->eval_env(val.data());
         }
-        ++env;
     }
 }
 
@@ -355,9 +364,14 @@ void ArgParser::parse_env()
 ArgParser::ParseResult ArgParser::parse_args(const char** argv, bool finish)
 {
     while (*argv) {
-        switch (parse_arg(argv++)) {
+        const bool response_file = m_response_files && (*argv)[0] == '@' && (*argv)[1] != '\0';
+        switch (response_file ? parse_response_file(argv++) : parse_arg(argv++)) {
             case Continue:  continue;
-            case Stop:      return Stop;
+            case Stop:
+                // "--" in response file - pass also the rest of argv to remainder
+                if (response_file && m_remainder_started && !invoke_remainder(argv))
+                    throw BadArgument(format("Wrong remainder arguments after: {}", *(argv-1)));
+                return Stop;
             case Exit:      return Exit;
         }
     }
@@ -469,6 +483,58 @@ ArgParser::ParseResult ArgParser::parse_arg(const char* argv[])
 }
 
 
+ArgParser::ParseResult ArgParser::parse_response_file(const char* argv[])
+{
+    const char* pathname = *argv + 1;  // skip '@'
+    if (std::find(m_response_stack.begin(), m_response_stack.end(), pathname) != m_response_stack.end())
+        throw BadArgument(format("Response file includes itself: {}", pathname));
+    if (m_response_stack.size() >= max_response_file_depth)
+        throw BadArgument(format("Response files nested too deep: {}", pathname));
+    auto buffer = map_file(pathname);
+    if (!buffer)
+        throw BadArgument(format("Cannot read response file: {}", pathname));
+
+    // One argument per line. The lines are terminated in place (the mapping
+    // is private), so the arguments are C strings pointing to the mapped file.
+    // The first item is the "@FILE" argument itself, so error messages can
+    // refer to the previous argument, same as with argv.
+    auto* data = (char*) buffer->data();
+    const size_t size = buffer->size();
+    std::vector<const char*> args {*argv};
+    size_t pos = 0;
+    while (pos < size) {
+        const auto* nl = (const char*) std::memchr(data + pos, '\n', size - pos);
+        const size_t end = nl ? size_t(nl - data) : size;
+        size_t line_end = end;
+        if (line_end != pos && data[line_end - 1] == '\r')
+            --line_end;
+        if (line_end != pos) {
+            if (line_end == size) {
+                // last line without newline - there is no room for terminator
+                const size_t len = line_end - pos;
+                auto& line = m_response_lines.emplace_back(new char[len + 1]);
+                std::memcpy(line.get(), data + pos, len);
+                line[len] = '\0';
+                args.push_back(line.get());
+            } else {
+                data[line_end] = '\0';
+                args.push_back(data + pos);
+            }
+        }
+        pos = end + 1;
+    }
+    args.push_back(nullptr);
+    m_response_buffers.push_back(std::move(buffer));
+
+    m_response_stack.emplace_back(pathname);
+    struct PopGuard {
+        std::vector<std::string_view>& stack;
+        ~PopGuard() { stack.pop_back(); }
+    } pop_guard {m_response_stack};
+    return parse_args(args.data() + 1, false);
+}
+
+
 void ArgParser::print_usage() const
 {
     auto& t = TermCtl::stdout_instance();
@@ -513,12 +579,11 @@ bool ArgParser::invoke_remainder(const char** argv)
     if (it == m_opts.end())
         return false;
 
-    while (*argv) {
-        if (!(*it)(*argv))
-            return false;
-        ++argv;
-    }
-    return true;
+    m_remainder_started = true;
+    size_t count = 0;
+    while (argv[count])
+        ++count;
+    return it->receive_all(argv, count);
 }
 
 
@@ -8,8 +8,10 @@
 #define XCI_CORE_ARG_PARSER_H
 
 #include <xci/core/error.h>
+#include <xci/core/Buffer.h>
 #include <xci/compat/unistd.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <functional>
@@ -18,6 +20,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <limits>
+#include <memory>
 
 namespace xci::core::argparser {
 
@@ -104,6 +107,9 @@ struct Option {
     using FlagCallback = std::function<void()>;
     using ArgCallback = std::function<bool(const char* arg)>;
 
+    /// Receives all remaining args at once (after "--"), see `receive_all`
+    using BulkCallback = std::function<bool(const char* const* args, size_t count)>;
+
     /// This is the real, non-convenient constructor. See other constructors
     /// for some more convenience (simpler callbacks, direct binding of values etc.)
     ///
@@ -152,6 +158,29 @@ struct Option {
             : Option(std::move(desc), std::move(help), [&value](const char* arg)
                      { return value_from_cstr(arg, value); }, 0) {}
 
+    /// Declare option to append values to a vector.
+    /// When used for remainder ("-- FILE ..."), the remaining args are appended
+    /// all at once. Vectors of `const char*` and `std::string_view` just copy
+    /// the pointers, without parsing each arg.
+    template <class T>
+    Option(std::string desc, std::string help, std::vector<T>& values)
+            : Option(std::move(desc), std::move(help), [&values](const char* arg)
+                     { return value_from_cstr(arg, values); }, 0)
+    {
+        m_bulk_cb = [&values](const char* const* args, size_t count) {
+            values.reserve(values.size() + count);
+            if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, std::string_view>) {
+                values.insert(values.end(), args, args + count);
+            } else {
+                for (size_t i = 0; i != count; ++i) {
+                    if (!value_from_cstr(args[i], values))
+                        return false;
+                }
+            }
+            return true;
+        };
+    }
+
     /// Attach env variable to this option
     Option& env(const char* env) { m_env = env; return *this; }
 
@@ -179,6 +208,7 @@ struct Option {
     void foreach_name(const std::function<void(char shortopt, std::string_view longopt)>& cb) const;
 
     bool operator() (const char* arg) { ++m_received; return m_cb(arg); }
+    bool receive_all(const char* const* args, size_t count);
     void eval_env(const char* env) { m_cb(env); }
 
 private:
@@ -202,6 +232,7 @@ private:
     std::string m_help;
     const char* m_env = nullptr;
     Callback m_cb;
+    BulkCallback m_bulk_cb;
     enum Flags {
         FShort      = (1 << 0),
         FLong       = (1 << 1),
@@ -276,6 +307,18 @@ public:
     /// Parse a single argument
     ParseResult parse_arg(const char* argv[]);
 
+    /// Expand arguments starting with '@' as response files: "@FILE" is replaced
+    /// by arguments read from FILE, one per line (empty lines are ignored).
+    /// The file is mapped to memory and kept alive by the ArgParser, so the
+    /// arguments are passed to options without copying. They remain valid
+    /// until the ArgParser is destroyed. Response files may be nested
+    /// up to `max_response_file_depth`, a file must not include itself.
+    ArgParser& enable_response_files() { m_response_files = true; return *this; }
+
+    /// Parse arguments from a response file, as if they were given in argv
+    /// \param argv     the response file argument ("@FILE")
+    ParseResult parse_response_file(const char* argv[]);
+
     /// Print short usage information
     void print_usage() const;
 
@@ -285,6 +328,8 @@ public:
     /// Print information how to invoke help
     void print_help_notice() const;
 
+    static constexpr unsigned max_response_file_depth = 16;
+
 private:
     bool invoke_remainder(const char** argv);
 
@@ -292,6 +337,11 @@ private:
     std::vector<Option> m_opts;
     Option* m_curopt = nullptr;
     bool m_awaiting_arg = false;
+    bool m_response_files = false;
+    bool m_remainder_started = false;  // "--" was processed, the rest goes to remainder
+    std::vector<BufferPtr> m_response_buffers;  // mapped response files
+    std::vector<std::unique_ptr<char[]>> m_response_lines;  // copied last lines (without newline)
+    std::vector<std::string_view> m_response_stack;  // paths of response files being parsed
 };
 
 
@@ -84,6 +84,15 @@ public:
             return rc == 0;
         }
 
+        /// Open reported file, e.g. to read its content.
+        /// (Directories are already open, see `fd`.)
+        /// \returns    new FD (caller should close it) or -1 on error (check errno)
+        int open_file(int flags = O_RDONLY) const {
+            if (parent && parent->fd != -1)
+                return openat(parent->fd, component.c_str(), flags | O_NOCTTY);
+            return ::open(file_name().c_str(), flags | O_NOCTTY);
+        }
+
         /// Is this a node from input, i.e. `walk()`?
         bool is_input() const {
             return flags & f_input;
@@ -141,7 +150,7 @@ public:
     }
 
     void walk(const std::string& pathname) {
-        auto pathname_clean = rstripped(pathname, '/');
+        const auto pathname_clean = rstrip_view(pathname, '/');
         if (pathname.empty() || pathname_clean == ".") {
             walk_cwd();
             return;
@@ -150,14 +159,14 @@ public:
         // create PathNode also for parent, so the reporting is consistent
         // (component in each reported PathNode is always cleaned basename)
         std::shared_ptr<PathNode> path;
-        auto components = rsplit(pathname_clean, '/', 1);
-        if (components.size() == 2) {
+        const auto sep = pathname_clean.rfind('/');
+        if (sep != std::string_view::npos) {
             // relative or absolute path, e.g.:
             // - relative "foo/bar/", processed to components ["foo", "bar"]
             // - absolute "/foo/bar/", processed to components ["/foo", "bar"]
             // - absolute in root: "/foo/", processed to components ["", "bar"]
-            auto parent = std::make_shared<PathNode>(components[0]);
-            path = std::make_shared<PathNode>(components[1], parent);
+            auto parent = std::make_shared<PathNode>(pathname_clean.substr(0, sep));
+            path = std::make_shared<PathNode>(pathname_clean.substr(sep + 1), parent);
         } else {
             // relative or absolute path, e.g.:
             // - relative path "foo/", cleaned to "foo"
@@ -16,6 +16,14 @@
 #include "dispatch.h"
 #include <xci/core/log.h>
 
+#include <algorithm>
+#include <cassert>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace xci::core {
 
 
@@ -49,4 +57,135 @@ bool FSDispatch::remove_watch(const std::string& pathname)
 }
 
 
+TaskQueue::~TaskQueue()
+{
+    // drop remaining tasks (not run)
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+
+bool TaskQueue::push(Task&& task)
+{
+    auto* node = new Node{std::move(task), m_head.load(std::memory_order_relaxed)};
+    while (!m_head.compare_exchange_weak(node->next, node,
+            std::memory_order_release, std::memory_order_relaxed));
+    return node->next == nullptr;
+}
+
+
+size_t TaskQueue::run_all()
+{
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+    // reverse to FIFO order
+    Node* fifo = nullptr;
+    while (node) {
+        Node* next = node->next;
+        node->next = fifo;
+        fifo = node;
+        node = next;
+    }
+    size_t count = 0;
+    while (fifo) {
+        Node* next = fifo->next;
+        fifo->task();
+        delete fifo;
+        fifo = next;
+        ++count;
+    }
+    return count;
+}
+
+
+static void pin_thread_to_cpu(std::thread& thread, unsigned cpu)
+{
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    int rc = pthread_setaffinity_np(thread.native_handle(), sizeof(cpuset), &cpuset);
+    if (rc != 0)
+        log::warning("EventLoopPool: pthread_setaffinity_np({}): error {}", cpu, rc);
+#else
+    (void) thread;
+    (void) cpu;
+#endif
+}
+
+
+EventLoopPool::EventLoopPool(unsigned num_threads, bool pin_threads)
+{
+    const unsigned num_cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    if (num_threads == 0)
+        num_threads = num_cpus;
+    m_workers.reserve(num_threads);
+    try {
+        for (unsigned i = 0; i != num_threads; ++i) {
+            auto& worker = m_workers.emplace_back(std::make_unique<Worker>());
+            worker->thread = std::thread([&loop = worker->loop]() {
+                log::debug("EventLoopPool: Thread starting");
+                loop.run();
+                log::debug("EventLoopPool: Thread finished");
+            });
+            if (pin_threads)
+                pin_thread_to_cpu(worker->thread, i % num_cpus);
+        }
+    } catch (...) {
+        // The destructor won't run, stop the threads started so far
+        terminate_and_join();
+        throw;
+    }
+}
+
+
+EventLoopPool::~EventLoopPool()
+{
+    terminate_and_join();
+}
+
+
+void EventLoopPool::terminate_and_join()
+{
+    // Terminate from inside the loops, after all tasks posted so far
+    for (auto& worker : m_workers) {
+        if (!worker->thread.joinable())
+            continue;
+        if (worker->queue.push([&loop = worker->loop]{ loop.terminate(); }))
+            worker->wakeup.fire();
+    }
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+
+void EventLoopPool::post(Task task)
+{
+    const auto index = m_next.fetch_add(1, std::memory_order_relaxed) % size();
+    post_to(index, std::move(task));
+}
+
+
+void EventLoopPool::post_to(size_t index, Task task)
+{
+    auto& worker = *m_workers[index];
+    if (worker.queue.push(std::move(task)))
+        worker.wakeup.fire();
+}
+
+
+void EventLoopPool::post_to(EventLoop& loop, Task task)
+{
+    auto it = std::find_if(m_workers.begin(), m_workers.end(),
+            [&loop](const auto& worker) { return &worker->loop == &loop; });
+    assert(it != m_workers.end());
+    post_to(size_t(it - m_workers.begin()), std::move(task));
+}
+
+
 }  // namespace xci::core
@@ -21,6 +21,8 @@
 #include <functional>
 #include <memory>
 #include <thread>
+#include <vector>
+#include <atomic>
 
 namespace xci::core {
 
@@ -73,6 +75,93 @@ private:
 using FSDispatchPtr = std::shared_ptr<FSDispatch>;
 
 
+/// Lock-free multi-producer single-consumer queue of tasks.
+/// Producers push onto intrusive stack, the consumer takes the whole stack
+/// at once and reverses it, so the tasks are run in FIFO order.
+
+class TaskQueue {
+public:
+    using Task = std::function<void()>;
+
+    TaskQueue() = default;
+    ~TaskQueue();
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    /// Push a task (THREAD-SAFE)
+    /// \returns true if the queue was empty before the push
+    ///          (i.e. the consumer has to be woken up)
+    bool push(Task&& task);
+
+    /// Run all tasks queued so far (to be called from single consumer thread)
+    /// \returns number of tasks run
+    size_t run_all();
+
+private:
+    struct Node {
+        Task task;
+        Node* next;
+    };
+    std::atomic<Node*> m_head {nullptr};
+};
+
+
+/// Pool of event loops, each running in its own thread
+///
+/// Tasks can be posted to the loops from any thread (lock-free queue per loop,
+/// the loop is woken up by EventWatch, i.e. eventfd on Linux).
+/// The watches (e.g. IOWatch) can be spread over the loops, see `loop_for_fd`.
+/// Note that a Watch has to be destroyed in its loop's thread, e.g. via `post_to`.
+/// TimerWatch has to be also created and restarted in the loop's thread.
+
+class EventLoopPool {
+public:
+    using Task = TaskQueue::Task;
+
+    /// \param num_threads  Number of loops/threads, 0 = number of CPU cores
+    /// \param pin_threads  Pin each thread to a CPU core (if supported)
+    explicit EventLoopPool(unsigned num_threads = 0, bool pin_threads = true);
+
+    /// Terminates the loops and joins the threads.
+    /// Tasks posted before destruction are still run.
+    ~EventLoopPool();
+
+    EventLoopPool(const EventLoopPool&) = delete;
+    EventLoopPool& operator=(const EventLoopPool&) = delete;
+
+    size_t size() const { return m_workers.size(); }
+
+    EventLoop& loop(size_t index) { return m_workers[index]->loop; }
+
+    /// Choose loop for a watch on the FD. The assignment is stable,
+    /// i.e. same FD always maps to same loop.
+    EventLoop& loop_for_fd(int fd) { return loop(size_t(fd) % size()); }
+
+    /// Post a task to be run in one of the loops (round-robin).
+    /// This method is THREAD-SAFE.
+    void post(Task task);
+
+    /// Post a task to be run in specified loop (by index or by reference).
+    /// This method is THREAD-SAFE.
+    void post_to(size_t index, Task task);
+    void post_to(EventLoop& loop, Task task);
+
+private:
+    void terminate_and_join();
+
+    struct Worker {
+        Worker() : wakeup(loop, [this]{ queue.run_all(); }) {}
+        EventLoop loop;
+        TaskQueue queue;
+        EventWatch wakeup;
+        std::thread thread;
+    };
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_next {0};
+};
+
+
 }  // namespace xci::core
 
 #endif // include guard
@@ -0,0 +1,215 @@
+// TimerWheel.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_CORE_EVENT_TIMERWHEEL_H
+#define XCI_CORE_EVENT_TIMERWHEEL_H
+
+#include <xci/compat/bit.h>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cassert>
+
+namespace xci::core {
+
+
+class Watch;
+
+
+/// Hierarchical timer wheel with resolution of one tick (EventLoop uses 1 ms).
+///
+/// There are 4 levels of 256 slots. Level 0 holds timers expiring in less
+/// than 256 ticks, level 1 in less than 256^2 ticks, etc. Timers from higher
+/// levels are cascaded to lower levels as the time advances. Delays longer
+/// than 2^32 ticks (~49 days with 1 ms tick) are handled by repeated cascading.
+///
+/// Timers are intrusive list entries (embedded in TimerWatch), so adding,
+/// removing and restarting is O(1) without any allocation.
+/// Finding next expiry uses occupancy bitmaps of the slots.
+
+class TimerWheel {
+public:
+    using Tick = uint64_t;
+    static constexpr Tick no_expiry = std::numeric_limits<Tick>::max();
+
+    class Entry {
+    public:
+        explicit Entry(Watch& watch) : m_watch(watch) {}
+        ~Entry() { assert(!is_active()); }
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        Watch& watch() const { return m_watch; }
+        Tick expires() const { return m_expires; }
+        bool is_active() const { return m_slot != c_no_slot; }
+
+    private:
+        friend class TimerWheel;
+        Watch& m_watch;
+        Entry* m_prev = nullptr;
+        Entry* m_next = nullptr;
+        Tick m_expires = 0;
+        unsigned m_slot = c_no_slot;
+    };
+
+    /// Current time of the wheel (last tick passed to `advance`)
+    Tick now() const { return m_now; }
+
+    bool empty() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+
+    /// Add or restart the timer. The expiry is in absolute ticks.
+    /// Already expired time is moved to next tick.
+    void add(Entry& entry, Tick expires) {
+        remove(entry);
+        entry.m_expires = std::max(expires, m_now + 1);
+        ++m_count;
+        place(entry);
+    }
+
+    /// Stop the timer. Does nothing if the timer is not active.
+    void remove(Entry& entry) {
+        if (!entry.is_active())
+            return;
+        unlink(entry);
+        --m_count;
+    }
+
+    /// Find nearest tick when the wheel has to be advanced.
+    /// This is either expiry of a timer or a cascade of higher level slot.
+    /// \returns    `no_expiry` when there are no timers
+    Tick next_expiry() const {
+        if (m_count == 0)
+            return no_expiry;
+        Tick result = no_expiry;
+        // level 0 - exact expiry
+        const int d0 = find_occupied(0, unsigned(m_now + 1) & c_slot_mask);
+        if (d0 != -1)
+            result = m_now + 1 + d0;
+        // higher levels - the cascade boundary
+        for (unsigned level = 1; level != c_levels; ++level) {
+            const unsigned shift = level * c_slot_bits;
+            const Tick cur = m_now >> shift;
+            const int d = find_occupied(level, unsigned(cur + 1) & c_slot_mask);
+            if (d != -1)
+                result = std::min(result, (cur + 1 + d) << shift);
+        }
+        return result;
+    }
+
+    /// Advance the time, call `on_expire(Entry&)` for each expired timer.
+    /// The callback may add or remove any timers, including the expired one.
+    template <class F>
+    void advance(Tick target, F&& on_expire) {
+        for (;;) {
+            const Tick next = next_expiry();
+            if (next > target)
+                break;
+            m_now = next;
+            // cascade from higher levels, so the entries can fall through
+            // to current slots of lower levels
+            for (unsigned level = c_levels - 1; level != 0; --level) {
+                const unsigned shift = level * c_slot_bits;
+                if ((m_now & ((Tick(1) << shift) - 1)) == 0)
+                    cascade(level, unsigned(m_now >> shift) & c_slot_mask);
+            }
+            // detach the expired slot, then fire the entries one by one
+            const unsigned slot = unsigned(m_now) & c_slot_mask;
+            m_firing = take_slot(slot);
+            for (Entry* e = m_firing; e; e = e->m_next)
+                e->m_slot = c_firing_slot;
+            while (m_firing) {
+                Entry& entry = *m_firing;
+                remove(entry);
+                on_expire(entry);
+            }
+        }
+        m_now = std::max(m_now, target);
+    }
+
+private:
+    static constexpr unsigned c_levels = 4;
+    static constexpr unsigned c_slot_bits = 8;
+    static constexpr unsigned c_slots = 1u << c_slot_bits;
+    static constexpr unsigned c_slot_mask = c_slots - 1;
+    static constexpr Tick c_max_delta = (Tick(1) << (c_levels * c_slot_bits)) - 1;
+    static constexpr unsigned c_no_slot = ~0u;
+    static constexpr unsigned c_firing_slot = ~0u - 1;
+
+    void place(Entry& entry) {
+        const Tick delta = std::min(entry.m_expires - std::min(entry.m_expires, m_now), c_max_delta);
+        const Tick t = m_now + delta;
+        unsigned level = 0;
+        while (level != c_levels - 1 && delta >= (Tick(1) << ((level + 1) * c_slot_bits)))
+            ++level;
+        const unsigned slot = level * c_slots + (unsigned(t >> (level * c_slot_bits)) & c_slot_mask);
+        entry.m_slot = slot;
+        entry.m_prev = nullptr;
+        entry.m_next = m_slots[slot];
+        if (entry.m_next)
+            entry.m_next->m_prev = &entry;
+        m_slots[slot] = &entry;
+        m_occupied[slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+
+    void unlink(Entry& entry) {
+        Entry*& head = entry.m_slot == c_firing_slot ? m_firing : m_slots[entry.m_slot];
+        if (entry.m_prev)
+            entry.m_prev->m_next = entry.m_next;
+        else
+            head = entry.m_next;
+        if (entry.m_next)
+            entry.m_next->m_prev = entry.m_prev;
+        if (head == nullptr && entry.m_slot != c_firing_slot)
+            m_occupied[entry.m_slot / 64] &= ~(uint64_t(1) << (entry.m_slot % 64));
+        entry.m_prev = entry.m_next = nullptr;
+        entry.m_slot = c_no_slot;
+    }
+
+    Entry* take_slot(unsigned slot) {
+        Entry* head = m_slots[slot];
+        m_slots[slot] = nullptr;
+        m_occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        return head;
+    }
+
+    void cascade(unsigned level, unsigned index) {
+        Entry* e = take_slot(level * c_slots + index);
+        while (e) {
+            Entry* next = e->m_next;
+            place(*e);
+            e = next;
+        }
+    }
+
+    /// Find occupied slot in `level`, searching from `start` index, wrapping around.
+    /// \returns distance from start (0..255) or -1 if the level is empty
+    int find_occupied(unsigned level, unsigned start) const {
+        const uint64_t* bits = &m_occupied[level * c_slots / 64];
+        for (unsigned pos = start; pos < start + c_slots; ) {
+            const unsigned p = pos & c_slot_mask;
+            const uint64_t word = bits[p / 64] >> (p % 64);
+            if (word != 0) {
+                const unsigned d = pos - start + count_trailing_zeros(word);
+                return d < c_slots ? int(d) : -1;
+            }
+            pos += 64 - p % 64;
+        }
+        return -1;
+    }
+
+    Entry* m_slots[c_levels * c_slots] = {};
+    uint64_t m_occupied[c_levels * c_slots / 64] = {};
+    Entry* m_firing = nullptr;  // expired entries being fired
+    Tick m_now = 0;
+    size_t m_count = 0;
+};
+
+
+} // namespace xci::core
+
+#endif // include guard
@@ -16,12 +16,15 @@
 #include "EventLoop.h"
 #include <xci/core/log.h>
 #include <algorithm>
+#include <climits>
 #include <sys/inotify.h>
 #include <unistd.h>
 #include <cassert>
 
 namespace xci::core {
 
+using namespace std::chrono;
+
 
 EventLoop::EventLoop()
 {
@@ -44,8 +47,16 @@ void EventLoop::run()
 {
     constexpr int maxevents = 10;
     struct epoll_event events[maxevents] = {};
+    m_thread_id = std::this_thread::get_id();
     while (!m_terminate) {
-        int rnum = epoll_wait(m_epoll_fd, events, maxevents, -1);
+        int timeout = -1;
+        const auto next_expiry = m_timers.next_expiry();
+        if (next_expiry != TimerWheel::no_expiry) {
+            const auto now = current_tick();
+            timeout = next_expiry <= now ? 0 : int(std::min<TimerWheel::Tick>(next_expiry - now, INT_MAX));
+        }
+
+        int rnum = epoll_wait(m_epoll_fd, events, maxevents, timeout);
         if (rnum == -1) {
             if (errno == EINTR)
                 continue;
@@ -62,7 +73,15 @@ void EventLoop::run()
                 static_cast<Watch*>(ev.data.ptr)->_notify(ev.events);
             }
         }
+
+        // check timers
+        if (!m_terminate && !m_timers.empty()) {
+            m_timers.advance(current_tick(), [](TimerWheel::Entry& timer) {
+                timer.watch()._notify(0);
+            });
+        }
     }
+    m_thread_id = std::thread::id{};
 }
 
 
@@ -91,4 +110,46 @@ void EventLoop::_unregister(int fd, Watch& watch)
 }
 
 
+void EventLoop::_add_timer(milliseconds timeout, TimerWheel::Entry& timer)
+{
+    assert(_in_loop_thread());
+    // round up, so the timer never expires early
+    const auto since_epoch = steady_clock::now() - m_timer_epoch + timeout;
+    const auto expires = ceil<milliseconds>(since_epoch).count();
+    m_timers.add(timer, TimerWheel::Tick(expires));
+}
+
+
+void EventLoop::_repeat_timer(milliseconds interval, TimerWheel::Entry& timer)
+{
+    assert(_in_loop_thread());
+    // if the loop was late for more than the interval, skip the missed expiries
+    auto expires = timer.expires() + interval.count();
+    const auto now = m_timers.now();
+    if (expires <= now)
+        expires = now + interval.count();
+    m_timers.add(timer, expires);
+}
+
+
+void EventLoop::_remove_timer(TimerWheel::Entry& timer)
+{
+    assert(_in_loop_thread());
+    m_timers.remove(timer);
+}
+
+
+bool EventLoop::_in_loop_thread() const
+{
+    const auto id = m_thread_id.load(std::memory_order_relaxed);
+    return id == std::thread::id{} || id == std::this_thread::get_id();
+}
+
+
+TimerWheel::Tick EventLoop::current_tick() const
+{
+    return TimerWheel::Tick(duration_cast<milliseconds>(steady_clock::now() - m_timer_epoch).count());
+}
+
+
 } // namespace xci::core
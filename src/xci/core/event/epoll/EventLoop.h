@@ -16,7 +16,11 @@
 #ifndef XCI_CORE_EPOLL_EVENTLOOP_H
 #define XCI_CORE_EPOLL_EVENTLOOP_H
 
+#include <xci/core/event/TimerWheel.h>
 #include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
 #include <sys/epoll.h>
 
 namespace xci::core {
@@ -66,9 +70,32 @@ public:
     void _register(int fd, Watch& watch, uint32_t epoll_events);
     void _unregister(int fd, Watch& watch);
 
+    // Timers are kept in TimerWheel, with resolution of 1 ms.
+    // The expired timer's Watch is notified with `_notify(0)`.
+    // The wheel is not synchronized: while the loop is running, the timers
+    // can be added, restarted and removed only from the loop's thread.
+
+    // Start or restart the timer, it will expire after `timeout`.
+    void _add_timer(std::chrono::milliseconds timeout, TimerWheel::Entry& timer);
+
+    // Restart expired timer, `interval` is counted from its previous expiry.
+    void _repeat_timer(std::chrono::milliseconds interval, TimerWheel::Entry& timer);
+
+    // Stop the timer.
+    void _remove_timer(TimerWheel::Entry& timer);
+
+    // True if called from the thread running the loop, or the loop is not running.
+    bool _in_loop_thread() const;
+
 private:
+    // current time in timer ticks (ms), rounded down
+    TimerWheel::Tick current_tick() const;
+
     int m_epoll_fd;
     bool m_terminate = false;
+    std::atomic<std::thread::id> m_thread_id;  // thread in run(), default = not running
+    std::chrono::steady_clock::time_point m_timer_epoch = std::chrono::steady_clock::now();
+    TimerWheel m_timers;
 };
 
 
@@ -24,7 +24,10 @@ namespace xci::core {
 
 
 /// Run callback periodically
-/// `TimerWatch` implementation for kqueue(2) using EVFILT_TIMER
+/// `TimerWatch` implementation for epoll(7), using EventLoop's TimerWheel.
+/// All timers in the loop share the epoll_wait(2) timeout, there is no FD per timer.
+/// While the loop is running, the timer has to be created, restarted, stopped
+/// and destroyed in the loop's thread (from other threads, use e.g. `EventLoopPool::post_to`).
 
 class TimerWatch: public Watch {
 public:
@@ -40,7 +43,7 @@ public:
     TimerWatch(EventLoop& loop, std::chrono::milliseconds interval, Type type, Callback cb);
     TimerWatch(EventLoop& loop, std::chrono::milliseconds interval, Callback cb)
             : TimerWatch(loop, interval, Type::Periodic, std::move(cb)) {}
-    ~TimerWatch() override;
+    ~TimerWatch() override { stop(); }
 
     void stop();
     void restart();
@@ -48,7 +51,7 @@ public:
     void _notify(uint32_t epoll_events) override;
 
 private:
-    int m_timer_fd;
+    TimerWheel::Entry m_timer {*this};
     std::chrono::milliseconds m_interval;
     Type m_type;
     Callback m_cb;
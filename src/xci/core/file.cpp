@@ -23,6 +23,12 @@
 #include <cstring>
 #include <cstdlib>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
 namespace xci::core {
 
 
@@ -77,6 +83,34 @@ BufferPtr read_binary_file(std::istream& stream)
 }
 
 
+BufferPtr map_file(const std::string& pathname)
+{
+#ifdef _WIN32
+    return read_binary_file(pathname);
+#else
+    int fd = ::open(pathname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return {};
+    struct stat st = {};
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return {};
+    }
+    const auto size = size_t(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return std::make_shared<Buffer>(nullptr, 0);
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return {};
+    return std::make_shared<Buffer>((byte*) addr, size,
+            [](byte* data, size_t size) { munmap(data, size); });
+#endif
+}
+
+
 bool write(int fd, std::string s)
 {
     size_t written = 0;
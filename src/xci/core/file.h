@@ -32,6 +32,12 @@ std::optional<std::string> read_text_file(std::istream& stream);
 BufferPtr read_binary_file(const std::string& pathname);
 BufferPtr read_binary_file(std::istream& stream);
 
+/// Map whole file to memory. The mapping is private and writable:
+/// modifications of the buffer are not written back to the file.
+/// Where mmap is not available, the file is read to memory instead.
+/// Returns null in case of any error.
+BufferPtr map_file(const std::string& pathname);
+
 /// Write string to FD (in a loop, handling EINTR).
 /// \returns false on error (check errno), true on success
 bool write(int fd, std::string s);
@@ -10,7 +10,14 @@
 #include <xci/core/file.h>
 #include <xci/compat/unistd.h>
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
 #include <ctime>
+#include <cstring>
 #include <cassert>
 
 
@@ -57,22 +64,41 @@ Logger::~Logger()
 }
 
 
-static inline std::string format_current_time()
+// The formatted time changes only once per second, so it's cached (per thread)
+static inline const std::string& format_time(time_t time)
 {
-    time_t now = std::time(nullptr);
+    thread_local time_t cached_time = -1;
+    thread_local std::string cached_str;
+    if (time == cached_time)
+        return cached_str;
     std::string ts_buf(20, '\0');
-    size_t ts_res = std::strftime(&ts_buf[0], ts_buf.size(), "%F %T", std::localtime(&now));
+    struct tm tm {};
+#ifdef _WIN32
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+    size_t ts_res = std::strftime(&ts_buf[0], ts_buf.size(), "%F %T", &tm);
     assert(ts_res > 0 && ts_res < ts_buf.size());
     ts_buf.resize(ts_res);
-    return ts_buf;
+    cached_time = time;
+    cached_str = std::move(ts_buf);
+    return cached_str;
 }
 
 
-void Logger::default_handler(Logger::Level lvl, std::string_view msg)
+static inline std::string format_record(Logger::Level lvl, time_t time,
+                                        ThreadId tid, std::string_view msg)
 {
     TermCtl& t = TermCtl::stderr_instance();
     auto lvl_num = static_cast<int>(lvl);
-    auto formatted_msg = t.format(level_format[lvl_num], format_current_time(), get_thread_id(), msg);
+    return t.format(level_format[lvl_num], format_time(time), tid, msg);
+}
+
+
+void Logger::default_handler(Logger::Level lvl, std::string_view msg)
+{
+    auto formatted_msg = format_record(lvl, std::time(nullptr), get_thread_id(), msg);
     auto res = write(STDERR_FILENO, formatted_msg);
     assert(res);  // write to stderr should not fail
     (void) res;
@@ -81,13 +107,318 @@ void Logger::default_handler(Logger::Level lvl, std::string_view msg)
 
 void Logger::log(Logger::Level lvl, std::string_view msg)
 {
-    if (lvl < m_level)
+    if (!is_enabled(lvl))
         return;
 
-    m_handler(lvl, msg);
+    m_handler.load(std::memory_order_acquire)(lvl, msg);
+}
+
+
+// -----------------------------------------------------------------------------
+// AsyncLogSink
+
+
+namespace {
+
+struct LogRecordHead {
+    uint32_t size;      // message size (without the head)
+    uint8_t level;
+    uint8_t skip;       // 1 = skip to the start of the buffer (the rest is unused)
+    uint16_t reserved;
+    int64_t time;
+};
+static_assert(sizeof(LogRecordHead) == 16);
+
+constexpr size_t c_record_align = sizeof(LogRecordHead);
+
+constexpr size_t align_record(size_t size) {
+    return (size + c_record_align - 1) & ~(c_record_align - 1);
+}
+
+
+/// Lock-free single-producer single-consumer ring buffer of log records.
+/// Records are variable size, aligned to 16 bytes, so the head always fits
+/// contiguously at the end of the buffer.
+class LogRing {
+public:
+    LogRing(size_t capacity, ThreadId tid)
+        : m_buffer(new char[capacity]), m_capacity(capacity), m_tid(tid)
+    {
+        assert(capacity % c_record_align == 0);
+    }
+
+    /// Producer side
+    /// \returns false if the record doesn't fit into buffer (it's dropped)
+    bool push(Logger::Level lvl, time_t time, std::string_view msg) {
+        const size_t size = align_record(sizeof(LogRecordHead) + msg.size());
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t idx = head % m_capacity;
+        const size_t contiguous = m_capacity - idx;
+        const size_t needed = contiguous < size ? contiguous + size : size;
+        if (m_capacity - (head - tail) < needed) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        size_t pos = head;
+        if (contiguous < size) {
+            LogRecordHead skip_head {};
+            skip_head.skip = 1;
+            std::memcpy(&m_buffer[idx], &skip_head, sizeof(skip_head));
+            pos += contiguous;
+        }
+        LogRecordHead rec_head {};
+        rec_head.size = uint32_t(msg.size());
+        rec_head.level = uint8_t(lvl);
+        rec_head.time = int64_t(time);
+        char* p = &m_buffer[pos % m_capacity];
+        std::memcpy(p, &rec_head, sizeof(rec_head));
+        std::memcpy(p + sizeof(rec_head), msg.data(), msg.size());
+        m_head.store(pos + size, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side
+    /// \param cb   Called for each record: (Level, time_t, std::string_view)
+    template <class F>
+    void drain(F&& cb) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        while (tail != head) {
+            const size_t idx = tail % m_capacity;
+            LogRecordHead rec_head;
+            std::memcpy(&rec_head, &m_buffer[idx], sizeof(rec_head));
+            if (rec_head.skip) {
+                tail += m_capacity - idx;
+                continue;
+            }
+            cb(Logger::Level(rec_head.level), time_t(rec_head.time),
+               std::string_view(&m_buffer[idx + sizeof(rec_head)], rec_head.size));
+            tail += align_record(sizeof(rec_head) + rec_head.size);
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+    ThreadId tid() const { return m_tid; }
+    size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Consumer side: number of dropped messages already reported
+    size_t dropped_reported = 0;
+
+    // The producer thread has finished, the ring can be removed once empty
+    std::atomic<bool> abandoned {false};
+
+    // The producer is pushing a record, see AsyncLogSink::State::close
+    std::atomic<bool> pushing {false};
+
+private:
+    std::unique_ptr<char[]> m_buffer;
+    const size_t m_capacity;
+    const ThreadId m_tid;
+    std::atomic<size_t> m_dropped {0};
+    alignas(64) std::atomic<size_t> m_head {0};  // written by producer
+    alignas(64) std::atomic<size_t> m_tail {0};  // written by consumer
+};
+
+} // namespace
+
+
+struct AsyncLogSink::State {
+    explicit State(size_t buffer_size) : buffer_size(buffer_size) {}
+
+    /// Drain all rings and write the records to stderr.
+    /// \returns true if anything was written
+    bool drain() {
+        std::lock_guard lock(rings_mutex);
+        std::string out;
+        for (auto& ring : rings) {
+            ring->drain([&out, &ring](Logger::Level lvl, time_t time, std::string_view msg) {
+                out += format_record(lvl, time, ring->tid(), msg);
+            });
+            const auto dropped = ring->dropped();
+            if (dropped != ring->dropped_reported) {
+                out += format_record(Logger::Level::Warning, std::time(nullptr), ring->tid(),
+                        fmt::format("{} log messages dropped (buffer full)",
+                                    dropped - ring->dropped_reported));
+                ring->dropped_reported = dropped;
+            }
+        }
+        // remove rings of finished threads
+        auto it = std::remove_if(rings.begin(), rings.end(), [this](const auto& ring) {
+            if (!ring->abandoned || !ring->empty())
+                return false;
+            removed_dropped += ring->dropped();
+            return true;
+        });
+        rings.erase(it, rings.end());
+        if (out.empty())
+            return false;
+        auto res = write(STDERR_FILENO, std::move(out));
+        assert(res);  // write to stderr should not fail
+        (void) res;
+        return true;
+    }
+
+    /// Stop accepting new records. Returns after concurrent pushes finished,
+    /// so following `drain` gets all records. The producers check the flag
+    /// after setting `pushing`, so either the producer sees `closed`,
+    /// or this sees `pushing` (both are seq_cst).
+    void close() {
+        closed.store(true);
+        std::lock_guard lock(rings_mutex);
+        for (const auto& ring : rings) {
+            while (ring->pushing.load())
+                std::this_thread::yield();
+        }
+    }
+
+    /// Background thread
+    void run() {
+        std::unique_lock lock(wakeup_mutex);
+        while (!stop) {
+            lock.unlock();
+            const bool written = drain();
+            lock.lock();
+            if (!written && !stop) {
+                // A producer might miss the flag and not notify,
+                // so the wait is limited by timeout.
+                waiting = true;
+                wakeup_cv.wait_for(lock, std::chrono::milliseconds(50));
+                waiting = false;
+            }
+        }
+        lock.unlock();
+        drain();
+    }
+
+    const size_t buffer_size;
+
+    std::mutex rings_mutex;  // rings, consumer side of rings
+    std::vector<std::shared_ptr<LogRing>> rings;
+    size_t removed_dropped = 0;  // dropped messages from removed rings
+
+    std::mutex wakeup_mutex;
+    std::condition_variable wakeup_cv;
+    std::atomic<bool> waiting {false};
+    std::atomic<bool> closed {false};  // no more records, late messages are written synchronously
+    bool stop = false;
+};
+
+
+// Currently active sink. Threads register their rings on first log message.
+// The generation is incremented whenever the sink is created or destroyed,
+// which invalidates the registrations.
+static std::mutex s_async_mutex;
+static std::shared_ptr<AsyncLogSink::State> s_async_state;
+static std::atomic<unsigned> s_async_generation {0};
+
+namespace {
+struct ThreadLogRing {
+    ~ThreadLogRing() { if (ring) ring->abandoned = true; }
+    unsigned generation = 0;
+    std::shared_ptr<AsyncLogSink::State> state;
+    std::shared_ptr<LogRing> ring;
+};
+} // namespace
+
+static thread_local ThreadLogRing t_log_ring;
+
+
+AsyncLogSink::AsyncLogSink(Logger& logger, size_t buffer_size)
+    : m_logger(logger),
+      m_state(std::make_shared<State>(align_record(std::max(buffer_size, 2 * c_record_align))))
+{
+    {
+        std::lock_guard lock(s_async_mutex);
+        assert(!s_async_state);  // only one sink may exist
+        s_async_state = m_state;
+        s_async_generation.fetch_add(1, std::memory_order_release);
+    }
+    m_thread = std::thread([state = m_state] { state->run(); });
+    m_logger.set_handler(handler);
+}
+
+
+AsyncLogSink::~AsyncLogSink()
+{
+    m_logger.set_handler(Logger::default_handler);
+    {
+        std::lock_guard lock(s_async_mutex);
+        s_async_state.reset();
+        s_async_generation.fetch_add(1, std::memory_order_release);
+    }
+    // threads registered before the reset may still push, until they see this
+    m_state->close();
+    {
+        std::lock_guard lock(m_state->wakeup_mutex);
+        m_state->stop = true;
+    }
+    m_state->wakeup_cv.notify_one();
+    m_thread.join();
+}
+
+
+void AsyncLogSink::flush()
+{
+    m_state->drain();
+}
+
+
+size_t AsyncLogSink::dropped() const
+{
+    std::lock_guard lock(m_state->rings_mutex);
+    size_t total = m_state->removed_dropped;
+    for (const auto& ring : m_state->rings)
+        total += ring->dropped();
+    return total;
+}
+
+
+void AsyncLogSink::handler(Logger::Level lvl, std::string_view msg)
+{
+    auto& local = t_log_ring;
+    if (local.generation != s_async_generation.load(std::memory_order_acquire)) {
+        // (re)register this thread with current sink
+        std::lock_guard lock(s_async_mutex);
+        if (local.ring)
+            local.ring->abandoned = true;
+        local.ring.reset();
+        local.generation = s_async_generation.load(std::memory_order_relaxed);
+        local.state = s_async_state;
+        if (local.state) {
+            local.ring = std::make_shared<LogRing>(local.state->buffer_size, get_thread_id());
+            std::lock_guard rings_lock(local.state->rings_mutex);
+            local.state->rings.push_back(local.ring);
+        }
+    }
+    if (!local.ring) {
+        Logger::default_handler(lvl, msg);
+        return;
+    }
+    local.ring->pushing.store(true);
+    if (local.state->closed.load()) {
+        // the sink is being destroyed, the final drain might miss the record
+        local.ring->pushing.store(false, std::memory_order_release);
+        Logger::default_handler(lvl, msg);
+        return;
+    }
+    const bool pushed = local.ring->push(lvl, std::time(nullptr), msg);
+    local.ring->pushing.store(false, std::memory_order_release);
+    // wake up the background thread (only the first message after it went sleeping)
+    if (pushed
+    && local.state->waiting.load(std::memory_order_relaxed)
+    && local.state->waiting.exchange(false))
+        local.state->wakeup_cv.notify_one();
 }
 
 
+// -----------------------------------------------------------------------------
+
+
 std::string log::LastErrorPlaceholder::message(bool use_last_error, bool error_code)
 {
     if (error_code) {
@@ -9,6 +9,9 @@
 
 #include <xci/config.h>
 #include <string_view>
+#include <memory>
+#include <thread>
+#include <atomic>
 #include <fmt/format.h>
 
 namespace xci::core {
@@ -25,6 +28,11 @@ public:
         Error,
     };
 
+    // Compile-time minimal level. Log messages below this level are compiled out.
+    // Set by CMake option XCI_LOG_MIN_LEVEL (in config.h):
+    // 0 = Trace, 1 = Debug, 2 = Info, 3 = Warning, 4 = Error
+    static constexpr Level min_level = Level(XCI_LOG_MIN_LEVEL);
+
     // Initialize default logger, Call this before anything that logs
     // to make sure logger is created before it (and destroyed after).
     // If not called, default logger will be created lazily
@@ -40,19 +48,72 @@ public:
     // Messages below this level are dropped.
     void set_level(Level level) { m_level = level; }
 
+    // Check if a message of the level would be logged.
+    // Use this to skip expensive preparation of messages that would be dropped.
+    bool is_enabled(Level lvl) const { return lvl >= min_level && lvl >= m_level; }
+
     // Customizable log handler
     // A function with same signature as `default_handler` can be used
     // instead of default handler. The function parameters are preformatted
     // messages and log level. The handler has to add timestamp by itself.
+    // The handler may be replaced while other threads log (see AsyncLogSink).
     static void default_handler(Level lvl, std::string_view msg);
     using Handler = decltype(&default_handler);
-    void set_handler(Handler handler) { m_handler = handler; }
+    void set_handler(Handler handler) { m_handler.store(handler, std::memory_order_release); }
 
     void log(Level lvl, std::string_view msg);
 
 private:
     Level m_level;
-    Handler m_handler = default_handler;
+    std::atomic<Handler> m_handler {default_handler};
+};
+
+
+/// Asynchronous log sink
+///
+/// While an instance exists, it replaces Logger's handler with `handler` below.
+/// The handler only copies the message into per-thread lock-free ring buffer.
+/// A background thread drains the buffers, formats the records (with cached
+/// timestamp) and writes them to stderr in batches.
+///
+/// When the thread's buffer is full, new messages are dropped. The number
+/// of dropped messages is reported to log as soon as there is space again.
+/// Messages from the same thread are kept in order, messages from different
+/// threads may be reordered.
+///
+/// Destructor flushes all remaining messages and reinstalls default handler.
+/// Messages logged concurrently with the destruction are not lost, they are
+/// written synchronously (possibly before older messages of the same thread).
+/// Only single instance may exist at a time.
+class AsyncLogSink
+{
+public:
+    /// \param logger       Logger to be attached to
+    /// \param buffer_size  Size of each per-thread buffer in bytes.
+    ///                     Messages which don't fit into empty buffer are dropped.
+    explicit AsyncLogSink(Logger& logger = Logger::default_instance(),
+                          size_t buffer_size = 64 * 1024);
+    ~AsyncLogSink();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    /// Write out all messages queued so far (in this thread).
+    void flush();
+
+    /// Total number of messages dropped because of full buffer
+    size_t dropped() const;
+
+    /// The handler used when the sink is active. When no sink exists,
+    /// it falls back to synchronous `Logger::default_handler`.
+    static void handler(Logger::Level lvl, std::string_view msg);
+
+    struct State;
+
+private:
+    Logger& m_logger;
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
 };
 
 
@@ -73,34 +134,71 @@ inline std::string format(const char *fmt, Args&&... args)
                        fmt::arg("m", LastErrorPlaceholder{}));
 }
 
+// Format into `buffer`, replacing its content.
+template<typename ...Args>
+inline std::string_view format_to_buffer(fmt::memory_buffer& buffer, const char *fmt, const Args&... args)
+{
+    buffer.clear();
+    const auto m = fmt::arg("m", LastErrorPlaceholder{});
+    fmt::vformat_to(std::back_inserter(buffer), fmt, fmt::make_format_args(args..., m));
+    return {buffer.data(), buffer.size()};
+}
+
+namespace detail {
+// Thread-local buffer for formatting log messages, it's reused by following calls.
+inline thread_local fmt::memory_buffer log_buffer;
+// Depth of nested `message` calls in current thread. A formatter or a log handler
+// may log, the nested message then uses a local buffer.
+inline thread_local unsigned log_depth = 0;
+} // namespace detail
+
+// The message is formatted only if it passes the level check.
 template<typename... Args>
 inline void message(Logger::Level lvl, const char *fmt, Args&&... args) {
-    Logger::default_instance().log(lvl, format(fmt, std::forward<Args>(args)...));
+    auto& logger = Logger::default_instance();
+    if (!logger.is_enabled(lvl))
+        return;
+    struct DepthGuard {
+        DepthGuard() { ++detail::log_depth; }
+        ~DepthGuard() { --detail::log_depth; }
+    } depth_guard;
+    if (detail::log_depth == 1) {
+        logger.log(lvl, format_to_buffer(detail::log_buffer, fmt, args...));
+    } else {
+        fmt::memory_buffer buffer;
+        logger.log(lvl, format_to_buffer(buffer, fmt, args...));
+    }
+}
+
+template<Logger::Level lvl, typename... Args>
+inline void message(const char *fmt, Args&&... args) {
+    if constexpr (lvl >= Logger::min_level)
+        message(lvl, fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void trace(const char *fmt, Args&&... args) {
-    message(Logger::Level::Trace, fmt, std::forward<Args>(args)...);
+    message<Logger::Level::Trace>(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void debug(const char *fmt, Args&&... args) {
-    message(Logger::Level::Debug, fmt, std::forward<Args>(args)...);
+    message<Logger::Level::Debug>(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void info(const char *fmt, Args&&... args) {
-    message(Logger::Level::Info, fmt, std::forward<Args>(args)...);
+    message<Logger::Level::Info>(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void warning(const char *fmt, Args&&... args) {
-    message(Logger::Level::Warning, fmt, std::forward<Args>(args)...);
+    message<Logger::Level::Warning>(fmt, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 inline void error(const char *fmt, Args&&... args) {
-    message(Logger::Level::Error, fmt, std::forward<Args>(args)...);
+    message<Logger::Level::Error>(fmt, std::forward<Args>(args)...);
 }
 
 }  // namespace log
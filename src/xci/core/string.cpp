@@ -8,11 +8,23 @@
 #include "parser/unescape.h"
 #include <xci/core/log.h>
 
+#include <xci/compat/bit.h>
+
 #include <fmt/core.h>
+#include <bit>
 #include <cctype>
 #include <locale>
 #include <codecvt>
 #include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define XCI_STRING_SSE2
+    #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #define XCI_STRING_NEON
+    #include <arm_neon.h>
+#endif
 
 namespace xci::core {
 
@@ -74,6 +86,54 @@ vector<string_view> rsplit(string_view str, char delim, int maxsplit)
 }
 
 
+size_t CharSet::find_in(string_view str, size_t pos) const
+{
+    const char* data = str.data();
+    const size_t size = str.size();
+    if (pos >= size)
+        return string_view::npos;
+    if (m_count == 1) {
+        const auto* p = (const char*) std::memchr(data + pos, m_chars[0], size - pos);
+        return p ? size_t(p - data) : string_view::npos;
+    }
+#if defined(XCI_STRING_SSE2)
+    if (m_count != 0 && m_count <= sizeof(m_chars)) {
+        __m128i needles[sizeof(m_chars)];
+        for (unsigned i = 0; i != m_count; ++i)
+            needles[i] = _mm_set1_epi8(m_chars[i]);
+        for (; pos + 16 <= size; pos += 16) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+            __m128i eq = _mm_cmpeq_epi8(v, needles[0]);
+            for (unsigned i = 1; i != m_count; ++i)
+                eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, needles[i]));
+            const unsigned mask = unsigned(_mm_movemask_epi8(eq));
+            if (mask != 0)
+                return pos + count_trailing_zeros(mask);
+        }
+    }
+#elif defined(XCI_STRING_NEON)
+    if (m_count != 0 && m_count <= sizeof(m_chars)) {
+        uint8x16_t needles[sizeof(m_chars)];
+        for (unsigned i = 0; i != m_count; ++i)
+            needles[i] = vdupq_n_u8(uint8_t(m_chars[i]));
+        for (; pos + 16 <= size; pos += 16) {
+            const uint8x16_t v = vld1q_u8((const uint8_t*)(data + pos));
+            uint8x16_t eq = vceqq_u8(v, needles[0]);
+            for (unsigned i = 1; i != m_count; ++i)
+                eq = vorrq_u8(eq, vceqq_u8(v, needles[i]));
+            if (vmaxvq_u8(eq) != 0)
+                break;  // found in this block, the scalar loop finds the exact position
+        }
+    }
+#endif
+    for (; pos != size; ++pos) {
+        if (contains(data[pos]))
+            return pos;
+    }
+    return string_view::npos;
+}
+
+
 std::string escape(string_view str)
 {
     std::string out;
@@ -140,15 +200,523 @@ std::string to_lower(std::string_view str)
 }
 
 
+// -----------------------------------------------------------------------------
+// UTF-8 kernels
+//
+// The bulk work (ASCII runs, counting code points) is done in blocks
+// by SIMD (SSE2/AVX2 on x86_64, NEON on aarch64). `to_utf32` decodes
+// multi-byte characters one by one, `utf8_validate` checks them in blocks
+// (see "UTF-8 validation by lookup tables" below).
+
+// The scalar decoder handles at least one block before the fast path is retried
+static constexpr size_t c_utf8_block = 16;
+
+
+/// Decode and validate single UTF-8 character.
+/// \returns    length of the character in bytes, 0 if it's invalid
+static inline size_t utf8_decode(const char* data, size_t avail, char32_t& out)
+{
+    const auto* s = (const unsigned char*) data;
+    const unsigned c0 = s[0];
+    if (c0 < 0x80) {
+        out = c0;
+        return 1;
+    }
+    auto cont = [s](size_t i) { return (s[i] & 0xc0) == 0x80; };
+    if (c0 < 0xc2)
+        return 0;  // continuation byte or overlong 2-byte sequence
+    if (c0 < 0xe0) {
+        if (avail < 2 || !cont(1))
+            return 0;
+        out = char32_t(((c0 & 0x1f) << 6) | (s[1] & 0x3f));
+        return 2;
+    }
+    if (c0 < 0xf0) {
+        if (avail < 3 || !cont(1) || !cont(2))
+            return 0;
+        out = char32_t(((c0 & 0x0f) << 12) | ((s[1] & 0x3f) << 6) | (s[2] & 0x3f));
+        if (out < 0x800 || (out >= 0xd800 && out <= 0xdfff))
+            return 0;  // overlong or surrogate
+        return 3;
+    }
+    if (c0 < 0xf5) {
+        if (avail < 4 || !cont(1) || !cont(2) || !cont(3))
+            return 0;
+        out = char32_t(((c0 & 0x07) << 18) | ((s[1] & 0x3f) << 12) | ((s[2] & 0x3f) << 6) | (s[3] & 0x3f));
+        if (out < 0x10000 || out > 0x10ffff)
+            return 0;  // overlong or out of Unicode range
+        return 4;
+    }
+    return 0;
+}
+
+
+static size_t utf8_ascii_prefix_scalar(const char* data, size_t size)
+{
+    size_t pos = 0;
+    while (pos != size && (unsigned char) data[pos] < 0x80)
+        ++pos;
+    return pos;
+}
+
+static size_t utf8_count_scalar(const char* data, size_t size)
+{
+    size_t count = 0;
+    for (size_t pos = 0; pos != size; ++pos)
+        count += (data[pos] & 0xc0) != 0x80;
+    return count;
+}
+
+
+#if defined(XCI_STRING_SSE2)
+
+// Signed compare: bytes > -65 (0xBF) are not continuation bytes (10xxxxxx)
+static constexpr char c_utf8_cont_max = -65;
+
+static size_t utf8_ascii_prefix_sse2(const char* data, size_t size)
+{
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+        const unsigned mask = unsigned(_mm_movemask_epi8(v));
+        if (mask != 0)
+            return pos + count_trailing_zeros(mask);
+    }
+    return pos + utf8_ascii_prefix_scalar(data + pos, size - pos);
+}
+
+static size_t utf8_count_sse2(const char* data, size_t size)
+{
+    const __m128i cont_max = _mm_set1_epi8(c_utf8_cont_max);
+    size_t count = 0;
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+        count += std::popcount(unsigned(_mm_movemask_epi8(_mm_cmpgt_epi8(v, cont_max))));
+    }
+    return count + utf8_count_scalar(data + pos, size - pos);
+}
+
+static size_t utf8_widen_ascii_sse2(const char* data, size_t size, char32_t* out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        auto* o = (__m128i*)(out + pos);
+        _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi, zero));
+    }
+    return pos;
+}
+
+#ifndef _MSC_VER
+
+__attribute__((target("avx2")))
+static size_t utf8_ascii_prefix_avx2(const char* data, size_t size)
+{
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(data + pos));
+        const unsigned mask = unsigned(_mm256_movemask_epi8(v));
+        if (mask != 0)
+            return pos + count_trailing_zeros(mask);
+    }
+    return pos + utf8_ascii_prefix_sse2(data + pos, size - pos);
+}
+
+__attribute__((target("avx2")))
+static size_t utf8_count_avx2(const char* data, size_t size)
+{
+    const __m256i cont_max = _mm256_set1_epi8(c_utf8_cont_max);
+    size_t count = 0;
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(data + pos));
+        count += std::popcount(unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, cont_max))));
+    }
+    return count + utf8_count_sse2(data + pos, size - pos);
+}
+
+__attribute__((target("avx2")))
+static size_t utf8_widen_ascii_avx2(const char* data, size_t size, char32_t* out)
+{
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(data + pos));
+        if (_mm256_movemask_epi8(v) != 0)
+            break;
+        auto* o = (__m256i*)(out + pos);
+        for (int i = 0; i != 4; ++i) {
+            const __m128i part = _mm_loadl_epi64((const __m128i*)(data + pos + 8 * i));
+            _mm256_storeu_si256(o + i, _mm256_cvtepu8_epi32(part));
+        }
+    }
+    return pos + utf8_widen_ascii_sse2(data + pos, size - pos, out + pos);
+}
+
+static bool utf8_has_avx2()
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+#else
+
+static size_t utf8_ascii_prefix_avx2(const char* data, size_t size) { return utf8_ascii_prefix_sse2(data, size); }
+static size_t utf8_count_avx2(const char* data, size_t size) { return utf8_count_sse2(data, size); }
+static size_t utf8_widen_ascii_avx2(const char* data, size_t size, char32_t* out) { return utf8_widen_ascii_sse2(data, size, out); }
+static bool utf8_has_avx2() { return false; }
+
+#endif
+
+static size_t utf8_ascii_prefix(const char* data, size_t size)
+{
+    return utf8_has_avx2() ? utf8_ascii_prefix_avx2(data, size) : utf8_ascii_prefix_sse2(data, size);
+}
+
+static size_t utf8_count(const char* data, size_t size)
+{
+    return utf8_has_avx2() ? utf8_count_avx2(data, size) : utf8_count_sse2(data, size);
+}
+
+static size_t utf8_widen_ascii(const char* data, size_t size, char32_t* out)
+{
+    return utf8_has_avx2() ? utf8_widen_ascii_avx2(data, size, out) : utf8_widen_ascii_sse2(data, size, out);
+}
+
+#elif defined(XCI_STRING_NEON)
+
+static size_t utf8_ascii_prefix(const char* data, size_t size)
+{
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const uint8x16_t v = vld1q_u8((const uint8_t*)(data + pos));
+        if (vmaxvq_u8(v) >= 0x80)
+            break;
+    }
+    return pos + utf8_ascii_prefix_scalar(data + pos, size - pos);
+}
+
+static size_t utf8_count(const char* data, size_t size)
+{
+    const int8x16_t cont_max = vdupq_n_s8(-65);
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t count = 0;
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const int8x16_t v = vld1q_s8((const int8_t*)(data + pos));
+        count += vaddvq_u8(vandq_u8(vcgtq_s8(v, cont_max), one));
+    }
+    return count + utf8_count_scalar(data + pos, size - pos);
+}
+
+static size_t utf8_widen_ascii(const char* data, size_t size, char32_t* out)
+{
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const uint8x16_t v = vld1q_u8((const uint8_t*)(data + pos));
+        if (vmaxvq_u8(v) >= 0x80)
+            break;
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        auto* o = (uint32_t*)(out + pos);
+        vst1q_u32(o + 0, vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32(o + 4, vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32(o + 8, vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32(o + 12, vmovl_u16(vget_high_u16(hi)));
+    }
+    return pos;
+}
+
+#else
+
+static size_t utf8_ascii_prefix(const char* data, size_t size) { return utf8_ascii_prefix_scalar(data, size); }
+static size_t utf8_count(const char* data, size_t size) { return utf8_count_scalar(data, size); }
+static size_t utf8_widen_ascii(const char* data, size_t size, char32_t* out)
+{
+    const size_t n = utf8_ascii_prefix_scalar(data, size);
+    for (size_t pos = 0; pos != n; ++pos)
+        out[pos] = char32_t(data[pos]);
+    return n;
+}
+
+#endif
+
+
+// -----------------------------------------------------------------------------
+// UTF-8 validation by lookup tables
+//
+// Validates 16 bytes at once, including multi-byte characters. Each byte
+// is classified by three table lookups: high and low nibble of previous byte
+// and high nibble of current byte. AND of the three results has bits set
+// for errors in 2-byte sequences (overlong, surrogate, too large, missing
+// or extra continuation byte). The third and fourth bytes of longer
+// sequences are checked by comparing with lead bytes 2 and 3 positions back.
+// See "Validating UTF-8 In Less Than One Instruction Per Byte"
+// (Keiser, Lemire, 2021), the same algorithm is used by simdutf.
+
+#if defined(XCI_STRING_NEON) || (defined(XCI_STRING_SSE2) && !defined(_MSC_VER))
+#define XCI_STRING_UTF8_LOOKUP
+
+namespace utf8_lookup {
+
+// Error classes of 2-byte sequences (previous byte, current byte)
+constexpr uint8_t c_too_short = 1 << 0;  // lead byte not followed by continuation
+constexpr uint8_t c_too_long = 1 << 1;  // ASCII followed by continuation
+constexpr uint8_t c_overlong_3 = 1 << 2;
+constexpr uint8_t c_too_large = 1 << 3;
+constexpr uint8_t c_surrogate = 1 << 4;
+constexpr uint8_t c_overlong_2 = 1 << 5;
+constexpr uint8_t c_too_large_1000 = 1 << 6;
+constexpr uint8_t c_overlong_4 = 1 << 6;
+constexpr uint8_t c_two_conts = 1 << 7;  // continuation after continuation, checked by length
+constexpr uint8_t c_carry = c_too_short | c_too_long | c_two_conts;
+
+// indexed by high nibble of previous byte
+alignas(16) constexpr uint8_t c_byte_1_high[16] = {
+    // 0_______ ASCII
+    c_too_long, c_too_long, c_too_long, c_too_long,
+    c_too_long, c_too_long, c_too_long, c_too_long,
+    // 10______ continuation
+    c_two_conts, c_two_conts, c_two_conts, c_two_conts,
+    // 1100____ 2-byte lead
+    c_too_short | c_overlong_2,
+    // 1101____ 2-byte lead
+    c_too_short,
+    // 1110____ 3-byte lead
+    c_too_short | c_overlong_3 | c_surrogate,
+    // 1111____ 4-byte lead
+    c_too_short | c_too_large | c_too_large_1000 | c_overlong_4,
+};
+
+// indexed by low nibble of previous byte
+alignas(16) constexpr uint8_t c_byte_1_low[16] = {
+    // ____0000
+    c_carry | c_overlong_3 | c_overlong_2 | c_overlong_4,
+    // ____0001
+    c_carry | c_overlong_2,
+    // ____001_
+    c_carry,
+    c_carry,
+    // ____0100
+    c_carry | c_too_large,
+    // ____0101 - ____1111
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+    // ____1101
+    c_carry | c_too_large | c_too_large_1000 | c_surrogate,
+    c_carry | c_too_large | c_too_large_1000,
+    c_carry | c_too_large | c_too_large_1000,
+};
+
+// indexed by high nibble of current byte
+alignas(16) constexpr uint8_t c_byte_2_high[16] = {
+    // 0_______ ASCII
+    c_too_short, c_too_short, c_too_short, c_too_short,
+    c_too_short, c_too_short, c_too_short, c_too_short,
+    // 1000____
+    c_too_long | c_overlong_2 | c_two_conts | c_overlong_3 | c_too_large_1000 | c_overlong_4,
+    // 1001____
+    c_too_long | c_overlong_2 | c_two_conts | c_overlong_3 | c_too_large,
+    // 101_____
+    c_too_long | c_overlong_2 | c_two_conts | c_surrogate | c_too_large,
+    c_too_long | c_overlong_2 | c_two_conts | c_surrogate | c_too_large,
+    // 11______ lead
+    c_too_short, c_too_short, c_too_short, c_too_short,
+};
+
+// Bytes above these at the end of a block start an incomplete sequence
+alignas(16) constexpr uint8_t c_incomplete_max[16] = {
+    255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+};
+
+} // namespace utf8_lookup
+
+#endif
+
+#if defined(XCI_STRING_SSE2) && defined(XCI_STRING_UTF8_LOOKUP)
+
+/// Error bits of a block (non-zero if invalid), except incomplete sequence at its end.
+/// PSHUFB (table lookup) needs SSSE3.
+__attribute__((target("ssse3")))
+static inline __m128i utf8_lookup_errors_ssse3(__m128i input, __m128i prev_input)
+{
+    using namespace utf8_lookup;
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    const __m128i special = _mm_and_si128(_mm_and_si128(
+            _mm_shuffle_epi8(_mm_load_si128((const __m128i*) c_byte_1_high),
+                             _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+            _mm_shuffle_epi8(_mm_load_si128((const __m128i*) c_byte_1_low),
+                             _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(_mm_load_si128((const __m128i*) c_byte_2_high),
+                             _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+    // Third and fourth bytes of a sequence must be continuations,
+    // these are the only allowed c_two_conts reported by the lookup
+    const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+    const __m128i must_be_cont = _mm_and_si128(_mm_or_si128(
+            _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80))),
+            _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)))),
+            _mm_set1_epi8(char(0x80)));
+    return _mm_xor_si128(must_be_cont, special);
+}
+
+__attribute__((target("ssse3")))
+static bool utf8_validate_ssse3(const char* data, size_t size)
+{
+    const __m128i incomplete_max = _mm_load_si128((const __m128i*) utf8_lookup::c_incomplete_max);
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    alignas(16) char tail[16] {};
+    for (size_t pos = 0; pos < size + 1; pos += 16) {
+        // skip ASCII by 64 bytes, retried after each 4 blocks with non-ASCII
+        while ((pos & 63) == 0 && pos + 64 <= size) {
+            const auto* p = (const __m128i*)(data + pos);
+            const __m128i last = _mm_loadu_si128(p + 3);
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                             _mm_or_si128(_mm_loadu_si128(p + 2), last));
+            if (_mm_movemask_epi8(any) != 0)
+                break;
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_incomplete = _mm_setzero_si128();
+            prev_input = last;
+            pos += 64;
+        }
+        __m128i input;
+        if (pos + 16 <= size) {
+            input = _mm_loadu_si128((const __m128i*)(data + pos));
+        } else {
+            // the tail is padded by zeros (ASCII), that also catches
+            // a sequence not finished at the end of input
+            std::memcpy(tail, data + pos, size - pos);
+            input = _mm_load_si128((const __m128i*) tail);
+        }
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_incomplete = _mm_setzero_si128();
+        } else {
+            error = _mm_or_si128(error, utf8_lookup_errors_ssse3(input, prev_input));
+            prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+        }
+        prev_input = input;
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+}
+
+static bool utf8_has_ssse3()
+{
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    return has_ssse3;
+}
+
+#elif defined(XCI_STRING_NEON)
+
+/// Error bits of a block (non-zero if invalid), except incomplete sequence at its end
+static inline uint8x16_t utf8_lookup_errors_neon(uint8x16_t input, uint8x16_t prev_input)
+{
+    using namespace utf8_lookup;
+    const uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+    const uint8x16_t special = vandq_u8(vandq_u8(
+            vqtbl1q_u8(vld1q_u8(c_byte_1_high), vshrq_n_u8(prev1, 4)),
+            vqtbl1q_u8(vld1q_u8(c_byte_1_low), vandq_u8(prev1, vdupq_n_u8(0x0f)))),
+            vqtbl1q_u8(vld1q_u8(c_byte_2_high), vshrq_n_u8(input, 4)));
+    // Third and fourth bytes of a sequence must be continuations,
+    // these are the only allowed c_two_conts reported by the lookup
+    const uint8x16_t prev2 = vextq_u8(prev_input, input, 14);
+    const uint8x16_t prev3 = vextq_u8(prev_input, input, 13);
+    const uint8x16_t must_be_cont = vandq_u8(vorrq_u8(
+            vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80)),
+            vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80))),
+            vdupq_n_u8(0x80));
+    return veorq_u8(must_be_cont, special);
+}
+
+static bool utf8_validate_neon(const char* data, size_t size)
+{
+    const uint8x16_t incomplete_max = vld1q_u8(utf8_lookup::c_incomplete_max);
+    uint8x16_t error = vdupq_n_u8(0);
+    uint8x16_t prev_input = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+    alignas(16) uint8_t tail[16] {};
+    for (size_t pos = 0; pos < size + 1; pos += 16) {
+        // skip ASCII by 64 bytes, retried after each 4 blocks with non-ASCII
+        while ((pos & 63) == 0 && pos + 64 <= size) {
+            const uint8x16x4_t v = vld1q_u8_x4((const uint8_t*)(data + pos));
+            if (vmaxvq_u8(vorrq_u8(vorrq_u8(v.val[0], v.val[1]), vorrq_u8(v.val[2], v.val[3]))) >= 0x80)
+                break;
+            error = vorrq_u8(error, prev_incomplete);
+            prev_incomplete = vdupq_n_u8(0);
+            prev_input = v.val[3];
+            pos += 64;
+        }
+        uint8x16_t input;
+        if (pos + 16 <= size) {
+            input = vld1q_u8((const uint8_t*)(data + pos));
+        } else {
+            // the tail is padded by zeros (ASCII), that also catches
+            // a sequence not finished at the end of input
+            std::memcpy(tail, data + pos, size - pos);
+            input = vld1q_u8(tail);
+        }
+        if (vmaxvq_u8(input) < 0x80) {
+            error = vorrq_u8(error, prev_incomplete);
+            prev_incomplete = vdupq_n_u8(0);
+        } else {
+            error = vorrq_u8(error, utf8_lookup_errors_neon(input, prev_input));
+            prev_incomplete = vqsubq_u8(input, incomplete_max);
+        }
+        prev_input = input;
+    }
+    return vmaxvq_u8(error) == 0;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+
+
 std::u32string to_utf32(string_view utf8)
 {
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> convert_utf32;
-    try {
-        return convert_utf32.from_bytes(utf8.data(), utf8.data() + utf8.size());
-    } catch (const std::range_error& e) {
-        log::error("to_utf32: Invalid UTF8 string: {} ({})", utf8, e.what());
-        return std::u32string();
+    // number of code points <= number of bytes
+    std::u32string result(utf8.size(), U'\0');
+    const char* data = utf8.data();
+    const size_t size = utf8.size();
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos != size) {
+        const size_t ascii = utf8_widen_ascii(data + pos, size - pos, result.data() + out);
+        pos += ascii;
+        out += ascii;
+        // decode the non-ASCII block, then try the fast path again
+        const size_t block_end = std::min(size, pos + c_utf8_block);
+        while (pos < block_end) {
+            const size_t len = utf8_decode(data + pos, size - pos, result[out]);
+            if (len == 0) {
+                log::error("to_utf32: Invalid UTF8 string: {}", utf8);
+                return {};
+            }
+            pos += len;
+            ++out;
+        }
     }
+    result.resize(out);
+    return result;
 }
 
 
@@ -225,11 +793,7 @@ template std::string_view::const_reverse_iterator utf8_prev(std::string_view::co
 template <class S, class SSize>
 SSize utf8_length(const S& str)
 {
-    SSize length = 0;
-    for (auto pos = str.cbegin(); pos != str.cend(); pos = utf8_next(pos)) {
-        ++length;
-    }
-    return length;
+    return SSize(utf8_count(str.data(), str.size()));
 }
 
 // instantiate the template (these are the only supported types)
@@ -253,6 +817,33 @@ string_view utf8_substr(string_view str, size_t pos, size_t count)
 }
 
 
+bool utf8_validate(string_view str)
+{
+    const char* data = str.data();
+    const size_t size = str.size();
+#if defined(XCI_STRING_SSE2) && defined(XCI_STRING_UTF8_LOOKUP)
+    if (utf8_has_ssse3())
+        return utf8_validate_ssse3(data, size);
+#elif defined(XCI_STRING_NEON)
+    return utf8_validate_neon(data, size);
+#endif
+    // no table lookup instruction (SSE2 only, MSVC) - fast path for ASCII
+    size_t pos = 0;
+    while (pos != size) {
+        pos += utf8_ascii_prefix(data + pos, size - pos);
+        const size_t block_end = std::min(size, pos + c_utf8_block);
+        while (pos < block_end) {
+            char32_t c;
+            const size_t len = utf8_decode(data + pos, size - pos, c);
+            if (len == 0)
+                return false;
+            pos += len;
+        }
+    }
+    return true;
+}
+
+
 char32_t utf8_codepoint(const char* utf8)
 {
     char c0 = utf8[0];
@@ -10,6 +10,9 @@
 #include <string_view>
 #include <string>
 #include <vector>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
 
 namespace xci::core {
 
@@ -29,6 +32,116 @@ bool remove_suffix(std::string& str, const std::string& suffix);
 std::vector<std::string_view> split(std::string_view str, char delim, int maxsplit = -1);
 std::vector<std::string_view> rsplit(std::string_view str, char delim, int maxsplit = -1);
 
+
+/// Set of characters, e.g. delimiters for `split_view`.
+/// Membership is tested in a bitmap, `find_in` searches by SIMD
+/// for sets of up to 4 characters, single character uses memchr.
+class CharSet {
+public:
+    constexpr CharSet(char c) { add(c); }  // NOLINT
+    constexpr CharSet(std::string_view chars) { for (char c : chars) add(c); }  // NOLINT
+    constexpr CharSet(const char* chars) : CharSet(std::string_view(chars)) {}  // NOLINT
+
+    constexpr bool contains(char c) const {
+        const auto b = uint8_t(c);
+        return (m_bits[b >> 6] >> (b & 63)) & 1;
+    }
+
+    /// Find first occurrence of any character from the set
+    /// \returns   position in `str` or npos
+    size_t find_in(std::string_view str, size_t pos = 0) const;
+
+private:
+    constexpr void add(char c) {
+        if (contains(c))
+            return;
+        const auto b = uint8_t(c);
+        m_bits[b >> 6] |= uint64_t(1) << (b & 63);
+        if (m_count < sizeof(m_chars))
+            m_chars[m_count] = c;
+        ++m_count;
+    }
+
+    uint64_t m_bits[4] {};
+    char m_chars[4] {};  // first chars, for SIMD search
+    unsigned m_count = 0;
+};
+
+
+/// Lazy split - a range of parts, which doesn't allocate:
+///
+///     for (std::string_view part : split_view("a,b;c", ",;"))
+///         ...
+///
+/// The parts are same as returned by `split`, the delimiter
+/// can be a single character or a set of characters.
+class SplitView {
+public:
+    SplitView(std::string_view str, CharSet delims, int maxsplit = -1)
+        : m_str(str), m_delims(delims), m_maxsplit(maxsplit) {}
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        iterator(const SplitView& view, size_t pos, int maxsplit)
+            : m_view(&view), m_pos(pos), m_maxsplit(maxsplit) { find_end(); }
+
+        reference operator*() const { return m_part; }
+        pointer operator->() const { return &m_part; }
+
+        iterator& operator++() {
+            if (m_end == m_view->m_str.size()) {
+                m_pos = std::string_view::npos;  // this was the last part
+                return *this;
+            }
+            m_pos = m_end + 1;
+            if (m_maxsplit > 0)
+                --m_maxsplit;
+            find_end();
+            return *this;
+        }
+        iterator operator++(int) { auto orig = *this; ++*this; return orig; }
+
+        bool operator==(const iterator& rhs) const { return m_pos == rhs.m_pos; }
+
+    private:
+        void find_end() {
+            if (m_pos == std::string_view::npos)
+                return;
+            const auto str = m_view->m_str;
+            m_end = m_maxsplit == 0 ? std::string_view::npos : m_view->m_delims.find_in(str, m_pos);
+            if (m_end == std::string_view::npos)
+                m_end = str.size();
+            m_part = str.substr(m_pos, m_end - m_pos);
+        }
+
+        const SplitView* m_view = nullptr;
+        size_t m_pos = std::string_view::npos;  // start of current part, npos = end
+        size_t m_end = 0;  // end of current part (position of delimiter)
+        int m_maxsplit = 0;
+        std::string_view m_part;
+    };
+
+    iterator begin() const { return {*this, 0, m_maxsplit}; }
+    iterator end() const { return {}; }
+
+private:
+    std::string_view m_str;
+    CharSet m_delims;
+    int m_maxsplit;
+};
+
+inline SplitView split_view(std::string_view str, CharSet delims, int maxsplit = -1) {
+    return {str, delims, maxsplit};
+}
+
+
 // Strip chars from start of a string
 template <class T>
 void lstrip(std::string &str, T strip_chars) {
@@ -81,6 +194,29 @@ void strip(S& str, T strip_chars) { lstrip(str, strip_chars); rstrip(str, strip_
 template <class S>
 void strip(S& str) { lstrip(str); rstrip(str); }
 
+// Stripped views - the result points into original string, nothing is copied
+
+template <class T = const char*>
+[[nodiscard]] std::string_view
+lstrip_view(std::string_view str, T strip_chars = whitespace_chars) {
+    lstrip(str, strip_chars);
+    return str;
+}
+
+template <class T = const char*>
+[[nodiscard]] std::string_view
+rstrip_view(std::string_view str, T strip_chars = whitespace_chars) {
+    rstrip(str, strip_chars);
+    return str;
+}
+
+template <class T = const char*>
+[[nodiscard]] std::string_view
+strip_view(std::string_view str, T strip_chars = whitespace_chars) {
+    strip(str, strip_chars);
+    return str;
+}
+
 
 // Escape non-printable characters with C escape sequences (eg. '\n')
 std::string escape(std::string_view str);
@@ -116,6 +252,11 @@ SSize utf8_length(const S& str);
 
 std::string_view utf8_substr(std::string_view str, size_t pos, size_t count);
 
+// Check that the string is valid UTF-8: no stray continuation bytes,
+// truncated or overlong sequences, surrogates or code points above U+10FFFF.
+// Multi-byte characters are validated by SIMD as well (SSSE3 or NEON).
+bool utf8_validate(std::string_view str);
+
 // Convert single UTF-8 character to Unicode code point.
 // Only the first UTF-8 character is used, rest of input is ignored.
 // In case of error, log error and return 0.
@@ -11,6 +11,8 @@
 #include <xci/core/macros/foreach.h>
 #include <boost/pfr/precise/core.hpp>
 #include <vector>
+#include <tuple>
+#include <utility>
 #include <cstdint>
 
 #ifndef __cpp_concepts
@@ -37,6 +39,37 @@ template<typename T> ArchiveField(uint8_t, T&, const char*) -> ArchiveField<T>;
     )
 
 
+/// Field of a compile-time archive schema, see XCI_ARCHIVE_SCHEMA.
+template <class C, typename M>
+struct ArchiveSchemaField {
+    M C::* member;
+    const char* name;
+};
+template<class C, typename M> ArchiveSchemaField(M C::*, const char*) -> ArchiveSchemaField<C, M>;
+
+// Compile-time schema - alternative to serialize() method:
+//
+//     struct MyStruct {
+//         int a, b, c;
+//         XCI_ARCHIVE_SCHEMA(MyStruct, a, b, c)
+//     };
+//
+// The keys are assigned by position: a=0, b=1, c=2.
+// The serialization routine is generated at compile time, without
+// run-time key allocation. When both schema and serialize() are present,
+// the archives use the schema.
+#define XCI_ARCHIVE_SCHEMA_FIELD(cls, mbr) xci::data::ArchiveSchemaField{&cls::mbr, #mbr}
+#define XCI_ARCHIVE_SCHEMA(cls, ...)                                                                \
+    static constexpr auto archive_schema() {                                                        \
+        return std::tuple{                                                                          \
+            XCI_FOREACH(XCI_ARCHIVE_SCHEMA_FIELD, cls, XCI_COMMA, __VA_ARGS__)                      \
+        };                                                                                          \
+    }
+
+
+template<typename T>
+concept TypeWithSchema = requires { T::archive_schema(); };
+
 template<typename T, typename TArchive>
 concept TypeWithSerialize = requires(T& v, TArchive& ar) { v.serialize(ar); };
 
@@ -80,10 +113,28 @@ public:
         apply(ArchiveField<T>{key_auto, value});
     }
 
-    // when: the type has serialize() method
-    template <TypeWithSerialize<TImpl> T>
+    // convenience: ar.apply(ArchiveField{key, value}) -> allocate the key, then dispatch by type
+    template <typename T>
     void apply(ArchiveField<T>&& kv) {
         kv.key = draw_next_key(kv.key);
+        apply_keyed(std::move(kv));
+    }
+
+protected:
+    // when: the type has compile-time schema
+    template <TypeWithSchema T>
+    void apply_keyed(ArchiveField<T>&& kv) {
+        constexpr auto schema = T::archive_schema();
+        static_assert(std::tuple_size_v<decltype(schema)> <= key_max + 1, "too many fields in schema");
+        static_cast<TImpl*>(this)->enter_group(kv.key, kv.name);
+        apply_schema(kv.value, schema, std::make_index_sequence<std::tuple_size_v<decltype(schema)>>{});
+        static_cast<TImpl*>(this)->leave_group(kv.key, kv.name);
+    }
+
+    // when: the type has serialize() method
+    template <TypeWithSerialize<TImpl> T>
+    requires (!TypeWithSchema<T>)
+    void apply_keyed(ArchiveField<T>&& kv) {
         static_cast<TImpl*>(this)->enter_group(kv.key, kv.name);
         kv.value.serialize(*static_cast<TImpl*>(this));
         static_cast<TImpl*>(this)->leave_group(kv.key, kv.name);
@@ -91,17 +142,15 @@ public:
 
     // when: Archive implementation has add() method for the type
     template <TypeWithArchiveSupport<TImpl> T>
-    void apply(ArchiveField<T>&& kv) {
-        kv.key = draw_next_key(kv.key);
+    void apply_keyed(ArchiveField<T>&& kv) {
         static_cast<TImpl*>(this)->add(std::forward<ArchiveField<T>>(kv));
     }
 
     // when: other non-polymorphic structs - use magic_get
     template <typename T>
-    requires (std::is_class_v<T> && !std::is_polymorphic_v<T> &&
+    requires (std::is_class_v<T> && !std::is_polymorphic_v<T> && !TypeWithSchema<T> &&
             !TypeWithSerialize<T, TImpl> && !TypeWithArchiveSupport<T, TImpl>)
-    void apply(ArchiveField<T>&& kv) {
-        kv.key = draw_next_key(kv.key);
+    void apply_keyed(ArchiveField<T>&& kv) {
         static_cast<TImpl*>(this)->enter_group(kv.key, kv.name);
         boost::pfr::for_each_field(kv.value, [&](auto& field) {
             apply(field);
@@ -109,6 +158,19 @@ public:
         static_cast<TImpl*>(this)->leave_group(kv.key, kv.name);
     }
 
+    // Keys of schema fields are known at compile time. Only the next key
+    // is updated for each field, so repeated keys of iterables can be checked.
+    template <typename T, typename TSchema, size_t... I>
+    void apply_schema(T& value, const TSchema& schema, std::index_sequence<I...>) {
+        ((void) apply_schema_field(uint8_t(I), value, std::get<I>(schema)), ...);
+    }
+
+    template <typename T, typename M>
+    void apply_schema_field(uint8_t key, T& value, const ArchiveSchemaField<T, M>& field) {
+        m_group_stack.back().next_key = key + 1;
+        apply_keyed(ArchiveField<M>{key, value.*field.member, field.name});
+    }
+
 protected:
 
     static constexpr uint8_t key_max = 15;
@@ -12,6 +12,8 @@
 #include <cstdint>
 #include <vector>
 #include <bitset>
+#include <ranges>
+#include <algorithm>
 
 namespace xci::data {
 
@@ -85,9 +87,15 @@ protected:
         ChecksumCNone   = 0b00000000,
         ChecksumCrc32   = 0b00000100,
         ChecksumSha256  = 0b00001000,
+        ChecksumCrc32C  = 0b00001100,
         ChecksumMask    = 0b00001100,
     };
 
+    enum Feature: uint8_t {
+        ChunkIndex      = 0b01000000,
+        UnknownSize     = 0b10000000,  // streaming mode, SIZE=0, records until EOF
+    };
+
     enum Type: uint8_t {
         // chunk type, upper 4 bits
         Null        =  0 << 4,
@@ -137,13 +145,42 @@ protected:
     template<class T> requires std::is_same_v<T, double>
     static constexpr Type to_chunk_type() { return Type::Float64; }
 
+public:
+    /// Does the type map to one of fixed-size chunk types?
+    template<class T>
+    static constexpr bool has_chunk_type = requires { to_chunk_type<T>(); };
+
+protected:
+    /// Reverse byte order of a number (for reading archive with foreign endianness)
+    template<class T> requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    static T byteswap(T value) {
+        auto* bytes = reinterpret_cast<std::byte*>(&value);
+        std::reverse(bytes, bytes + sizeof(T));
+        return value;
+    }
+
     enum ControlSubtype: uint8_t {
         Metadata    = 0,
         Data        = 1,
     };
+
+    // Keys of metadata chunks
+    enum MetadataKey: uint8_t {
+        MetaChecksum        = 1,
+        MetaChunkIndex      = 2,
+        MetaChunkIndexPos   = 3,
+    };
 };
 
 
+/// Resizable contiguous container of numbers (e.g. std::vector<float>),
+/// serialized in bulk, as a single Array chunk.
+template<typename T>
+concept BinaryBulkArray = std::ranges::contiguous_range<T> &&
+        requires(T& v, size_t n) { v.resize(n); } &&
+        BinaryBase::has_chunk_type<std::ranges::range_value_t<T>>;
+
+
 } // namespace xci::data
 
 #endif // include guard
@@ -0,0 +1,94 @@
+// BinaryBufferReader.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "BinaryBufferReader.h"
+
+namespace xci::data {
+
+
+void BinaryBufferReader::load_chunk_index()
+{
+    m_index_loaded = true;
+    if (!has_chunk_index())
+        return;
+
+    // Metadata at the end of content:
+    //      ... <Binary|MetaChunkIndex><LEN><index> <UInt64|MetaChunkIndexPos><POS:64> [<UInt32|MetaChecksum><CRC:32>]
+    const std::byte* end = m_content_end;
+    if (has_crc_flag())
+        end -= 5;
+    if (end - m_content < 9 || uint8_t(*(end - 9)) != (Type::UInt64 | uint8_t(MetaChunkIndexPos)))
+        throw ArchiveBadChunkType();
+    uint64_t index_pos;
+    std::memcpy(&index_pos, end - 8, sizeof(index_pos));
+    if (m_byte_swap)
+        index_pos = byteswap(index_pos);
+    if (index_pos >= uint64_t(end - 9 - m_content))
+        throw ArchiveUnexpectedEnd();
+
+    const std::byte* iter = m_content + index_pos;
+    if (uint8_t(*iter) != (Type::Binary | uint8_t(MetaChunkIndex)))
+        throw ArchiveBadChunkType();
+    ++iter;
+    const auto index_size = decode_leb128<size_t>(iter);
+    const std::byte* index_end = iter + index_size;
+    if (index_end > end - 9)
+        throw ArchiveUnexpectedEnd();
+
+    while (iter < index_end) {
+        IndexEntry entry;
+        entry.parent = decode_leb128<size_t>(iter);
+        entry.key = uint8_t(*iter++);
+        entry.offset = decode_leb128<size_t>(iter);
+        if (iter > index_end || entry.parent > m_index.size())
+            throw ArchiveUnexpectedEnd();
+        m_index.push_back(entry);
+    }
+}
+
+
+auto BinaryBufferReader::find_chunk(const ChunkPath& path) -> std::pair<const std::byte*, size_t>
+{
+    if (!m_index_loaded)
+        load_chunk_index();
+    if (path.empty())
+        return {nullptr, 0};
+
+    size_t parent = 0;  // 1-based entry index, 0 = root
+    const std::byte* parent_content = m_content;
+    const std::byte* head = nullptr;
+    size_t chunk_size = 0;
+    for (const auto& elem : path) {
+        // find the entry: children follow their parent
+        size_t item = 0;
+        size_t found = 0;
+        for (size_t i = parent; i != m_index.size(); ++i) {
+            const auto& entry = m_index[i];
+            if (entry.parent == parent && entry.key == elem.key && item++ == elem.item) {
+                found = i + 1;
+                break;
+            }
+        }
+        if (found == 0)
+            return {nullptr, 0};
+
+        // locate the chunk, decode its head to find the content
+        head = parent_content + m_index[found - 1].offset;
+        if (head >= m_content_end || uint8_t(*head) != (Type::Master | elem.key))
+            throw ArchiveBadChunkType();
+        const std::byte* iter = head + 1;
+        const auto length = decode_leb128<size_t>(iter);
+        if (length > size_t(m_content_end - iter))
+            throw ArchiveUnexpectedEnd();
+        chunk_size = (iter - head) + length;
+        parent_content = iter;
+        parent = found;
+    }
+    return {head, chunk_size};
+}
+
+
+} // namespace xci::data
@@ -0,0 +1,187 @@
+// BinaryBufferReader.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_DATA_BINARY_BUFFER_READER_H
+#define XCI_DATA_BINARY_BUFFER_READER_H
+
+#include "BinaryReaderBase.h"
+#include <xci/core/Buffer.h>
+
+#include <span>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstring>
+
+namespace xci::data {
+
+
+/// Element of a path to Master chunk: the key and the item number,
+/// when the key is repeated in the group (e.g. vector of structs).
+struct ChunkKey {
+    uint8_t key;
+    size_t item = 0;
+};
+using ChunkPath = std::vector<ChunkKey>;
+
+
+/// Reads serializable objects from a contiguous buffer in memory,
+/// e.g. `core::Buffer` from `Vfs::read_file` or a memory-mapped file.
+///
+/// Works the same as BinaryReader, but without the overhead of std::istream.
+/// Additionally, strings and binary data can be read without copying,
+/// as `std::string_view` and `std::span<const std::byte>`. These point into
+/// the buffer, which must outlive them.
+///
+/// The CRC is computed over the whole buffer at once, in `finish_and_check`.
+///
+/// Archives written with `BinaryWriter::enable_chunk_index` can be also read
+/// randomly - `read_at` seeks to a Master chunk and decodes only that object:
+///
+///     BinaryBufferReader reader(buffer);
+///     reader.read_at({{0}, {2, 5}}, item);  // 6th item with key 2 in object with key 0
+///
+
+class BinaryBufferReader : public BinaryReaderBase<BinaryBufferReader> {
+    friend ArchiveBase<BinaryBufferReader>;
+    friend BinaryReaderBase<BinaryBufferReader>;
+
+public:
+    explicit BinaryBufferReader(std::span<const std::byte> data)
+        : m_begin(data.data()), m_pos(m_begin), m_end(m_begin + data.size())
+    {
+        read_header();
+        m_content = m_pos;
+        if (group_buffer().size > size_t(m_end - m_pos))
+            throw ArchiveUnexpectedEnd();
+        m_content_end = m_content + group_buffer().size;
+    }
+    explicit BinaryBufferReader(const core::Buffer& buffer)
+        : BinaryBufferReader(std::span<const std::byte>{buffer.data(), buffer.size()}) {}
+
+    using BinaryReaderBase::add;
+
+    // string view (zero-copy)
+    void add(ArchiveField<std::string_view>&& a) {
+        const auto chunk_type = read_chunk_head(a.key);
+        if (chunk_type == Type::String) {
+            const auto length = read_leb128<size_t>();
+            a.value = {(const char*) take(length), length};
+        } else if (chunk_type != ChunkNotFound)
+            throw ArchiveBadChunkType();
+    }
+
+    // binary data (zero-copy)
+    void add(ArchiveField<std::span<const std::byte>>&& a) {
+        const auto chunk_type = read_chunk_head(a.key);
+        if (chunk_type == Type::Binary) {
+            const auto length = read_leb128<size_t>();
+            a.value = {take(length), length};
+        } else if (chunk_type != ChunkNotFound)
+            throw ArchiveBadChunkType();
+    }
+
+    /// Number of bytes consumed from the buffer
+    size_t position() const { return m_pos - m_begin; }
+
+    /// Was the archive written with chunk index?
+    bool has_chunk_index() const { return m_flags & ChunkIndex; }
+
+    /// Read an object from Master chunk found by `path`, using the chunk index.
+    /// This doesn't affect sequential reading, which can continue
+    /// from the position before the call.
+    /// \param path     the keys of nested groups, from root to the object
+    /// \param value    the object to be deserialized
+    /// \returns        false if the path was not found in the index
+    ///                 (it doesn't exist or it's not indexed)
+    template <typename T>
+    bool read_at(const ChunkPath& path, T& value) {
+        const auto [chunk, chunk_size] = find_chunk(path);
+        if (chunk == nullptr)
+            return false;
+        // temporarily replace the state, read the chunk as a top-level object
+        const std::byte* orig_pos = m_pos;
+        auto orig_group_stack = std::move(m_group_stack);
+        m_group_stack.clear();
+        m_group_stack.emplace_back();
+        group_buffer().size = chunk_size;
+        m_pos = chunk;
+        try {
+            apply(ArchiveField<T>{path.back().key, value});
+        } catch (...) {
+            m_pos = orig_pos;
+            m_group_stack = std::move(orig_group_stack);
+            throw;
+        }
+        m_pos = orig_pos;
+        m_group_stack = std::move(orig_group_stack);
+        return true;
+    }
+
+private:
+    /// Find Master chunk in the index
+    /// \returns pointer to the chunk head and size of the whole chunk,
+    ///          or nullptr if not found
+    std::pair<const std::byte*, size_t> find_chunk(const ChunkPath& path);
+    void load_chunk_index();
+
+    /// Consume `length` bytes, return pointer to them
+    const std::byte* take(size_t length) {
+        if (length > group_buffer().size || length > size_t(m_end - m_pos))
+            throw ArchiveUnexpectedEnd();
+        group_buffer().size -= length;
+        const std::byte* data = m_pos;
+        m_pos += length;
+        return data;
+    }
+
+    void read_with_crc(std::byte* buffer, size_t length) {
+        std::memcpy(buffer, take(length), length);
+    }
+
+    std::byte read_byte_with_crc() { return *take(1); }
+
+    std::byte peek_byte() {
+        if (m_pos == m_end)
+            throw ArchiveUnexpectedEnd();
+        return *m_pos;
+    }
+
+    void skip_with_crc(uint8_t type, uint8_t key, size_t length) {
+        const std::byte* data = take(length);
+        if (m_unknown_chunk_cb)
+            m_unknown_chunk_cb(type, key, data, length);
+    }
+
+    // CRC is computed in one go in finish_crc, from the start of the buffer
+    void start_crc(const uint8_t (&)[4]) {}
+    uint32_t finish_crc() const {
+        Crc32 crc(crc_variant());
+        crc.feed(m_begin, m_pos - m_begin);
+        return crc.as_uint32();
+    }
+
+private:
+    const std::byte* m_begin;
+    const std::byte* m_pos;
+    const std::byte* m_end;
+    const std::byte* m_content = nullptr;  // start of content (after header)
+    const std::byte* m_content_end = nullptr;
+
+    // chunk index, loaded on demand
+    struct IndexEntry {
+        size_t parent;  // 1-based index of parent entry, 0 = root
+        size_t offset;  // position of Master chunk head in parent group content
+        uint8_t key;
+    };
+    std::vector<IndexEntry> m_index;
+    bool m_index_loaded = false;
+};
+
+
+} // namespace xci::data
+
+#endif // include guard
@@ -5,81 +5,55 @@
 // Licensed under the Apache License, Version 2.0 (see LICENSE file)
 
 #include "BinaryReader.h"
-#include <zlib.h>
 
 namespace xci::data {
 
 
-void BinaryReader::read_header() {
-    // This size is decreased with every read.
-    // Initial value is used only for reading the header,
-    // then overwritten by actual value from the header.
-    group_buffer().size = 10;
-
-    uint8_t header[4];
-    read_with_crc((std::byte*)header, sizeof(header));
-
-    // MAGIC:16
-    if (header[0] != Magic0 || header[1] != Magic1)
-        throw ArchiveBadMagic();
-
-    // VERSION:8
-    if (header[2] != Version)
-        throw ArchiveBadVersion();
-
-    // FLAGS:8
-    auto endianness = (header[3] & EndiannessMask);
-    if (endianness != LittleEndian)
-        throw ArchiveBadFlags();
-    m_has_crc = (header[3] & ChecksumMask) == ChecksumCrc32;
-
-    // add header to CRC checksum
-    if (m_has_crc)
-        m_crc(header);
-
-    // SIZE:var
-    group_buffer().size = read_leb128<size_t>();
-}
-
-
-void BinaryReader::read_footer()
+size_t BinaryReader::peek_record_size()
 {
-    // read chunks until Control/Metadata
-    for (;;) {
-        if (group_buffer().size == 0) {
-            if (m_has_crc)
-                throw ArchiveMissingChecksum();
-            return;  // no footer
-        }
-        uint8_t b;
-        read_with_crc(b);
-        const uint8_t chunk_key = b & KeyMask;
-        const uint8_t chunk_type = b & TypeMask;
-        if (chunk_type != Type::Control || chunk_key != Metadata) {
-            skip_unknown_chunk(chunk_type, chunk_key);
-            continue;
+    const auto start = m_stream.tellg();
+    if (start == std::istream::pos_type(-1))
+        throw ArchiveReadError();
+    auto rewind = [this, start] {
+        m_stream.clear();
+        m_stream.seekg(start);
+        return 0;
+    };
+
+    // TYPE:4, KEY:4
+    auto c = m_stream.get();
+    if (c == std::istream::traits_type::eof())
+        return rewind();
+    const uint8_t type = uint8_t(c) & TypeMask;
+    size_t head_size = 1;
+
+    // LEN:var
+    size_t length = 0;
+    if (type_has_len(type)) {
+        for (unsigned shift = 0; ; shift += 7) {
+            c = m_stream.get();
+            if (c == std::istream::traits_type::eof())
+                return rewind();
+            ++head_size;
+            if (shift >= 64)
+                throw ArchiveBadChunkType();
+            length |= size_t(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+                break;
         }
-        break;  // footer found
+    } else {
+        length = size_by_type(type);
     }
-    // read metadata chunks
-    while (group_buffer().size != 0) {
-        uint8_t b;
-        read_with_crc(b);
-        const uint8_t chunk_key = b & KeyMask;
-        const uint8_t chunk_type = b & TypeMask;
-        if (m_has_crc && chunk_key == 1 && chunk_type == UInt32) {
-            // stop feeding CRC
-            m_has_crc = false;
-            // check CRC
-            uint32_t stored_crc = 0;
-            read_with_crc(stored_crc);
-            if (stored_crc != m_crc.as_uint32())
-                throw ArchiveBadChecksum();
-            continue;
-        }
-        // unknown chunk
-        skip_unknown_chunk(chunk_type, chunk_key);
+
+    // VALUE: check that the last byte of the record is available
+    if (length != 0) {
+        m_stream.seekg(std::istream::off_type(length - 1), std::ios::cur);
+        if (m_stream.peek() == std::istream::traits_type::eof())
+            return rewind();
     }
+
+    (void) rewind();
+    return head_size + length;
 }
 
 
@@ -117,14 +91,8 @@ std::byte BinaryReader::peek_byte()
 }
 
 
-void BinaryReader::skip_unknown_chunk(uint8_t type, uint8_t key)
+void BinaryReader::skip_with_crc(uint8_t type, uint8_t key, size_t length)
 {
-    size_t length;
-    if (type_has_len(type)) {
-        length = read_leb128<size_t>();
-    } else {
-        length = size_by_type(type);
-    }
     auto buf = std::make_unique<std::byte[]>(length);
     read_with_crc(buf.get(), length);
     if (m_unknown_chunk_cb) {
@@ -133,31 +101,4 @@ void BinaryReader::skip_unknown_chunk(uint8_t type, uint8_t key)
 }
 
 
-void BinaryReader::enter_group(uint8_t key, const char* name)
-{
-    auto chunk_type = read_chunk_head(key);
-    size_t chunk_length = 0;  // ChunkNotFound -> size 0
-    if (chunk_type == Type::Master) {
-        chunk_length = read_leb128<size_t>();
-    } else if (chunk_type != ChunkNotFound)
-        throw ArchiveBadChunkType();
-    if (chunk_length > group_buffer().size)
-        throw ArchiveUnexpectedEnd();
-    // "move" the content from parent buffer to new child
-    group_buffer().size -= chunk_length;
-    m_group_stack.emplace_back();
-    group_buffer().size = chunk_length;
-}
-
-
-void BinaryReader::leave_group(uint8_t key, const char* name)
-{
-    // drain the rest of chunks in the group
-    auto chunk_type = read_chunk_head(ChunkNotFound);
-    (void) chunk_type;
-    assert(chunk_type == ChunkNotFound && group_buffer().size == 0);
-    m_group_stack.pop_back();
-}
-
-
 } // namespace xci::data
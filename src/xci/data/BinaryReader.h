@@ -7,192 +7,73 @@
 #ifndef XCI_DATA_BINARY_READER_H
 #define XCI_DATA_BINARY_READER_H
 
-#include "BinaryBase.h"
-#include <xci/data/coding/leb128.h>
-#include <xci/compat/endian.h>
-#include <xci/compat/macros.h>
+#include "BinaryReaderBase.h"
 
 #include <istream>
-#include <iterator>
-#include <map>
-#include <functional>
-#include <memory>
 
 namespace xci::data {
 
 
-class BinaryReader : public ArchiveBase<BinaryReader>, BinaryBase {
+/// Reads serializable objects from a binary stream.
+/// See BinaryWriter for the serialization interface.
+///
+/// To read from a buffer in memory, use BinaryBufferReader.
+///
+/// Streams written by `BinaryWriter::write_record` are read record by record.
+/// The file can be tailed while the writer is still appending to it:
+///
+///     BinaryReader reader(is);
+///     Event event;
+///     for (;;) {
+///         if (reader.read_record(event))
+///             process(event);
+///         else
+///             wait_for_more_data();
+///     }
+
+class BinaryReader : public BinaryReaderBase<BinaryReader> {
     friend ArchiveBase<BinaryReader>;
-    struct Buffer {
-        size_t size = 0;
-    };
-    using BufferType = Buffer;
+    friend BinaryReaderBase<BinaryReader>;
 
 public:
     explicit BinaryReader(std::istream& is) : m_stream(is) { read_header(); }
 
-    void finish_and_check() { read_footer(); }
+    /// The archive was written in streaming mode (header has unknown size)
+    bool is_stream() const { return m_flags & UnknownSize; }
 
-    // raw and smart pointers
+    /// Read next record from a stream written by `BinaryWriter::write_record`.
+    /// The input stream must be seekable (e.g. a file).
+    /// \returns   false if there is no complete record in the stream yet,
+    ///            the input is rewound to start of the record and
+    ///            the call can be repeated when more data is available
     template <typename T>
-    requires std::is_pointer_v<T> || std::is_same_v<T, std::unique_ptr> || std::is_same_v<T, std::shared_ptr>
-    void add(ArchiveField<T>&& a) {
-        const auto chunk_type = peek_chunk_head(a.key);
-        if (chunk_type == ChunkNotFound)
-            return;
-        if (chunk_type == Type::Null) {
-            (void) read_chunk_head(a.key);
-            a.value = nullptr;
-            return;
-        }
-        using ElemT = typename std::pointer_traits<T>::element_type;
-        a.value = new ElemT{};
-        apply(ArchiveField<ElemT>{a.key, *a.value, a.name});
-    }
-
-    // bool
-    void add(ArchiveField<bool>&& a) {
-        const auto chunk_type = read_chunk_head(a.key);
-        if (chunk_type == ChunkNotFound)
-            return;
-        if (chunk_type == Type::BoolFalse) {
-            a.value = false;
-            return;
-        }
-        if (chunk_type == Type::BoolTrue) {
-            a.value = true;
-            return;
-        }
-        throw ArchiveBadChunkType();
-    }
-
-    // integers, floats, enums
-    template <typename T>
-    requires requires() { to_chunk_type<T>(); }
-    void add(ArchiveField<T>&& a) {
-        const auto chunk_type = read_chunk_head(a.key);
-        if (chunk_type == to_chunk_type<T>())
-            read_with_crc(a.value);
-        else if (chunk_type != ChunkNotFound)
-            throw ArchiveBadChunkType();
-    }
-
-    // string
-    void add(ArchiveField<std::string>&& a) {
-        const auto chunk_type = read_chunk_head(a.key);
-        if (chunk_type == Type::String) {
-            auto length = read_leb128<size_t>();
-            a.value.resize(length);
-            read_with_crc((std::byte*)&a.value[0], length);
-        } else if (chunk_type != ChunkNotFound)
-            throw ArchiveBadChunkType();
-    }
-
-    // iterables
-    template <typename T>
-    requires requires (T& v) { v.emplace_back(); }
-    void add(ArchiveField<T>&& a) {
-        for (;;) {
-            const auto chunk_type = peek_chunk_head(a.key);
-            if (chunk_type == ChunkNotFound)
-                return;
-            a.value.emplace_back();
-            apply(ArchiveField<typename T::value_type>{reuse_same_key(a.key), a.value.back(), a.name});
-        }
+    bool read_record(T& record) {
+        assert(is_stream() && is_root_group());
+        const size_t size = peek_record_size();
+        if (size == 0)
+            return false;
+        group_buffer().size = size;
+        m_group_stack.back().next_key = 0;
+        apply(record);
+        // skip the record if it didn't match
+        (void) read_chunk_head(ChunkNotFound);
+        return true;
     }
 
 private:
-    void enter_group(uint8_t key, const char* name);
-    void leave_group(uint8_t key, const char* name);
+    size_t peek_record_size();
 
-    void read_header();
-    void read_footer();
-
-    void skip_unknown_chunk(uint8_t type, uint8_t key);
-
-    constexpr bool type_has_len(uint8_t type) {
-        return type == Varint || type == Array || type == String || type == Master;
-    }
-
-    constexpr size_t size_by_type(uint8_t type) {
-        switch (type) {
-            case Null:
-            case BoolFalse:
-            case BoolTrue:
-            case Control:
-                return 0;
-            case Byte:
-                return 1;
-            case UInt32:
-            case Int32:
-            case Float32:
-                return 4;
-            case UInt64:
-            case Int64:
-            case Float64:
-                return 8;
-            default:
-                UNREACHABLE;
-        }
-    }
-
-    uint8_t peek_chunk_head(uint8_t key) {
-        // Read ahead until key matches
-        while (group_buffer().size != 0) {
-            auto b = (uint8_t) peek_byte();
-            const uint8_t chunk_key = b & KeyMask;
-            const uint8_t chunk_type = b & TypeMask;
-            if (chunk_key < key) {
-                (void) read_byte_with_crc();
-                skip_unknown_chunk(chunk_type, chunk_key);
-                continue;
-            }
-            if (chunk_key > key)
-                return ChunkNotFound;
-            // success, pointer is still at KEY/TYPE
-            return chunk_type;
-        }
-        return ChunkNotFound;
-    }
-
-    uint8_t read_chunk_head(uint8_t key) {
-        auto chunk_type = peek_chunk_head(key);
-        if (chunk_type == ChunkNotFound)
-            return ChunkNotFound;
-        read_byte_with_crc();
-        return chunk_type;
-    }
-
-    template <typename T>
-    void read_with_crc(T& value) {
-        read_with_crc((std::byte*)&value, sizeof(value));
-    }
     void read_with_crc(std::byte* buffer, size_t length);
     std::byte read_byte_with_crc();
     std::byte peek_byte();
+    void skip_with_crc(uint8_t type, uint8_t key, size_t length);
 
-    template<typename T>
-    T read_leb128() {
-        class ReadWithCrcIter {
-        public:
-            explicit ReadWithCrcIter(BinaryReader& reader) : m_reader(reader) {}
-            void operator++() { m_reader.read_byte_with_crc();}
-            std::byte operator*() { return m_reader.peek_byte(); }
-        private:
-            BinaryReader& m_reader;
-        };
-        auto iter = ReadWithCrcIter(*this);
-        return decode_leb128<size_t>(iter);
-    }
+    void start_crc(const uint8_t (&header)[4]) { m_crc = Crc32(crc_variant()); m_crc(header); }
+    uint32_t finish_crc() const { return m_crc.as_uint32(); }
 
 private:
     std::istream& m_stream;
-
-    bool m_has_crc = false;
     Crc32 m_crc;
-
-    using UnknownChunkCb = std::function<void(uint8_t type, uint8_t key, const std::byte* data, size_t size)>;
-    UnknownChunkCb m_unknown_chunk_cb;
 };
 
 
@@ -0,0 +1,391 @@
+// BinaryReaderBase.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2019, 2020, 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_DATA_BINARY_READER_BASE_H
+#define XCI_DATA_BINARY_READER_BASE_H
+
+#include "BinaryBase.h"
+#include <xci/data/coding/leb128.h>
+#include <xci/compat/endian.h>
+#include <xci/compat/macros.h>
+
+#include <iterator>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace xci::data {
+
+
+/// Common implementation of binary readers (see BinaryReader, BinaryBufferReader).
+///
+/// Decodes the chunks and groups. The actual input is handled by TImpl,
+/// which has to implement these methods:
+///
+///     void read_with_crc(std::byte* buffer, size_t length);
+///     std::byte read_byte_with_crc();
+///     std::byte peek_byte();
+///     void skip_with_crc(uint8_t type, uint8_t key, size_t length);  // calls m_unknown_chunk_cb
+///     void start_crc(const uint8_t (&header)[4]);  // start computing CRC
+///     uint32_t finish_crc();  // CRC of everything read so far
+///
+/// All reads must be limited by `group_buffer().size`, which has to be
+/// decreased by the size of the data read.
+
+template <class TImpl>
+class BinaryReaderBase : public ArchiveBase<TImpl>, protected BinaryBase {
+    friend ArchiveBase<TImpl>;
+
+protected:
+    struct Buffer {
+        size_t size = 0;
+    };
+    using BufferType = Buffer;
+    using ArchiveBase<TImpl>::group_buffer;
+    using ArchiveBase<TImpl>::reuse_same_key;
+    using ArchiveBase<TImpl>::apply;
+    using ArchiveBase<TImpl>::m_group_stack;
+
+public:
+    void finish_and_check() { read_footer(); }
+
+    // raw and smart pointers
+    template <typename T>
+    requires std::is_pointer_v<T> || std::is_same_v<T, std::unique_ptr> || std::is_same_v<T, std::shared_ptr>
+    void add(ArchiveField<T>&& a) {
+        const auto chunk_type = peek_chunk_head(a.key);
+        if (chunk_type == ChunkNotFound)
+            return;
+        if (chunk_type == Type::Null) {
+            (void) read_chunk_head(a.key);
+            a.value = nullptr;
+            return;
+        }
+        using ElemT = typename std::pointer_traits<T>::element_type;
+        a.value = new ElemT{};
+        apply(ArchiveField<ElemT>{a.key, *a.value, a.name});
+    }
+
+    // bool
+    void add(ArchiveField<bool>&& a) {
+        const auto chunk_type = read_chunk_head(a.key);
+        if (chunk_type == ChunkNotFound)
+            return;
+        if (chunk_type == Type::BoolFalse) {
+            a.value = false;
+            return;
+        }
+        if (chunk_type == Type::BoolTrue) {
+            a.value = true;
+            return;
+        }
+        throw ArchiveBadChunkType();
+    }
+
+    // integers, floats, enums
+    template <typename T>
+    requires requires() { BinaryBase::to_chunk_type<T>(); }
+    void add(ArchiveField<T>&& a) {
+        const auto chunk_type = read_chunk_head(a.key);
+        if (chunk_type == to_chunk_type<T>())
+            read_with_crc(a.value);
+        else if (chunk_type != ChunkNotFound)
+            throw ArchiveBadChunkType();
+    }
+
+    // string
+    void add(ArchiveField<std::string>&& a) {
+        const auto chunk_type = read_chunk_head(a.key);
+        if (chunk_type == Type::String) {
+            auto length = read_leb128<size_t>();
+            a.value.resize(length);
+            impl().read_with_crc((std::byte*)&a.value[0], length);
+        } else if (chunk_type != ChunkNotFound)
+            throw ArchiveBadChunkType();
+    }
+
+    // contiguous containers of numbers - Array chunk
+    // (also accepts items in separate chunks)
+    template <BinaryBulkArray T>
+    void add(ArchiveField<T>&& a) {
+        using ElemT = std::ranges::range_value_t<T>;
+        for (;;) {
+            const auto chunk_type = peek_chunk_head(a.key);
+            if (chunk_type == ChunkNotFound)
+                return;
+            if (chunk_type != Type::Array) {
+                a.value.emplace_back();
+                apply(ArchiveField<ElemT>{reuse_same_key(a.key), a.value.back(), a.name});
+                continue;
+            }
+            (void) read_chunk_head(a.key);
+            const auto length = read_leb128<size_t>();
+            if (length == 0)
+                throw ArchiveBadChunkType();
+            uint8_t subtype;
+            read_with_crc(subtype);
+            if (subtype != to_chunk_type<ElemT>() || (length - 1) % sizeof(ElemT) != 0)
+                throw ArchiveBadChunkType();
+            if (length - 1 > group_buffer().size)
+                throw ArchiveUnexpectedEnd();
+            const size_t count = (length - 1) / sizeof(ElemT);
+            const size_t orig_size = a.value.size();
+            a.value.resize(orig_size + count);
+            ElemT* items = std::ranges::data(a.value) + orig_size;
+            impl().read_with_crc((std::byte*) items, count * sizeof(ElemT));
+            if (m_byte_swap && sizeof(ElemT) > 1) {
+                for (size_t i = 0; i != count; ++i)
+                    items[i] = byteswap(items[i]);
+            }
+        }
+    }
+
+    // iterables
+    template <typename T>
+    requires requires (T& v) { v.emplace_back(); } && (!BinaryBulkArray<T>)
+    void add(ArchiveField<T>&& a) {
+        for (;;) {
+            const auto chunk_type = peek_chunk_head(a.key);
+            if (chunk_type == ChunkNotFound)
+                return;
+            a.value.emplace_back();
+            apply(ArchiveField<typename T::value_type>{reuse_same_key(a.key), a.value.back(), a.name});
+        }
+    }
+
+protected:
+    TImpl& impl() { return *static_cast<TImpl*>(this); }
+
+    /// Header flags say the archive has CRC-32 or CRC-32C checksum
+    bool has_crc_flag() const {
+        const auto checksum = m_flags & ChecksumMask;
+        return checksum == ChecksumCrc32 || checksum == ChecksumCrc32C;
+    }
+
+    Crc32::Variant crc_variant() const {
+        return (m_flags & ChecksumMask) == ChecksumCrc32C ? Crc32::Variant::Castagnoli : Crc32::Variant::Ieee;
+    }
+
+    void enter_group(uint8_t key, const char* name);
+    void leave_group(uint8_t key, const char* name);
+
+    void read_header();
+    void read_footer();
+
+    void skip_unknown_chunk(uint8_t type, uint8_t key);
+
+    constexpr bool type_has_len(uint8_t type) {
+        return type == Varint || type == Array || type == String || type == Binary || type == Master;
+    }
+
+    constexpr size_t size_by_type(uint8_t type) {
+        switch (type) {
+            case Null:
+            case BoolFalse:
+            case BoolTrue:
+            case Control:
+                return 0;
+            case Byte:
+                return 1;
+            case UInt32:
+            case Int32:
+            case Float32:
+                return 4;
+            case UInt64:
+            case Int64:
+            case Float64:
+                return 8;
+            default:
+                UNREACHABLE;
+        }
+    }
+
+    uint8_t peek_chunk_head(uint8_t key) {
+        // Read ahead until key matches
+        while (group_buffer().size != 0) {
+            auto b = (uint8_t) impl().peek_byte();
+            if (b == (Type::Control | uint8_t(Metadata)))
+                return ChunkNotFound;  // end of data, metadata follow
+            const uint8_t chunk_key = b & KeyMask;
+            const uint8_t chunk_type = b & TypeMask;
+            if (chunk_key < key) {
+                (void) impl().read_byte_with_crc();
+                skip_unknown_chunk(chunk_type, chunk_key);
+                continue;
+            }
+            if (chunk_key > key)
+                return ChunkNotFound;
+            // success, pointer is still at KEY/TYPE
+            return chunk_type;
+        }
+        return ChunkNotFound;
+    }
+
+    uint8_t read_chunk_head(uint8_t key) {
+        auto chunk_type = peek_chunk_head(key);
+        if (chunk_type == ChunkNotFound)
+            return ChunkNotFound;
+        impl().read_byte_with_crc();
+        return chunk_type;
+    }
+
+    template <typename T>
+    void read_with_crc(T& value) {
+        impl().read_with_crc((std::byte*)&value, sizeof(value));
+        if constexpr ((std::is_arithmetic_v<T> || std::is_enum_v<T>) && sizeof(T) > 1) {
+            if (m_byte_swap)
+                value = byteswap(value);
+        }
+    }
+
+    template<typename T>
+    T read_leb128() {
+        class ReadWithCrcIter {
+        public:
+            explicit ReadWithCrcIter(TImpl& reader) : m_reader(reader) {}
+            void operator++() { m_reader.read_byte_with_crc();}
+            std::byte operator*() { return m_reader.peek_byte(); }
+        private:
+            TImpl& m_reader;
+        };
+        auto iter = ReadWithCrcIter(impl());
+        return decode_leb128<size_t>(iter);
+    }
+
+protected:
+    uint8_t m_flags = 0;  // FLAGS from header
+    bool m_byte_swap = false;  // archive endianness differs from host
+    bool m_has_crc = false;
+
+    using UnknownChunkCb = std::function<void(uint8_t type, uint8_t key, const std::byte* data, size_t size)>;
+    UnknownChunkCb m_unknown_chunk_cb;
+};
+
+
+template <class TImpl>
+void BinaryReaderBase<TImpl>::read_header()
+{
+    // This size is decreased with every read.
+    // Initial value is used only for reading the header,
+    // then overwritten by actual value from the header.
+    group_buffer().size = 10;
+
+    uint8_t header[4];
+    read_with_crc(header);
+
+    // MAGIC:16
+    if (header[0] != Magic0 || header[1] != Magic1)
+        throw ArchiveBadMagic();
+
+    // VERSION:8
+    if (header[2] != Version)
+        throw ArchiveBadVersion();
+
+    // FLAGS:8
+    auto endianness = (header[3] & EndiannessMask);
+    if (endianness != LittleEndian && endianness != BigEndian)
+        throw ArchiveBadFlags();
+    m_byte_swap = (endianness == LittleEndian) != (BYTE_ORDER == LITTLE_ENDIAN);
+    m_flags = header[3];
+    m_has_crc = has_crc_flag();
+
+    // add header to CRC checksum
+    if (m_has_crc)
+        impl().start_crc(header);
+
+    // SIZE:var
+    group_buffer().size = read_leb128<size_t>();
+}
+
+
+template <class TImpl>
+void BinaryReaderBase<TImpl>::read_footer()
+{
+    // read chunks until Control/Metadata
+    for (;;) {
+        if (group_buffer().size == 0) {
+            if (m_has_crc)
+                throw ArchiveMissingChecksum();
+            return;  // no footer
+        }
+        uint8_t b;
+        read_with_crc(b);
+        const uint8_t chunk_key = b & KeyMask;
+        const uint8_t chunk_type = b & TypeMask;
+        if (chunk_type != Type::Control || chunk_key != Metadata) {
+            skip_unknown_chunk(chunk_type, chunk_key);
+            continue;
+        }
+        break;  // footer found
+    }
+    // read metadata chunks
+    while (group_buffer().size != 0) {
+        uint8_t b;
+        read_with_crc(b);
+        const uint8_t chunk_key = b & KeyMask;
+        const uint8_t chunk_type = b & TypeMask;
+        if (m_has_crc && chunk_key == MetaChecksum && chunk_type == UInt32) {
+            // stop feeding CRC
+            m_has_crc = false;
+            const uint32_t computed_crc = impl().finish_crc();
+            // check CRC
+            uint32_t stored_crc = 0;
+            read_with_crc(stored_crc);
+            if (stored_crc != computed_crc)
+                throw ArchiveBadChecksum();
+            continue;
+        }
+        // unknown chunk
+        skip_unknown_chunk(chunk_type, chunk_key);
+    }
+}
+
+
+template <class TImpl>
+void BinaryReaderBase<TImpl>::skip_unknown_chunk(uint8_t type, uint8_t key)
+{
+    size_t length;
+    if (type_has_len(type)) {
+        length = read_leb128<size_t>();
+    } else {
+        length = size_by_type(type);
+    }
+    impl().skip_with_crc(type, key, length);
+}
+
+
+template <class TImpl>
+void BinaryReaderBase<TImpl>::enter_group(uint8_t key, const char* name)
+{
+    auto chunk_type = read_chunk_head(key);
+    size_t chunk_length = 0;  // ChunkNotFound -> size 0
+    if (chunk_type == Type::Master) {
+        chunk_length = read_leb128<size_t>();
+    } else if (chunk_type != ChunkNotFound)
+        throw ArchiveBadChunkType();
+    if (chunk_length > group_buffer().size)
+        throw ArchiveUnexpectedEnd();
+    // "move" the content from parent buffer to new child
+    group_buffer().size -= chunk_length;
+    m_group_stack.emplace_back();
+    group_buffer().size = chunk_length;
+}
+
+
+template <class TImpl>
+void BinaryReaderBase<TImpl>::leave_group(uint8_t key, const char* name)
+{
+    // drain the rest of chunks in the group
+    auto chunk_type = read_chunk_head(ChunkNotFound);
+    (void) chunk_type;
+    assert(chunk_type == ChunkNotFound && group_buffer().size == 0);
+    m_group_stack.pop_back();
+}
+
+
+} // namespace xci::data
+
+#endif // include guard
@@ -9,7 +9,7 @@
 namespace xci::data {
 
 
-void BinaryWriter::write_content()
+size_t BinaryWriter::encode_header(uint8_t* header, size_t content_size) const
 {
     uint8_t flags = 0;
 
@@ -21,63 +21,205 @@ void BinaryWriter::write_content()
 #endif
 
     if (m_crc32)
-        flags |= ChecksumCrc32;
+        flags |= (m_crc.variant() == Crc32::Variant::Castagnoli) ? ChecksumCrc32C : ChecksumCrc32;
+
+    if (m_index_depth != 0)
+        flags |= ChunkIndex;
+
+    if (m_pass == Pass::Streaming)
+        flags |= UnknownSize;
 
     // Prepare header:
     // 4 bytes fixed header: MAGIC:16, VERSION:8, FLAGS:8
     // 6 bytes for SIZE in LEB128 => up to 4TB of file content
-    uint8_t header[10] {
-        Magic0, Magic1,
-        Version,
-        flags
-    };
+    header[0] = Magic0;
+    header[1] = Magic1;
+    header[2] = Version;
+    header[3] = flags;
 
     uint8_t* iter = header + 4;
-    assert(is_root_group());
-    size_t content_size = group_buffer().size() + (m_crc32 ? 6 : 0);
     assert(content_size < 0x400'0000'0000LLU);  // up to 4TB
     encode_leb128(iter, content_size);
 
     const size_t header_size = iter - header;
-    assert(header_size <= 10);
+    assert(header_size <= max_header_size);
+    return header_size;
+}
+
+
+auto BinaryWriter::encode_metadata(size_t body_size) const -> BufferType
+{
+    BufferType meta;
+    if (!m_crc32 && m_index_depth == 0)
+        return meta;
+
+    auto out_iter = std::back_inserter(meta);
+    auto put = [&meta](uint8_t b) { meta.push_back(std::byte(b)); };
+
+    // Metadata intro
+    put(Type::Control | uint8_t(Metadata));
+
+    if (m_index_depth != 0) {
+        BufferType index;
+        auto index_iter = std::back_inserter(index);
+        for (const auto& entry : m_index) {
+            encode_leb128<size_t, decltype(index_iter), std::byte>(index_iter, entry.parent);
+            index.push_back(std::byte(entry.key));
+            encode_leb128<size_t, decltype(index_iter), std::byte>(index_iter, entry.offset);
+        }
+        // Chunk index: position of the index chunk (after metadata intro)
+        const uint64_t index_pos = body_size + meta.size();
+        put(Type::Binary | uint8_t(MetaChunkIndex));
+        encode_leb128<size_t, decltype(out_iter), std::byte>(out_iter, index.size());
+        meta.insert(meta.end(), index.begin(), index.end());
+        // Fixed-size pointer to the index, so it can be found from the end
+        put(Type::UInt64 | uint8_t(MetaChunkIndexPos));
+        const auto* pos_bytes = (const std::byte*) &index_pos;
+        meta.insert(meta.end(), pos_bytes, pos_bytes + sizeof(index_pos));
+    }
+
+    // Checksum intro (included in checksum), the value follows
+    if (m_crc32)
+        put(Type::UInt32 | uint8_t(MetaChecksum));
+
+    return meta;
+}
+
+
+void BinaryWriter::write_content()
+{
+    assert(is_root_group());
+    const auto& body = group_buffer();
+    const auto meta = encode_metadata(body.size());
+
+    uint8_t header[max_header_size];
+    const size_t content_size = body.size() + meta.size() + (m_crc32 ? m_crc.size() : 0);
+    const size_t header_size = encode_header(header, content_size);
 
     // Write header
     m_stream.write((const char*)header, header_size);
 
     // Write content
-    m_stream.write((const char*)group_buffer().data(), group_buffer().size());
+    m_stream.write((const char*)body.data(), body.size());
+
+    // Write metadata (without checksum value)
+    m_stream.write((const char*)meta.data(), meta.size());
 
     if (!m_crc32)
         return;  // no checksum -> we're done
 
-    // CRC-32: header + content
-    Crc32 crc;
+    // CRC-32: header + content + metadata
+    Crc32 crc(m_crc.variant());
     crc.feed((const std::byte*)header, header_size);
-    crc(group_buffer());
-
-    // Write metadata intro (included in checksum)
-    const uint8_t meta_intro = (Type::Control | 0);
-    m_stream.put(meta_intro);
-    crc(meta_intro);
+    crc(body);
+    crc(meta);
 
     // Write checksum
-    const uint8_t crc_intro = (Type::UInt32 | 1);
-    m_stream.put(crc_intro);
-    crc(crc_intro);
     m_stream.write((const char*)crc.data(), crc.size());
 }
 
 
+void BinaryWriter::write_header(size_t content_size)
+{
+    uint8_t header[max_header_size];
+    const size_t header_size = encode_header(header, content_size);
+    write_chunk((const std::byte*)header, header_size);
+}
+
+
+void BinaryWriter::write_footer(const BufferType& meta)
+{
+    write(meta.data(), meta.size());
+    if (!m_crc32)
+        return;
+
+    // Checksum of everything before
+    flush_chunk();
+    m_stream.write((const char*)m_crc.data(), m_crc.size());
+}
+
+
+void BinaryWriter::write_chunk(const std::byte* data, size_t size)
+{
+    if (m_chunk.size() + size <= chunk_size) {
+        if (m_chunk.capacity() < chunk_size)
+            m_chunk.reserve(chunk_size);
+        m_chunk.insert(m_chunk.end(), data, data + size);
+        return;
+    }
+    // doesn't fit - flush the buffer and write big data directly
+    flush_chunk();
+    if (size >= chunk_size) {
+        if (m_crc32)
+            m_crc.feed(data, size);
+        m_stream.write((const char*)data, size);
+        return;
+    }
+    m_chunk.insert(m_chunk.end(), data, data + size);
+}
+
+
+void BinaryWriter::flush_chunk()
+{
+    if (m_chunk.empty())
+        return;
+    if (m_crc32)
+        m_crc(m_chunk);
+    m_stream.write((const char*)m_chunk.data(), m_chunk.size());
+    m_chunk.clear();
+}
+
+
 void BinaryWriter::enter_group(uint8_t key, const char* name)
 {
+    if (m_pass != Pass::Writing && m_group_stack.size() <= m_index_depth) {
+        // offset in buffered mode is not known yet, will be set in leave_group
+        const size_t offset = (m_pass == Pass::Sizing) ? m_group_sizes[m_size_stack.back()] : 0;
+        m_index.push_back({m_index_stack.back(), offset, key});
+        m_index_stack.push_back(m_index.size());
+    }
+    switch (m_pass) {
+        case Pass::Sizing:
+            // the size will be accumulated in leave_group
+            m_size_stack.push_back(m_group_sizes.size());
+            m_group_sizes.push_back(0);
+            break;
+        case Pass::Writing:
+            // the size is known from the Sizing pass
+            // TYPE:4, KEY:4
+            write(uint8_t(Type::Master | key));
+            // LEN:32
+            write_leb128(m_group_sizes[m_next_group++]);
+            break;
+        default:
+            break;
+    }
     m_group_stack.emplace_back();
 }
 
 
 void BinaryWriter::leave_group(uint8_t key, const char* name)
 {
+    if (m_pass == Pass::Sizing) {
+        const size_t inner_size = m_group_sizes[m_size_stack.back()];
+        m_size_stack.pop_back();
+        // TYPE:4, KEY:4 + LEN:32 + VALUE
+        m_group_sizes[m_size_stack.back()] += 1 + leb128_length(inner_size) + inner_size;
+    }
+    const bool indexed = m_pass != Pass::Writing && m_group_stack.size() - 1 <= m_index_depth;
+    if (m_pass != Pass::Buffered) {
+        if (indexed)
+            m_index_stack.pop_back();
+        m_group_stack.pop_back();
+        return;
+    }
     auto inner_buffer = std::move(group_buffer());
     m_group_stack.pop_back();
+    if (indexed) {
+        // the group will be written at the end of parent's buffer
+        m_index[m_index_stack.back() - 1].offset = group_buffer().size();
+        m_index_stack.pop_back();
+    }
     // TYPE:4, KEY:4
     write(uint8_t(Type::Master | key));
     // LEN:32
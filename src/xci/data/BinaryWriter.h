@@ -13,6 +13,8 @@
 #include <xci/data/coding/leb128.h>
 #include <memory>
 #include <ostream>
+#include <span>
+#include <string_view>
 
 namespace xci::data {
 
@@ -47,14 +49,100 @@ namespace xci::data {
 ///
 ///     XCI_ARCHIVE(ar, a, b, c)
 ///
+/// Alternatively, the fields can be declared as compile-time schema,
+/// instead of `serialize` method. It's used by all archives and it's faster,
+/// as the keys are not allocated at run-time:
+///
+///     struct MyStruct {
+///         int a, b, c;
+///         XCI_ARCHIVE_SCHEMA(MyStruct, a, b, c)
+///     };
+///
+/// By default, the content is buffered: each group is serialized to its own
+/// buffer, which is then appended to the parent. Everything is written
+/// to the stream at once, in destructor.
+///
+/// Large or deeply nested archives should be written in single pass instead:
+///
+///     BinaryWriter writer(os);
+///     writer.write_single_pass(a, b, c);
+///
+/// The objects are serialized twice - first pass only computes sizes
+/// of the groups, second pass writes each byte once, directly to the stream,
+/// through a bounded chunk buffer. The output is identical to buffered mode.
+/// The serialized objects must not change between the passes.
+///
+/// Append-only logs can be written in streaming mode. The header is written
+/// with unknown size and each record is flushed as soon as it's complete:
+///
+///     BinaryWriter writer(os);
+///     for (;;)
+///         writer.write_record(next_event());
+///
 
 class BinaryWriter : public ArchiveBase<BinaryWriter>, BinaryBase {
     friend ArchiveBase<BinaryWriter>;
     using BufferType = std::vector<std::byte>;
 
 public:
+    /// \param crc32   enable CRC-32 checksum
     explicit BinaryWriter(std::ostream& os, bool crc32 = false) : m_stream(os), m_crc32(crc32) {}
-    ~BinaryWriter() { write_content(); }
+    /// \param crc     enable checksum of chosen variant (CRC-32 or CRC-32C)
+    explicit BinaryWriter(std::ostream& os, Crc32::Variant crc) : m_stream(os), m_crc32(true), m_crc(crc) {}
+    ~BinaryWriter() { if (m_pass == Pass::Buffered) write_content(); }
+
+    /// Write complete archive in single pass, without intermediate group buffers.
+    /// All top-level objects must be passed to this single call.
+    /// The writer must not be used any more after the call.
+    /// \param args        the objects to be serialized, as with operator()
+    template<typename ...Args>
+    void write_single_pass(Args&... args) {
+        assert(m_pass == Pass::Buffered && is_root_group() && group_buffer().empty());
+        sizing_pass(args...);
+        const auto meta = encode_metadata(m_group_sizes[0]);
+        write_header(m_group_sizes[0] + meta.size() + (m_crc32 ? m_crc.size() : 0));
+        writing_pass(args...);
+        write_footer(meta);
+        flush_chunk();
+        m_pass = Pass::Finished;
+    }
+
+    /// Append a record to the stream (streaming mode).
+    /// The first call writes the header with unknown SIZE, each record
+    /// is then written in single pass and flushed to the stream
+    /// as soon as it's complete. Memory use doesn't grow with number of records.
+    /// Checksum and chunk index are not supported in streaming mode.
+    /// The records can be read with `BinaryReader::read_record`.
+    /// \param record      the object to be serialized, as with operator()
+    template<typename T>
+    void write_record(T& record) {
+        if (m_pass == Pass::Buffered) {
+            assert(is_root_group() && group_buffer().empty());
+            assert(!m_crc32 && m_index_depth == 0);
+            m_pass = Pass::Streaming;
+            write_header(0);
+        }
+        assert(m_pass == Pass::Streaming);
+        sizing_pass(record);
+        writing_pass(record);
+        flush_chunk();
+        m_stream.flush();
+        m_pass = Pass::Streaming;
+    }
+
+    /// Write chunk index to the archive, allowing random access
+    /// to Master chunks (serialized objects) up to `depth` levels of nesting.
+    /// E.g. depth=1 indexes only top-level objects, depth=2 also their members.
+    /// Must be called before serializing anything.
+    /// See `BinaryBufferReader::read_at`.
+    void enable_chunk_index(unsigned depth = 2) {
+        assert(m_index.empty() && m_index_stack.size() == 1);
+        m_index_depth = depth;
+    }
+
+    /// Size of the chunk buffer used by `write_single_pass`.
+    /// Larger writes bypass the buffer.
+    static constexpr size_t chunk_size = 64 * 1024;
 
     // raw and smart pointers
     template <typename T>
@@ -89,9 +177,37 @@ public:
         write((const std::byte*) a.value.data(), a.value.size());
     }
 
+    void add(ArchiveField<std::string_view>&& a) {
+        write(uint8_t(Type::String | a.key));
+        write_leb128(a.value.size());
+        write((const std::byte*) a.value.data(), a.value.size());
+    }
+
+    // binary data
+    void add(ArchiveField<std::span<const std::byte>>&& a) {
+        write(uint8_t(Type::Binary | a.key));
+        write_leb128(a.value.size());
+        write(a.value.data(), a.value.size());
+    }
+
+    // contiguous containers of numbers - Array chunk
+    template <BinaryBulkArray T>
+    void add(ArchiveField<T>&& a) {
+        using ElemT = std::ranges::range_value_t<T>;
+        const size_t size = std::ranges::size(a.value) * sizeof(ElemT);
+        if (size == 0)
+            return;
+        write(uint8_t(Type::Array | a.key));
+        // LEN: SUBTYPE + items
+        write_leb128(1 + size);
+        // SUBTYPE:4, RESERVED:4
+        write(uint8_t(to_chunk_type<ElemT>()));
+        write((const std::byte*) std::ranges::data(a.value), size);
+    }
+
     // iterables
     template <typename T>
-    requires requires { typename T::iterator; }
+    requires requires { typename T::iterator; } && (!BinaryBulkArray<T>)
     void add(ArchiveField<T>&& a) {
         for (auto& item : a.value) {
             apply(ArchiveField<typename T::value_type>{reuse_same_key(a.key), item, a.name});
@@ -102,8 +218,35 @@ private:
     void enter_group(uint8_t key, const char* name);
     void leave_group(uint8_t key, const char* name);
 
+    static constexpr size_t max_header_size = 10;
+    size_t encode_header(uint8_t* header, size_t content_size) const;
+    BufferType encode_metadata(size_t body_size) const;
     void write_content();
 
+    // single pass mode
+    template<typename ...Args>
+    void sizing_pass(Args&&... args) {
+        // compute sizes of all groups
+        m_pass = Pass::Sizing;
+        m_group_stack.back().next_key = 0;
+        m_group_sizes.assign(1, 0);  // root group
+        m_size_stack.assign(1, 0);
+        (*this)(std::forward<Args>(args)...);
+    }
+    template<typename ...Args>
+    void writing_pass(Args&&... args) {
+        // write the content, with group sizes from sizing pass
+        m_pass = Pass::Writing;
+        m_group_stack.back().next_key = 0;
+        m_next_group = 1;
+        (*this)(std::forward<Args>(args)...);
+        assert(m_next_group == m_group_sizes.size());
+    }
+    void write_header(size_t content_size);
+    void write_footer(const BufferType& meta);
+    void write_chunk(const std::byte* data, size_t size);
+    void flush_chunk();
+
     template <typename T>
     void write(const T& value) {
         add_to_buffer((const std::byte*) &value, sizeof(value));
@@ -113,18 +256,71 @@ private:
     }
 
     void add_to_buffer(const std::byte* data, size_t size) {
-        group_buffer().insert(group_buffer().end(), data, data + size);
+        switch (m_pass) {
+            case Pass::Buffered:
+                group_buffer().insert(group_buffer().end(), data, data + size);
+                break;
+            case Pass::Sizing:
+                m_group_sizes[m_size_stack.back()] += size;
+                break;
+            case Pass::Writing:
+                write_chunk(data, size);
+                break;
+            case Pass::Streaming:
+                assert(!"BinaryWriter: use write_record in streaming mode");
+                break;
+            case Pass::Finished:
+                assert(!"BinaryWriter: write after write_single_pass");
+                break;
+        }
     }
 
     template<typename T>
     void write_leb128(T value) {
-        auto out_iter = std::back_inserter(group_buffer());
-        encode_leb128<T, decltype(out_iter), std::byte>(out_iter, value);
+        if (m_pass == Pass::Buffered) {
+            auto out_iter = std::back_inserter(group_buffer());
+            encode_leb128<T, decltype(out_iter), std::byte>(out_iter, value);
+            return;
+        }
+        if (m_pass == Pass::Sizing) {
+            m_group_sizes[m_size_stack.back()] += leb128_length(value);
+            return;
+        }
+        std::byte buf[leb128_max_length<T>()];
+        std::byte* iter = buf;
+        encode_leb128(iter, value);
+        add_to_buffer(buf, iter - buf);
     }
 
 private:
     std::ostream& m_stream;
-    bool m_crc32;  // enable CRC32
+    bool m_crc32;  // enable CRC32 (variant is set in m_crc)
+
+    enum class Pass: uint8_t {
+        Buffered,   // default mode, write_content() in destructor
+        Sizing,     // write_single_pass: computing sizes of groups
+        Writing,    // write_single_pass: writing to m_chunk
+        Finished,   // write_single_pass: done
+        Streaming,  // write_record: between records
+    };
+    Pass m_pass = Pass::Buffered;
+
+    // single pass mode
+    std::vector<size_t> m_group_sizes;  // content size of each group, in order of appearance
+    std::vector<size_t> m_size_stack;   // Sizing: indexes to m_group_sizes of open groups
+    size_t m_next_group = 0;            // Writing: next index to m_group_sizes
+    BufferType m_chunk;                 // Writing: output buffer, up to chunk_size
+    Crc32 m_crc;
+
+    // chunk index
+    struct IndexEntry {
+        size_t parent;  // 1-based index of parent entry, 0 = root
+        size_t offset;  // position of Master chunk head in parent group content
+        uint8_t key;
+    };
+    std::vector<IndexEntry> m_index;  // in order of appearance of the groups
+    std::vector<size_t> m_index_stack {0};  // 1-based indexes of open groups
+    unsigned m_index_depth = 0;  // 0 = no index
 };
 
 
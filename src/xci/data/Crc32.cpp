@@ -5,32 +5,209 @@
 // Licensed under the Apache License, Version 2.0 (see LICENSE file)
 
 #include "Crc32.h"
+#include <xci/compat/endian.h>
 #include <zlib.h>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define XCI_CRC32C_SSE42
+    #include <nmmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #define XCI_CRC32C_ARMV8
+    #include <arm_acle.h>
+#endif
 
 namespace xci::data {
 
 
+// -----------------------------------------------------------------------------
+// CRC-32C (Castagnoli)
+
+// Reversed polynomial 0x1EDC6F41
+static constexpr uint32_t c_crc32c_poly = 0x82F63B78;
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+static constexpr Crc32cTables make_crc32c_tables()
+{
+    Crc32cTables t {};
+    for (uint32_t i = 0; i != 256; ++i) {
+        uint32_t crc = i;
+        for (int k = 0; k != 8; ++k)
+            crc = (crc >> 1) ^ (c_crc32c_poly & (0u - (crc & 1)));
+        t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i != 256; ++i) {
+        for (int k = 1; k != 8; ++k)
+            t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xFF];
+    }
+    return t;
+}
+
+static constexpr Crc32cTables c_crc32c_tables = make_crc32c_tables();
+
+
+/// Slicing-by-8, processes 8 bytes per step with 8 table lookups
+uint32_t detail::crc32c_sw(uint32_t crc, const std::byte* data, size_t size)
+{
+    const auto& t = c_crc32c_tables;
+    auto byte_step = [&t](uint32_t crc, std::byte b) {
+        return (crc >> 8) ^ t[0][(crc ^ uint8_t(b)) & 0xFF];
+    };
+    while (size >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, data, 4);
+        std::memcpy(&hi, data + 4, 4);
+        lo = le32toh(lo);
+        hi = le32toh(hi);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc = byte_step(crc, *data++);
+    return crc;
+}
+
+
+#if defined(XCI_CRC32C_SSE42)
+
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+static uint32_t crc32c_sse42(uint32_t crc, const std::byte* data, size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+        data += 8;
+        size -= 8;
+    }
+    crc = uint32_t(crc64);
+    while (size--)
+        crc = _mm_crc32_u8(crc, uint8_t(*data++));
+    return crc;
+}
+
+static bool detect_hw_crc32c()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;  // ECX bit 20: SSE4.2
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#elif defined(XCI_CRC32C_ARMV8)
+
+static uint32_t crc32c_armv8(uint32_t crc, const std::byte* data, size_t size)
+{
+    while (size >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        crc = __crc32cd(crc, v);
+        data += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc = __crc32cb(crc, uint8_t(*data++));
+    return crc;
+}
+
+static bool detect_hw_crc32c() { return true; }
+
+#else
+
+static bool detect_hw_crc32c() { return false; }
+
+#endif
+
+
+static bool has_hw_crc32c()
+{
+    static const bool has_hw = detect_hw_crc32c();
+    return has_hw;
+}
+
+
+uint32_t detail::crc32c_hw(uint32_t crc, const std::byte* data, size_t size)
+{
+#if defined(XCI_CRC32C_SSE42)
+    if (has_hw_crc32c())
+        return crc32c_sse42(crc, data, size);
+    return crc32c_sw(crc, data, size);
+#elif defined(XCI_CRC32C_ARMV8)
+    return crc32c_armv8(crc, data, size);
+#else
+    return crc32c_sw(crc, data, size);
+#endif
+}
+
+
+static uint32_t crc32c(uint32_t crc, const std::byte* data, size_t size)
+{
+    using Crc32cFunc = uint32_t (*)(uint32_t crc, const std::byte* data, size_t size);
+#if defined(XCI_CRC32C_SSE42)
+    static const Crc32cFunc impl = has_hw_crc32c() ? crc32c_sse42 : detail::crc32c_sw;
+#elif defined(XCI_CRC32C_ARMV8)
+    static const Crc32cFunc impl = crc32c_armv8;
+#else
+    static const Crc32cFunc impl = detail::crc32c_sw;
+#endif
+    return impl(crc, data, size);
+}
+
+
+// -----------------------------------------------------------------------------
+
+
 inline uint32_t init_crc()
 {
     return (uint32_t) crc32_z(0L, Z_NULL, 0);
 }
 
 
-Crc32::Crc32()
-    : m_crc(init_crc())
+Crc32::Crc32(Variant variant)
+    : m_crc(variant == Variant::Ieee ? init_crc() : 0),
+      m_variant(variant)
 {}
 
 
 void Crc32::reset()
 {
-    m_crc = init_crc();
+    m_crc = m_variant == Variant::Ieee ? init_crc() : 0;
 }
 
 
 void Crc32::feed(const std::byte* data, size_t size)
 {
+    // zlib would reset the CRC when data is null (e.g. empty vector)
+    if (size == 0)
+        return;
+    if (m_variant == Variant::Castagnoli) {
+        m_crc = ~crc32c(~m_crc, data, size);
+        return;
+    }
     m_crc = (uint32_t) crc32_z(m_crc, (const Bytef*) data, size);
 }
 
 
+bool Crc32::has_hw_crc32c()
+{
+    return data::has_hw_crc32c();
+}
+
+
 } // namespace xci::data
@@ -20,9 +20,20 @@ namespace xci::data {
 ///     uint32_t r = crc(some_data);  // feed and read
 ///     uint32_t r = crc.as_uint32();     // just read
 ///
+/// Two variants are supported:
+/// - Ieee: the common CRC-32 (as in zlib, PNG, Ethernet), computed by zlib
+/// - Castagnoli: CRC-32C (as in iSCSI, ext4), computed by CPU instructions
+///   where available (SSE 4.2 on x86, CRC extension on ARMv8),
+///   otherwise with slicing-by-8 tables
+///
 class Crc32 {
 public:
-    Crc32();
+    enum class Variant: uint8_t {
+        Ieee,
+        Castagnoli,
+    };
+
+    explicit Crc32(Variant variant = Variant::Ieee);
 
     template<typename T> requires std::is_trivial_v<T>
     uint32_t operator() (const T& data) { feed((const std::byte*)&data, sizeof(data)); return m_crc; }
@@ -41,12 +52,29 @@ public:
     constexpr size_t size() const { return sizeof m_crc; }
 
     uint32_t as_uint32() const { return m_crc; }
+    Variant variant() const { return m_variant; }
+
+    /// Is CRC-32C computed by CPU instructions on this machine?
+    static bool has_hw_crc32c();
 
 private:
     uint32_t m_crc;
+    Variant m_variant;
 };
 
 
+namespace detail {
+
+// CRC-32C implementations used by Crc32, exposed for testing.
+// `crc` is the running value, without the initial and final inversion.
+// The hardware variant falls back to software where not supported
+// (see `Crc32::has_hw_crc32c`).
+uint32_t crc32c_sw(uint32_t crc, const std::byte* data, size_t size);
+uint32_t crc32c_hw(uint32_t crc, const std::byte* data, size_t size);
+
+} // namespace detail
+
+
 } // namespace xci::data
 
 #endif // include guard
@@ -14,6 +14,8 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <span>
+#include <string_view>
 
 namespace xci::data {
 
@@ -41,6 +43,7 @@ namespace xci::data {
 /// - int, float (123, 1.23)
 /// - bool (false/true)
 /// - string ("utf8 text")
+/// - binary data (only size is written: "(N bytes)")
 ///
 class Dumper : public ArchiveBase<Dumper> {
     friend ArchiveBase<Dumper>;
@@ -86,6 +89,16 @@ public:
         m_stream << '"' << a.value << '"' << std::endl;
     }
 
+    void add(ArchiveField<std::string_view>&& a) {
+        write_key_name(a.key, a.name);
+        m_stream << '"' << a.value << '"' << std::endl;
+    }
+
+    void add(ArchiveField<std::span<const std::byte>>&& a) {
+        write_key_name(a.key, a.name);
+        m_stream << "(" << a.value.size() << " bytes)" << std::endl;
+    }
+
     template <typename T>
     requires requires { typename T::iterator; }
     void add(ArchiveField<T>&& a) {
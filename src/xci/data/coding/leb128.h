@@ -7,6 +7,9 @@
 #ifndef XCI_DATA_CODING_LEB128_H
 #define XCI_DATA_CODING_LEB128_H
 
+#include <limits>
+#include <type_traits>
+#include <cstddef>
 #include <cassert>
 
 /// Implements [LEB128](https://en.wikipedia.org/wiki/LEB128) encoding
@@ -15,6 +18,27 @@
 namespace xci::data {
 
 
+/// Maximum number of bytes needed to encode integer of type T as LEB128.
+template <typename T>
+requires std::is_integral_v<T> && std::is_unsigned_v<T>
+constexpr size_t leb128_max_length()
+{
+    return (sizeof(T) * 8 + 6) / 7;
+}
+
+
+/// Number of bytes needed to encode `value` as LEB128 (without skip bits).
+template <typename T>
+requires std::is_integral_v<T> && std::is_unsigned_v<T>
+constexpr size_t leb128_length(T value)
+{
+    size_t length = 1;
+    while (value >>= 7)
+        ++length;
+    return length;
+}
+
+
 /// Encode unsigned integer as LEB128 and write it to output iterator.
 /// \param iter         Output iterator. Element should be byte/char. Must support ++, * operations.
 /// \param value        Integral value to be written.
@@ -32,6 +32,8 @@ INCBIN(sprite_vert, XCI_SHARE_DIR "/shaders/sprite.vert.spv");
 INCBIN(sprite_frag, XCI_SHARE_DIR "/shaders/sprite.frag.spv");
 INCBIN(sprite_c_vert, XCI_SHARE_DIR "/shaders/sprite_c.vert.spv");
 INCBIN(sprite_c_frag, XCI_SHARE_DIR "/shaders/sprite_c.frag.spv");
+INCBIN(sprite_sdf_frag, XCI_SHARE_DIR "/shaders/sprite_sdf.frag.spv");
+INCBIN(sprite_c_sdf_frag, XCI_SHARE_DIR "/shaders/sprite_c_sdf.frag.spv");
 INCBIN(line_vert, XCI_SHARE_DIR "/shaders/line.vert.spv");
 INCBIN(line_frag, XCI_SHARE_DIR "/shaders/line.frag.spv");
 INCBIN(rectangle_vert, XCI_SHARE_DIR "/shaders/rectangle.vert.spv");
@@ -262,6 +264,14 @@ bool Renderer::load_shader(ShaderId shader_id, Shader& shader)
             return shader.load_from_memory(
                     (const char*) g_sprite_c_vert_data, g_sprite_c_vert_size,
                     (const char*) g_sprite_c_frag_data, g_sprite_c_frag_size);
+        case ShaderId::SpriteSdf:
+            return shader.load_from_memory(
+                    (const char*) g_sprite_vert_data, g_sprite_vert_size,
+                    (const char*) g_sprite_sdf_frag_data, g_sprite_sdf_frag_size);
+        case ShaderId::SpriteCSdf:
+            return shader.load_from_memory(
+                    (const char*) g_sprite_c_vert_data, g_sprite_c_vert_size,
+                    (const char*) g_sprite_c_sdf_frag_data, g_sprite_c_sdf_frag_size);
         case ShaderId::Line:
             return shader.load_from_memory(
                     (const char*) g_line_vert_data, g_line_vert_size,
@@ -295,6 +305,14 @@ bool Renderer::load_shader(ShaderId shader_id, Shader& shader)
             return shader.load_from_vfs(vfs(),
                     "shaders/sprite_c.vert.spv",
                     "shaders/sprite_c.frag.spv");
+        case ShaderId::SpriteSdf:
+            return shader.load_from_vfs(vfs(),
+                    "shaders/sprite.vert.spv",
+                    "shaders/sprite_sdf.frag.spv");
+        case ShaderId::SpriteCSdf:
+            return shader.load_from_vfs(vfs(),
+                    "shaders/sprite_c.vert.spv",
+                    "shaders/sprite_c_sdf.frag.spv");
         case ShaderId::Line:
             return shader.load_from_vfs(vfs(),
                     "shaders/line.vert.spv",
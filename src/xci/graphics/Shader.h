@@ -24,6 +24,8 @@ class Renderer;
 enum class ShaderId {
     Sprite = 0,
     SpriteC,
+    SpriteSdf,      // Sprite with signed distance field texture
+    SpriteCSdf,     // SpriteC with signed distance field texture
     Line,
     Rectangle,
     Ellipse,
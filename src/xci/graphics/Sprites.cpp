@@ -20,10 +20,11 @@
 namespace xci::graphics {
 
 
-Sprites::Sprites(Renderer& renderer, Texture& texture, const Color& color)
+Sprites::Sprites(Renderer& renderer, Texture& texture, const Color& color,
+                 ShaderId shader)
         : m_texture(texture), m_color(color),
           m_quads(renderer, VertexFormat::V2t2, PrimitiveType::TriFans),
-          m_shader(renderer.get_shader(ShaderId::Sprite))
+          m_shader(renderer.get_shader(shader))
 {}
 
 
@@ -82,10 +83,11 @@ void Sprites::draw(View& view, const ViewportCoords& pos)
 
 
 ColoredSprites::ColoredSprites(Renderer& renderer,
-                               Texture& texture, const Color& color)
+                               Texture& texture, const Color& color,
+                               ShaderId shader)
     : m_texture(texture), m_color(color),
       m_quads(renderer, VertexFormat::V2c4t2, PrimitiveType::TriFans),
-      m_shader(renderer.get_shader(ShaderId::SpriteC))
+      m_shader(renderer.get_shader(shader))
 {}
 
 
@@ -36,7 +36,8 @@ using xci::core::Vec2f;
 class Sprites {
 public:
     explicit Sprites(Renderer& renderer, Texture& texture,
-                     const Color& color = Color::White());
+                     const Color& color = Color::White(),
+                     ShaderId shader = ShaderId::Sprite);
 
     // Reserve memory for `num` sprites.
     void reserve(size_t num);
@@ -72,7 +73,8 @@ private:
 class ColoredSprites {
 public:
     explicit ColoredSprites(Renderer& renderer, Texture& texture,
-                            const Color& color = Color::White());
+                            const Color& color = Color::White(),
+                            ShaderId shader = ShaderId::SpriteC);
 
     // Reserve memory for `num` sprites.
     void reserve(size_t num);
@@ -21,7 +21,7 @@ Texture::Texture(Renderer& renderer)
 {}
 
 
-bool Texture::create(const Vec2u& size)
+bool Texture::create(const Vec2u& size, Filter filter)
 {
     destroy();
     m_size = size;
@@ -97,10 +97,11 @@ bool Texture::create(const Vec2u& size)
 
     // sampler
 
+    const VkFilter vk_filter = filter == Filter::Linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
     VkSamplerCreateInfo sampler_ci = {
             .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-            .magFilter = VK_FILTER_NEAREST,
-            .minFilter = VK_FILTER_NEAREST,
+            .magFilter = vk_filter,
+            .minFilter = vk_filter,
             .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
             .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
             .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
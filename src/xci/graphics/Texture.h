@@ -32,14 +32,22 @@ public:
     explicit Texture(Renderer& renderer);
     ~Texture() { destroy(); }
 
+    enum class Filter {
+        Nearest,    // exact pixels, for textures drawn in original size
+        Linear,     // for scaled textures, e.g. signed distance fields
+    };
+
     // Create or resize the texture
-    bool create(const Vec2u& size);
+    bool create(const Vec2u& size, Filter filter = Filter::Nearest);
 
     // Write data to staging memory (don't forget to `update` the texture)
     void write(const uint8_t* pixels);
     void write(const uint8_t* pixels, const Rect_u& region);
     void clear();
 
+    // Pixels written to staging memory (the content of the texture after `update`)
+    const uint8_t* staging_pixels() const { return (const uint8_t*) m_staging_mapped; }
+
     // Transfer pending data to texture memory
     void update();
 
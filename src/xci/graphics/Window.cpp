@@ -424,6 +424,7 @@ void Window::draw()
 
         if (m_draw_cb)
             m_draw_cb(m_view);
+        ++m_frame_number;
 
         vkCmdEndRenderPass(cmd_buf);
 
@@ -203,6 +203,10 @@ public:
     /// This needs to be called before recreating objects that are being drawn.
     void finish_draw();
 
+    /// Number of frames drawn so far. Updates between two draws
+    /// see the same number, it identifies the frame being prepared.
+    uint64_t frame_number() const { return m_frame_number; }
+
     // GLFW handles
     GLFWwindow* glfw_window() const { return m_window; }
 
@@ -228,6 +232,7 @@ private:
     std::chrono::microseconds m_timeout {0};
     bool m_clear_timeout = false;
     bool m_draw_finished = true;
+    uint64_t m_frame_number = 0;
 
     VkCommandBuffer m_command_buffers[cmd_buf_count] {};
     VkFence m_cmd_buf_fences[cmd_buf_count] {};
@@ -0,0 +1,111 @@
+// DistanceField.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace xci::text {
+
+
+static constexpr double c_inf = 1e20;
+
+
+Vec2u DistanceField::generate(const uint8_t* coverage, Vec2u size)
+{
+    const unsigned width = size.x + 2 * m_spread;
+    const unsigned height = size.y + 2 * m_spread;
+    const size_t n = size_t(width) * height;
+
+    // the border is outside of the glyph
+    m_outer.assign(n, c_inf);
+    m_inner.assign(n, 0.0);
+    for (unsigned y = 0; y != size.y; ++y) {
+        for (unsigned x = 0; x != size.x; ++x) {
+            const double a = coverage[y * size.x + x] / 255.0;
+            if (a == 0.0)
+                continue;
+            const size_t i = (y + m_spread) * width + x + m_spread;
+            if (a == 1.0) {
+                m_outer[i] = 0.0;
+                m_inner[i] = c_inf;
+            } else {
+                // partially covered pixel - estimate distance to the edge
+                const double d = 0.5 - a;
+                m_outer[i] = d > 0.0 ? d * d : 0.0;
+                m_inner[i] = d < 0.0 ? d * d : 0.0;
+            }
+        }
+    }
+
+    transform_2d(m_outer.data(), width, height);
+    transform_2d(m_inner.data(), width, height);
+
+    m_field.resize(n);
+    const double scale = 0.5 / m_spread;
+    for (size_t i = 0; i != n; ++i) {
+        const double dist = std::sqrt(m_outer[i]) - std::sqrt(m_inner[i]);
+        const double value = std::clamp(0.5 - dist * scale, 0.0, 1.0);
+        m_field[i] = uint8_t(std::lround(value * 255.0));
+    }
+    return {width, height};
+}
+
+
+void DistanceField::transform_2d(double* grid, unsigned width, unsigned height)
+{
+    const unsigned length = std::max(width, height);
+    m_f.resize(length);
+    m_v.resize(length);
+    m_z.resize(length + 1);
+    for (unsigned x = 0; x != width; ++x)
+        transform_1d(grid, x, width, height);
+    for (unsigned y = 0; y != height; ++y)
+        transform_1d(grid, size_t(y) * width, 1, width);
+}
+
+
+// Lower envelope of parabolas rooted at each sample
+void DistanceField::transform_1d(double* grid, size_t offset, size_t stride, unsigned length)
+{
+    double* f = m_f.data();
+    double* z = m_z.data();
+    unsigned* v = m_v.data();
+    for (unsigned q = 0; q != length; ++q)
+        f[q] = grid[offset + q * stride];
+
+    v[0] = 0;
+    z[0] = -c_inf;
+    z[1] = c_inf;
+    unsigned k = 0;
+    for (unsigned q = 1; q != length; ++q) {
+        double s;
+        for (;;) {
+            const unsigned r = v[k];
+            s = (f[q] - f[r] + double(q) * q - double(r) * r) / (2.0 * (q - r));
+            if (s > z[k] || k == 0)
+                break;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = c_inf;
+    }
+
+    k = 0;
+    for (unsigned q = 0; q != length; ++q) {
+        while (z[k + 1] < q)
+            ++k;
+        const unsigned r = v[k];
+        const double d = double(q) - r;
+        grid[offset + q * stride] = f[r] + d * d;
+    }
+}
+
+
+} // namespace xci::text
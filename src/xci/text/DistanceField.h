@@ -0,0 +1,62 @@
+// DistanceField.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_TEXT_DISTANCE_FIELD_H
+#define XCI_TEXT_DISTANCE_FIELD_H
+
+#include <xci/core/geometry.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace xci::text {
+
+using core::Vec2u;
+
+
+/// Converts anti-aliased glyph bitmap (coverage) to signed distance field.
+///
+/// The output is larger by `spread` pixels on each side, so the field
+/// can fade out around the glyph. The pixel value 128 lies on the edge,
+/// inside of the glyph is above, outside is below. The distance `spread`
+/// maps to 255 (inside) and 0 (outside).
+///
+/// Uses exact Euclidean distance transform (Felzenszwalb & Huttenlocher),
+/// which is linear in number of pixels. The gray levels of the coverage
+/// give sub-pixel position of the edge (the same approach as Mapbox TinySDF).
+/// The work buffers are kept between calls, reuse the object for all glyphs.
+
+class DistanceField {
+public:
+    explicit DistanceField(unsigned spread = 8) : m_spread(spread) {}
+
+    unsigned spread() const { return m_spread; }
+
+    /// Generate the field from `coverage` bitmap (`size.x * size.y` bytes).
+    /// \returns    size of the field, the pixels are in `data()`
+    Vec2u generate(const uint8_t* coverage, Vec2u size);
+
+    uint8_t* data() { return m_field.data(); }
+    const uint8_t* data() const { return m_field.data(); }
+
+private:
+    void transform_2d(double* grid, unsigned width, unsigned height);
+    void transform_1d(double* grid, size_t offset, size_t stride, unsigned length);
+
+    unsigned m_spread;
+    std::vector<double> m_outer;  // squared distance to the glyph
+    std::vector<double> m_inner;  // squared distance to the background
+    // 1D transform buffers
+    std::vector<double> m_f;
+    std::vector<double> m_z;
+    std::vector<unsigned> m_v;
+    std::vector<uint8_t> m_field;
+};
+
+
+} // namespace xci::text
+
+#endif // include guard
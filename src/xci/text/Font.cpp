@@ -17,13 +17,34 @@
 
 #include <xci/text/FontLibrary.h>
 #include <xci/text/FontTexture.h>
+#include <xci/text/GlyphRasterizer.h>
+#include <xci/text/GlyphCacheFile.h>
+#include <xci/core/string.h>
 #include <xci/core/log.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace xci::text {
 
 using namespace xci::core;
 
 
+namespace {
+
+uint64_t fnv1a_hash(const byte* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i != size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+
 // ctor+dtor have to be implemented in cpp file
 // to allow use of forward declaration in unique_ptr<FontTexture>
 Font::Font(Renderer& renderer) : m_renderer(renderer) {}
@@ -33,7 +54,9 @@ Font::~Font() = default;
 void Font::add_face(std::unique_ptr<FontFace> face)
 {
     if (!m_texture)
-        m_texture = std::make_unique<FontTexture>(m_renderer);
+        create_texture();
+    if (m_render_mode != RenderMode::Normal && !face->set_render_mode(m_render_mode))
+        log::warning("Font: Render mode {} not supported by the face", int(m_render_mode));
     m_faces.emplace_back(std::move(face));
 }
 
@@ -58,51 +81,244 @@ bool Font::add_face(const core::Vfs& vfs, std::string path, int face_index)
 
 void Font::set_style(FontStyle style)
 {
+    const auto prev_face = m_current_face;
     m_current_face = 0;
     for (auto& face : m_faces) {
         if (face->style() == style) {
+            if (m_current_face != prev_face)
+                reset_latin1();
             return;
         }
         ++m_current_face;
     }
     // Style not found, selected the first one
     log::warning("Requested font style not found: {}", int(style));
+    if (m_current_face != prev_face)
+        reset_latin1();
 }
 
 
 void Font::set_size(unsigned size)
 {
+    // SDF glyphs are shared by all sizes
+    if (m_size != size && m_render_mode != RenderMode::Sdf)
+        reset_latin1();
     m_size = size;
     face().set_size(m_size);
 }
 
+
+bool Font::set_render_mode(RenderMode mode)
+{
+    if (mode == m_render_mode)
+        return true;
+    // Stop the workers first, they clone the faces (with their mode)
+    // and their results would be added to the cache of new mode.
+    // Pending glyphs are rendered again when needed.
+    m_rasterizer.reset();
+    for (auto& face : m_faces) {
+        if (!face->set_render_mode(mode)) {
+            for (auto& f : m_faces)
+                f->set_render_mode(m_render_mode);
+            return false;
+        }
+    }
+    m_render_mode = mode;
+    clear_cache();
+    // SDF textures need linear filter
+    if (m_texture)
+        create_texture();
+    return true;
+}
+
+
+graphics::ShaderId Font::sprite_shader() const
+{
+    return m_render_mode == RenderMode::Sdf ? graphics::ShaderId::SpriteSdf
+                                            : graphics::ShaderId::Sprite;
+}
+
+
+graphics::ShaderId Font::colored_sprite_shader() const
+{
+    return m_render_mode == RenderMode::Sdf ? graphics::ShaderId::SpriteCSdf
+                                            : graphics::ShaderId::SpriteC;
+}
+
+
+void Font::create_texture()
+{
+    const auto filter = m_render_mode == RenderMode::Sdf ? Texture::Filter::Linear
+                                                         : Texture::Filter::Nearest;
+    m_texture = std::make_unique<FontTexture>(m_renderer, 512, 4, filter);
+}
+
 Font::Glyph* Font::get_glyph(CodePoint code_point)
 {
+    // check cache: Latin-1 table, then hash table
+    Glyph** latin1 = code_point < m_latin1_glyphs.size() ? &m_latin1_glyphs[code_point] : nullptr;
+    Glyph* cached = latin1 ? *latin1 : nullptr;
+    const GlyphKey key = glyph_key(code_point);
+    if (cached == nullptr) {
+        cached = find_glyph(key);
+        if (latin1)
+            *latin1 = cached;
+    }
+    if (cached != nullptr && m_texture->has_glyph(cached->m_location))
+        return cached;
+
+    // glyph may be already rendered in background
+    if (m_rasterizer && m_rasterizer->has_results()) {
+        collect_rasterized();
+        cached = find_glyph(key);
+        if (latin1)
+            *latin1 = cached;
+        if (cached != nullptr && m_texture->has_glyph(cached->m_location))
+            return cached;
+    }
+
     // translate char to glyph
     // In case of failure, this returns 0, which is okay, because
     // glyph nr. 0 contains graphic for "undefined character code".
     uint glyph_index = face().get_glyph_index(code_point);
 
-    // check cache
-    GlyphKey glyph_key{m_current_face, m_size, glyph_index};
-    auto iter = m_glyphs.find(glyph_key);
-    if (iter != m_glyphs.end())
-        return &iter->second;
+    // render (new glyph, or its texture page was evicted)
+    cached = render_glyph(key, cached, glyph_index);
+    if (cached == nullptr)
+        return nullptr;
 
-    // render
-    face().set_size(m_size);
+    if (latin1)
+        *latin1 = cached;
+    return cached;
+}
+
+
+Font::Glyph* Font::get_glyph_by_index(GlyphIndex glyph_index)
+{
+    assert(glyph_index < glyph_index_flag);
+    const GlyphKey key = glyph_key(glyph_index_flag | glyph_index);
+    Glyph* cached = find_glyph(key);
+    if (cached != nullptr && m_texture->has_glyph(cached->m_location))
+        return cached;
+    return render_glyph(key, cached, glyph_index);
+}
+
+
+auto Font::render_glyph(GlyphKey key, Glyph* cached, GlyphIndex glyph_index) -> Glyph*
+{
+    const unsigned render_size = this->render_size();
+    face().set_size(render_size);
     FontFace::Glyph glyph_render;
-    if (!face().render_glyph(glyph_index, glyph_render)) {
-        return nullptr;
+    const bool rendered = face().render_glyph(glyph_index, glyph_render);
+    if (rendered)
+        cached = add_glyph(key, cached, glyph_index, glyph_render);
+    if (render_size != m_size)
+        face().set_size(m_size);  // face metrics are for the font size
+    return rendered ? cached : nullptr;
+}
+
+
+const ShapedRun& Font::shape(std::string_view text)
+{
+    const ShapeCache::Key key {uint32_t(m_current_face), m_size, m_features_id, text};
+    if (const auto* run = m_shape_cache.find(key))
+        return *run;
+
+    ShapedRun run;
+    if (!face().shape(text, m_features, run)) {
+        // no shaping - nominal glyphs with their advance
+        const float scale = glyph_scale();
+        for (CodePoint code_point : to_utf32(text)) {
+            const auto glyph_index = face().get_glyph_index(code_point);
+            const auto* glyph = get_glyph(code_point);
+            // The glyph is missing when the atlas is full, the metrics
+            // don't depend on that (the run is cached)
+            const float advance = glyph ? glyph->advance() * scale
+                                        : face().glyph_advance(glyph_index);
+            run.push_back({glyph_index, code_point, {}, {advance, 0.f}});
+        }
     }
+    return m_shape_cache.insert(key, std::move(run));
+}
+
+
+void Font::set_features(std::string features)
+{
+    if (features == m_features)
+        return;
+    m_features = std::move(features);
+    ++m_features_id;
+}
 
+
+void Font::prerasterize(std::u32string_view code_points)
+{
+    std::u32string unique(code_points);
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    std::vector<GlyphRasterizer::Job> jobs;
+    jobs.reserve(unique.size());
+    for (CodePoint code_point : unique) {
+        const GlyphKey key = glyph_key(code_point);
+        if (find_glyph(key) != nullptr)
+            continue;  // already rendered
+        jobs.push_back({&face(), render_size(), code_point, key});
+    }
+    if (jobs.empty())
+        return;
+
+    if (!m_rasterizer)
+        m_rasterizer = std::make_unique<GlyphRasterizer>();
+    m_rasterizer->submit(std::move(jobs));
+}
+
+
+size_t Font::collect_rasterized(bool wait)
+{
+    if (!m_rasterizer)
+        return 0;
+    if (wait)
+        m_rasterizer->wait();
+
+    std::vector<GlyphRasterizer::Result> results;
+    m_rasterizer->collect(results);
+    size_t added = 0;
+    for (auto& res : results) {
+        Glyph* cached = find_glyph(res.key);
+        if (cached != nullptr && m_texture->has_glyph(cached->m_location))
+            continue;  // rendered synchronously in the meantime
+        FontFace::Glyph glyph_render;
+        glyph_render.bitmap_size = res.bitmap_size;
+        glyph_render.bitmap_buffer = res.bitmap.data();
+        glyph_render.bearing = res.bearing;
+        glyph_render.advance = res.advance;
+        if (add_glyph(res.key, cached, res.glyph_index, glyph_render) != nullptr)
+            ++added;
+    }
+    return added;
+}
+
+
+auto Font::add_glyph(GlyphKey key, Glyph* cached, GlyphIndex glyph_index,
+                     const FontFace::Glyph& glyph_render) -> Glyph*
+{
     // insert into texture
     Glyph glyph;
-    if (!m_texture->add_glyph(glyph_render.bitmap_size, glyph_render.bitmap_buffer,
-                              glyph.m_tex_coords)) {
-        // no more space in texture -> reset and try again
-        clear_cache();
-        return get_glyph(code_point);
+    switch (m_texture->add_glyph(glyph_render.bitmap_size, glyph_render.bitmap_buffer,
+                                 glyph.m_location)) {
+        case GlyphAtlas::InsertResult::TooLarge:
+            log::error("Font: Glyph {} is larger than texture page", glyph_index);
+            return nullptr;
+        case GlyphAtlas::InsertResult::Full:
+            // report once per frame
+            if (m_texture->atlas().frame_overflows() == 1)
+                log::warning("Font: Glyphs of current frame don't fit in {} texture pages",
+                             m_texture->atlas().max_pages());
+            return nullptr;
+        case GlyphAtlas::InsertResult::Inserted:
+        case GlyphAtlas::InsertResult::Evicted:
+            break;
     }
 
     // fill metrics
@@ -110,23 +326,234 @@ Font::Glyph* Font::get_glyph(CodePoint code_point)
     glyph.m_advance = glyph_render.advance.x;
 
     // insert into cache
-    auto glyph_item = m_glyphs.emplace(glyph_key, glyph);
-    assert(glyph_item.second);
-    return &glyph_item.first->second;
+    if (cached != nullptr) {
+        *cached = glyph;
+        return cached;
+    }
+    return insert_glyph(key, glyph);
+}
+
+
+bool Font::load_cache(const std::string& path)
+{
+    if (!m_texture || m_texture->atlas().page_count() != 0 || m_glyph_count != 0) {
+        log::warning("Font: Cache has to be loaded before rendering any glyphs");
+        return false;
+    }
+
+    GlyphCacheFile file;
+    if (!file.read(path))
+        return false;
+
+    // the actual texture size may be smaller than requested (HW limit)
+    const auto tex_size = m_texture->texture(0).size();
+    if (file.page_size() != m_texture->page_size()
+    || tex_size.x != file.page_size() || tex_size.y != file.page_size()
+    || file.page_count() > m_texture->atlas().max_pages()) {
+        log::info("Font: Cache file {} doesn't match texture size", path);
+        return false;
+    }
+
+    // map faces in the file to loaded faces
+    const auto cache_faces = file.faces();
+    std::vector<int> face_map(cache_faces.size(), -1);
+    bool any_face = false;
+    for (size_t i = 0; i != cache_faces.size(); ++i) {
+        const auto& cf = cache_faces[i];
+        if (cf.render_mode != uint32_t(m_render_mode))
+            continue;
+        for (size_t j = 0; j != m_faces.size(); ++j) {
+            if (cf.hash != 0 && m_faces[j]->face_index() == cf.face_index
+            && face_hash(j) == cf.hash) {
+                face_map[i] = int(j);
+                any_face = true;
+                break;
+            }
+        }
+    }
+    if (!any_face) {
+        log::info("Font: Cache file {} doesn't match any face", path);
+        return false;
+    }
+
+    // upload the pages
+    std::vector<uint32_t> epochs(file.page_count());
+    for (uint32_t p = 0; p != file.page_count(); ++p) {
+        const int page = m_texture->add_full_page(file.page_pixels(p));
+        assert(page == int(p));
+        epochs[p] = m_texture->atlas().page_epoch(uint32_t(page));
+    }
+
+    // restore the glyphs
+    size_t loaded = 0;
+    for (const auto& cg : file.glyphs()) {
+        if (!file.is_valid(cg) || face_map[cg.face] == -1)
+            continue;
+        const bool empty = cg.w == 0 || cg.h == 0;
+        const GlyphKey key = make_glyph_key(size_t(face_map[cg.face]), cg.size, cg.code_point);
+        if (find_glyph(key) != nullptr)
+            continue;
+        Glyph glyph;
+        glyph.m_location.coords = {cg.x, cg.y, cg.w, cg.h};
+        glyph.m_location.page = empty ? 0 : cg.page;
+        glyph.m_location.epoch = empty ? 0 : epochs[cg.page];
+        glyph.m_bearing = {cg.bearing_x, cg.bearing_y};
+        glyph.m_advance = cg.advance;
+        insert_glyph(key, glyph);
+        ++loaded;
+    }
+    reset_latin1();
+    log::info("Font: Loaded {} glyphs from cache {}", loaded, path);
+    return true;
+}
+
+
+bool Font::save_cache(const std::string& path)
+{
+    if (!m_texture)
+        return false;
+    const auto& atlas = m_texture->atlas();
+
+    std::vector<GlyphCacheFile::Face> faces;
+    faces.reserve(m_faces.size());
+    for (size_t j = 0; j != m_faces.size(); ++j)
+        faces.push_back({face_hash(j), m_faces[j]->face_index(), uint32_t(m_render_mode)});
+
+    // only glyphs which are still present in the texture
+    std::vector<GlyphCacheFile::Glyph> glyphs;
+    glyphs.reserve(m_glyph_count);
+    for (const auto& slot : m_glyph_table) {
+        if (slot.glyph == nullptr || !atlas.is_valid(slot.glyph->m_location))
+            continue;
+        const auto& glyph = *slot.glyph;
+        const auto& coords = glyph.m_location.coords;
+        glyphs.push_back({
+                uint32_t(slot.key >> 48), uint32_t(slot.key >> 24) & 0xFFFFFF,
+                uint32_t(slot.key) & 0xFFFFFF, glyph.m_location.page,
+                coords.x, coords.y, coords.w, coords.h,
+                glyph.m_bearing.x, glyph.m_bearing.y, glyph.m_advance});
+    }
+
+    // write pages of the actual texture size, which may be smaller than requested
+    const auto tex_size = m_texture->texture(0).size();
+    if (tex_size.x != tex_size.y) {
+        log::error("Font: Cannot save cache, texture is not square: {}x{}", tex_size.x, tex_size.y);
+        return false;
+    }
+    std::vector<const uint8_t*> pages;
+    for (unsigned p = 0; p != atlas.page_count(); ++p)
+        pages.push_back(m_texture->page_pixels(p));
+    return GlyphCacheFile::write(path, tex_size.x, faces, glyphs, pages);
+}
+
+
+uint64_t Font::face_hash(size_t face)
+{
+    if (m_face_hashes.size() < m_faces.size())
+        m_face_hashes.resize(m_faces.size(), 0);
+    auto& hash = m_face_hashes[face];
+    if (hash == 0) {
+        const auto content = m_faces[face]->content();
+        if (content)
+            hash = fnv1a_hash(content->data(), content->size());
+    }
+    return hash;
+}
+
+
+static inline size_t hash_glyph_key(uint64_t key)
+{
+    // finalizer from MurmurHash3
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return size_t(key);
+}
+
+
+auto Font::find_glyph(GlyphKey key) const -> Glyph*
+{
+    if (m_glyph_table.empty())
+        return nullptr;
+    const size_t mask = m_glyph_table.size() - 1;
+    for (size_t i = hash_glyph_key(key) & mask; ; i = (i + 1) & mask) {
+        const auto& slot = m_glyph_table[i];
+        if (slot.glyph == nullptr)
+            return nullptr;
+        if (slot.key == key)
+            return slot.glyph;
+    }
+}
+
+
+auto Font::insert_glyph(GlyphKey key, const Glyph& glyph) -> Glyph*
+{
+    // keep load factor <= 1/2
+    if (2 * (m_glyph_count + 1) > m_glyph_table.size()) {
+        std::vector<GlyphSlot> old_table(std::max<size_t>(64, 2 * m_glyph_table.size()));
+        std::swap(old_table, m_glyph_table);
+        const size_t mask = m_glyph_table.size() - 1;
+        for (const auto& slot : old_table) {
+            if (slot.glyph == nullptr)
+                continue;
+            size_t i = hash_glyph_key(slot.key) & mask;
+            while (m_glyph_table[i].glyph != nullptr)
+                i = (i + 1) & mask;
+            m_glyph_table[i] = slot;
+        }
+    }
+
+    m_glyphs.push(glyph);
+    ++m_glyph_count;
+    Glyph* result = &m_glyphs.top();
+    const size_t mask = m_glyph_table.size() - 1;
+    size_t i = hash_glyph_key(key) & mask;
+    while (m_glyph_table[i].glyph != nullptr) {
+        assert(m_glyph_table[i].key != key);
+        i = (i + 1) & mask;
+    }
+    m_glyph_table[i] = {key, result};
+    return result;
+}
+
+
+void Font::begin_frame(uint64_t frame)
+{
+    if (m_texture)
+        m_texture->begin_frame(frame);
 }
 
 
 void Font::clear_cache()
 {
+    reset_latin1();
+    m_glyph_table.clear();
     m_glyphs.clear();
+    m_glyph_count = 0;
     if (m_texture)
         m_texture->clear();
+    // unshaped runs have advances of the rendered glyphs
+    m_shape_cache.clear();
+}
+
+
+Texture& Font::texture(unsigned page)
+{
+    return m_texture->texture(page);
+}
+
+
+unsigned Font::texture_page_count() const
+{
+    return m_texture->page_count();
 }
 
 
-Texture& Font::texture()
+const GlyphAtlas::Stats& Font::cache_stats() const
 {
-    return m_texture->texture();
+    return m_texture->stats();
 }
 
 
@@ -17,13 +17,19 @@
 #define XCI_TEXT_FONT_H
 
 #include <xci/text/FontFace.h>
+#include <xci/text/GlyphAtlas.h>
+#include <xci/text/ShapeCache.h>
 #include <xci/graphics/Renderer.h>
 #include <xci/graphics/Texture.h>
 #include <xci/core/geometry.h>
 #include <xci/core/Vfs.h>
 
+#include <xci/core/container/ChunkedStack.h>
+
 #include <vector>
-#include <map>
+#include <array>
+#include <string>
+#include <string_view>
 #include <cassert>
 
 namespace xci::text {
@@ -34,6 +40,7 @@ using graphics::Texture;
 
 
 class FontTexture;
+class GlyphRasterizer;
 
 
 // Encapsulates faces, styles and glyph caches for a font
@@ -66,28 +73,39 @@ public:
     void set_size(unsigned size);
     unsigned size() const { return m_size; }
 
-    struct GlyphKey {
-        size_t font_face;
-        unsigned font_size;
-        GlyphIndex glyph_index;
+    // Select how the glyphs are rendered, see RenderMode.
+    // In SDF mode, glyphs are rendered once in `sdf_size` and scaled
+    // to any font size. Draw them with `sprite_shader()` and scale
+    // their metrics by `glyph_scale()`.
+    // Changing the mode throws away all rendered glyphs and texture pages,
+    // so set it before creating any sprites with the font textures.
+    // Returns false when the mode is not supported by the faces.
+    bool set_render_mode(RenderMode mode);
+    RenderMode render_mode() const { return m_render_mode; }
 
-        bool operator<(const GlyphKey& rhs) const
-        {
-            return std::tie(font_face, font_size, glyph_index) <
-                   std::tie(rhs.font_face, rhs.font_size, rhs.glyph_index);
-        }
-    };
+    // Pixel size of glyphs rendered in SDF mode
+    static constexpr unsigned sdf_size = 48;
+
+    // Ratio of font size to size of rendered glyphs. Glyph metrics
+    // (size, bearing, advance) have to be multiplied by this. It's 1 except in SDF mode.
+    float glyph_scale() const { return float(m_size) / float(render_size()); }
+
+    // Shaders for drawing the glyphs with Sprites / ColoredSprites
+    graphics::ShaderId sprite_shader() const;
+    graphics::ShaderId colored_sprite_shader() const;
 
     class Glyph {
     public:
-        core::Vec2u size() const { return m_tex_coords.size(); }
+        core::Vec2u size() const { return m_location.coords.size(); }
         const core::Vec2i& bearing() const { return m_bearing; }
         float advance() const { return m_advance; }
 
-        const Rect_u& tex_coords() const { return m_tex_coords; };
+        // Texture page containing the glyph, see `Font::texture(page)`
+        unsigned page() const { return m_location.page; }
+        const Rect_u& tex_coords() const { return m_location.coords; };
 
     private:
-        Rect_u m_tex_coords;
+        GlyphAtlas::Location m_location;
         core::Vec2i m_bearing;  // FT bitmap_left, bitmap_top
         float m_advance = 0;
 
@@ -95,27 +113,136 @@ public:
     };
     Glyph* get_glyph(CodePoint code_point);
 
+    // Glyphs which are not nominal glyphs of any code point (ligatures,
+    // contextual forms) are cached by glyph index
+    Glyph* get_glyph_by_index(GlyphIndex glyph_index);
+    Glyph* get_glyph(const ShapedGlyph& shaped) {
+        return shaped.code_point != 0 ? get_glyph(shaped.code_point)
+                                      : get_glyph_by_index(shaped.glyph_index);
+    }
+
+    // Shape UTF-8 text with current face and size (see FontFace::shape).
+    // Without HarfBuzz, each code point maps to its nominal glyph,
+    // advanced by the glyph metrics (this renders the glyphs).
+    // The runs are cached, repeated words are shaped only once.
+    // The returned reference is valid until next call.
+    const ShapedRun& shape(std::string_view text);
+
+    // OpenType features for shaping, comma-separated, e.g. "-liga,+smcp"
+    void set_features(std::string features);
+    const std::string& features() const { return m_features; }
+
+    ShapeCache& shape_cache() { return m_shape_cache; }
+
     // just a facade
     float line_height() const { return face().line_height(); }
     float max_advance() { return face().max_advance(); }
     float ascender() const { return face().ascender(); }
     float descender() const { return face().descender(); }
-    Texture& texture();
+
+    // Glyphs are placed in multiple texture pages, see `Glyph::page()`
+    Texture& texture(unsigned page = 0);
+    unsigned texture_page_count() const;
 
     // Throw away any rendered glyphs
     void clear_cache();
 
+    // Start new frame: texture pages with glyphs used from now on
+    // are not evicted until next frame, so the sprites created in the frame
+    // stay valid. If the glyphs of a frame don't fit in the pages,
+    // the glyphs which don't fit are not rendered (with a warning).
+    // Called by Layout::update and TextTerminal::update with `Window::frame_number`,
+    // only the first call in the frame has effect (the font may be shared).
+    void begin_frame(uint64_t frame);
+
+    // Glyph cache counters: hits, misses, evicted pages, re-rasterized glyphs,
+    // glyphs that didn't fit in pages pinned by current frame
+    const GlyphAtlas::Stats& cache_stats() const;
+
+    // Render glyphs for `code_points` (current face and size) in background
+    // threads. The worker threads are started on first call.
+    // Finished glyphs are added to the cache on next cache miss
+    // in `get_glyph`, or explicitly by `collect_rasterized`.
+    // Glyphs that are requested before they are finished are rendered
+    // synchronously, as usual.
+    void prerasterize(std::u32string_view code_points);
+
+    // Add finished glyphs from `prerasterize` to the cache and the texture.
+    // \param wait      block until all submitted glyphs are finished
+    // \returns         number of glyphs added
+    size_t collect_rasterized(bool wait = false);
+
+    // Persistent glyph cache: save rendered glyphs (texture pages and metrics)
+    // to a file, load them on next start instead of rendering them again.
+    // The glyphs are matched to faces by hash of the font file, face index
+    // and render mode. Glyphs of faces which are not loaded are ignored.
+    // The file is in native byte order, it's mapped to memory and loaded
+    // in one shot. Loaded pages are not filled with more glyphs,
+    // they are evicted when the space is needed, as usual.
+    // Load the cache after adding the faces, before rendering any glyphs.
+    // \returns        false when the file is missing, invalid or doesn't match any face
+    bool load_cache(const std::string& path);
+    // \returns        false on I/O error
+    bool save_cache(const std::string& path);
+
 private:
     // check that at leas one face is loaded
     void check_face() const { assert(!m_faces.empty());  }
 
+    // key for glyph cache: face index, font size, code point
+    // (or glyph index with `glyph_index_flag`)
+    using GlyphKey = uint64_t;
+    static constexpr uint32_t glyph_index_flag = 0x800000;
+    static GlyphKey make_glyph_key(size_t face, unsigned size, CodePoint code_point) {
+        assert(face < 0x10000 && size < 0x1000000 && code_point < 0x1000000);
+        return (GlyphKey(face) << 48) | (GlyphKey(size) << 24) | code_point;
+    }
+    GlyphKey glyph_key(CodePoint code_point) const {
+        return make_glyph_key(m_current_face, render_size(), code_point);
+    }
+    // pixel size of rendered glyphs - font size or `sdf_size`
+    unsigned render_size() const { return m_render_mode == RenderMode::Sdf ? sdf_size : m_size; }
+    void create_texture();
+    Glyph* find_glyph(GlyphKey key) const;
+    Glyph* insert_glyph(GlyphKey key, const Glyph& glyph);
+    // Render glyph in render size, update `cached` or insert new glyph
+    Glyph* render_glyph(GlyphKey key, Glyph* cached, GlyphIndex glyph_index);
+    // Place rendered glyph into texture, update `cached` or insert new glyph
+    Glyph* add_glyph(GlyphKey key, Glyph* cached, GlyphIndex glyph_index,
+                     const FontFace::Glyph& glyph_render);
+    void reset_latin1() { m_latin1_glyphs.fill(nullptr); }
+    // hash of face file content, computed on first use (0 = unknown)
+    uint64_t face_hash(size_t face);
+
 private:
     Renderer& m_renderer;
     unsigned m_size = 10;
+    RenderMode m_render_mode = RenderMode::Normal;
     size_t m_current_face = 0;
     std::vector<std::unique_ptr<FontFace>> m_faces;  // faces for different strokes (eg. normal, bold, italic)
+    std::vector<uint64_t> m_face_hashes;  // see face_hash()
     std::unique_ptr<FontTexture> m_texture;  // glyph tables for different styles (size, outline)
-    std::map<GlyphKey, Glyph> m_glyphs;
+
+    // Glyph cache: open addressing hash table with linear probing.
+    // The glyphs are stored in m_glyphs (stable addresses),
+    // the table only points to them.
+    struct GlyphSlot {
+        GlyphKey key;
+        Glyph* glyph;  // nullptr = empty slot
+    };
+    std::vector<GlyphSlot> m_glyph_table;  // size is power of two
+    core::ChunkedStack<Glyph> m_glyphs;
+    size_t m_glyph_count = 0;
+    // Direct-mapped Latin-1 glyphs for current face and size
+    std::array<Glyph*, 256> m_latin1_glyphs {};
+
+    // Shaped runs
+    ShapeCache m_shape_cache;
+    std::string m_features;
+    uint32_t m_features_id = 0;  // part of shape cache key, changed with m_features
+
+    // Background rendering for prerasterize (destroyed first)
+    std::unique_ptr<GlyphRasterizer> m_rasterizer;
 };
 
 
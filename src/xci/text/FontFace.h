@@ -42,6 +42,25 @@ enum class FontStyle {
 };
 
 
+// How the glyphs are rendered into bitmaps
+enum class RenderMode {
+    Normal,     // anti-aliased coverage, for drawing in exact pixel size
+    Sdf,        // signed distance field, scalable (0.5 = edge, inside > 0.5)
+};
+
+
+// Glyph selected and positioned by text shaping (see `FontFace::shape`).
+// The units are pixels of the font size, Y goes down.
+struct ShapedGlyph {
+    GlyphIndex glyph_index;
+    CodePoint code_point;   // the glyph is nominal glyph of this code point, or 0 (e.g. ligature)
+    core::Vec2f offset;     // from pen position
+    core::Vec2f advance;    // move the pen after the glyph
+};
+
+using ShapedRun = std::vector<ShapedGlyph>;
+
+
 // Wrapper around FT_Face. Set size and attributes,
 // retrieve rendered glyphs (bitmaps) and glyph metrics.
 
@@ -57,10 +76,25 @@ public:
     virtual bool load_from_file(std::string_view file_path, int face_index) = 0;
     virtual bool load_from_memory(core::BufferPtr buffer, int face_index) = 0;
 
+    // Create new instance of the same face, using another library.
+    // This allows rendering glyphs in multiple threads, each with own library.
+    // Returns nullptr on error.
+    virtual std::unique_ptr<FontFace> clone(FontLibraryPtr library) const = 0;
+
+    // Content of the font file and index of the face in it.
+    // These identify the face in persistent glyph cache (see `Font::load_cache`).
+    // Returns null buffer on error.
+    virtual core::BufferPtr content() const = 0;
+    virtual int face_index() const = 0;
+
     virtual bool set_size(unsigned pixel_size) = 0;
 
     virtual bool set_outline() = 0;
 
+    // Select render mode for `render_glyph`.
+    // Returns false when the mode is not supported.
+    virtual bool set_render_mode(RenderMode mode) = 0;
+
     virtual FontStyle style() const = 0;
     virtual float line_height() const = 0;
     virtual float max_advance() = 0;
@@ -69,6 +103,16 @@ public:
 
     virtual GlyphIndex get_glyph_index(CodePoint code_point) const = 0;
 
+    // Horizontal advance of the glyph in current size, without rendering it.
+    // Returns 0 on error.
+    virtual float glyph_advance(GlyphIndex glyph_index) = 0;
+
+    // Shape UTF-8 text in current size: select the glyphs and their positions
+    // (kerning, ligatures, complex scripts).
+    // \param features    OpenType features, comma-separated, e.g. "-liga,+smcp"
+    // \returns           false when shaping is not supported (no HarfBuzz)
+    virtual bool shape(std::string_view text, std::string_view features, ShapedRun& run) = 0;
+
     struct Glyph {
         core::Vec2u bitmap_size;
         uint8_t* bitmap_buffer = nullptr;
@@ -22,51 +22,64 @@ namespace xci::text {
 using namespace core::log;
 
 
-FontTexture::FontTexture(Renderer& renderer, unsigned int size)
-    : m_renderer(renderer),
-      m_texture(m_renderer)
+FontTexture::FontTexture(Renderer& renderer, unsigned int size, unsigned max_pages,
+                         Texture::Filter filter)
+    : m_renderer(renderer), m_size(size), m_filter(filter), m_atlas(size, max_pages)
 {
-    if (!m_texture.create({size, size}))
-        throw std::runtime_error("Could not create font texture.");
-    //m_texture.setSmooth(true);
-    m_binpack.Init(int(size), int(size), /*allowFlip=*/false);
+    // first page is always present
+    add_page();
 }
 
 
-bool FontTexture::add_glyph(Vec2u size, const uint8_t* pixels, Rect_u& coords)
+auto FontTexture::add_glyph(Vec2u size, const uint8_t* pixels,
+                            GlyphAtlas::Location& loc) -> GlyphAtlas::InsertResult
 {
+    const auto res = m_atlas.insert(size, loc);
+    if (res == GlyphAtlas::InsertResult::TooLarge || res == GlyphAtlas::InsertResult::Full)
+        return res;
+
     // empty bitmap -> zero coords
-    if (size.x == 0 || size.y == 0) {
-        coords = {0, 0, 0, 0};
-        return true;
-    }
-
-    // try to place the rect
-    constexpr int p = 1;  // padding
-    constexpr int pp = 2 * p;
-    rbp::Rect rect = m_binpack.Insert(size.x + pp, size.y + pp,
-                                      rbp::MaxRectsBinPack::RectBestShortSideFit);
-    if (rect.height == 0 || rect.width == 0)
-        return false;
-    assert(rect.width > 0);
-    assert(rect.height > 0);
-    assert(rect.x >= 0);
-    assert(rect.y >= 0);
-
-    // set output coords
-    coords = {unsigned(rect.x + p), unsigned(rect.y + p), size.x, size.y};
+    if (size.x == 0 || size.y == 0)
+        return res;
+
+    while (loc.page >= m_pages.size())
+        add_page();
+
+    auto& texture = *m_pages[loc.page];
+    if (res == GlyphAtlas::InsertResult::Evicted)
+        texture.clear();
 
     // copy pixels into texture
-    m_texture.write(pixels, coords);
-    return true;
+    texture.write(pixels, loc.coords);
+    return res;
+}
+
+
+int FontTexture::add_full_page(const uint8_t* pixels)
+{
+    const int page = m_atlas.add_full_page();
+    if (page == -1)
+        return -1;
+    while (unsigned(page) >= m_pages.size())
+        add_page();
+    m_pages[page]->write(pixels);
+    return page;
 }
 
 
 void FontTexture::clear()
 {
-    auto ts = m_texture.size();
-    m_binpack.Init(ts.x, ts.y, false);
-    m_texture.clear();
+    m_atlas.clear();
+    for (auto& texture : m_pages)
+        texture->clear();
+}
+
+
+void FontTexture::add_page()
+{
+    auto& texture = m_pages.emplace_back(std::make_unique<Texture>(m_renderer));
+    if (!texture->create({m_size, m_size}, m_filter))
+        throw std::runtime_error("Could not create font texture.");
 }
 
 
@@ -16,11 +16,14 @@
 #ifndef XCI_TEXT_FONTTEXTURE_H
 #define XCI_TEXT_FONTTEXTURE_H
 
-#include <rbp/MaxRectsBinPack.h>
+#include "GlyphAtlas.h"
 #include <xci/graphics/Renderer.h>
 #include <xci/graphics/Texture.h>
 #include <xci/core/geometry.h>
 
+#include <memory>
+#include <vector>
+
 namespace xci::text {
 
 using core::Vec2u;
@@ -29,35 +32,65 @@ using graphics::Texture;
 using graphics::Renderer;
 
 
-// Places glyphs into a texture
+// Places glyphs into textures (atlas pages)
 
 class FontTexture {
 public:
-    // The size is fixed. If the size request cannot be satisfied by HW,
+    // The page size is fixed. If the size request cannot be satisfied by HW,
     // smaller size will be used (HW maximum texture size).
-    explicit FontTexture(Renderer& renderer, unsigned int size=512);
+    // New pages are created on demand, up to `max_pages`. After that,
+    // least recently used page is evicted (see GlyphAtlas).
+    // Use linear filter for scaled glyphs (signed distance fields).
+    explicit FontTexture(Renderer& renderer, unsigned int size=512, unsigned max_pages=4,
+                         Texture::Filter filter = Texture::Filter::Nearest);
 
     // non-copyable
     FontTexture(const FontTexture&) = delete;
     FontTexture& operator =(const FontTexture&) = delete;
 
-    /// Insert a glyph bitmap into texture, return texture coords
+    /// Insert a glyph bitmap into texture, return texture page and coords
     /// \param size     IN size of glyph bitmap
     /// \param pixels   IN data of glyph bitmap
-    /// \param coords   OUT new texture coordinates for the glyph
-    /// \returns        false when there is no space
-    bool add_glyph(Vec2u size, const uint8_t* pixels, Rect_u& coords);
+    /// \param loc      OUT texture page and coordinates for the glyph
+    /// \returns        TooLarge when the glyph is larger than a page,
+    ///                 Full when all pages are used in current frame
+    GlyphAtlas::InsertResult add_glyph(Vec2u size, const uint8_t* pixels, GlyphAtlas::Location& loc);
+
+    /// Check that a glyph previously added is still in the texture.
+    /// Marks its page as recently used.
+    bool has_glyph(const GlyphAtlas::Location& loc) { return m_atlas.lookup(loc); }
+
+    /// Pin pages used from now on, until next frame (see GlyphAtlas).
+    void begin_frame(uint64_t frame) { m_atlas.begin_frame(frame); }
+
+    /// Add a page filled with glyphs, e.g. loaded from a cache file.
+    /// The glyph locations are restored by the caller (see `atlas().page_epoch()`).
+    /// \param pixels   IN data of whole page (size x size)
+    /// \returns        index of the new page, or -1 when `max_pages` was reached
+    int add_full_page(const uint8_t* pixels);
 
-    // Get the whole texture (cut the coords returned by `insert`
+    // Pixels of a texture page, as written by `add_glyph` / `add_full_page`
+    const uint8_t* page_pixels(unsigned page) const { return m_pages[page]->staging_pixels(); }
+    unsigned page_size() const { return m_size; }
+    const GlyphAtlas& atlas() const { return m_atlas; }
+
+    // Get the whole texture page (cut the coords returned by `add_glyph`
     // and you'll get your glyph picture).
-    Texture& texture() { return m_texture; }
+    Texture& texture(unsigned page = 0) { return *m_pages[page]; }
+    unsigned page_count() const { return unsigned(m_pages.size()); }
+
+    const GlyphAtlas::Stats& stats() const { return m_atlas.stats(); }
 
     void clear();
 
 private:
+    void add_page();
+
     Renderer& m_renderer;
-    Texture m_texture;
-    rbp::MaxRectsBinPack m_binpack;
+    unsigned m_size;
+    Texture::Filter m_filter;
+    GlyphAtlas m_atlas;
+    std::vector<std::unique_ptr<Texture>> m_pages;
 };
 
 } // namespace xci::text
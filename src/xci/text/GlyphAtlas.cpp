@@ -0,0 +1,163 @@
+// GlyphAtlas.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "GlyphAtlas.h"
+
+#include <rbp/MaxRectsBinPack.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace xci::text {
+
+
+GlyphAtlas::GlyphAtlas(unsigned page_size, unsigned max_pages)
+    : m_page_size(page_size), m_max_pages(std::max(max_pages, 1u))
+{
+    m_pages.reserve(m_max_pages);
+}
+
+
+GlyphAtlas::~GlyphAtlas() = default;
+
+
+bool GlyphAtlas::lookup(const Location& loc)
+{
+    // empty bitmap - not placed in any page
+    if (loc.coords.w == 0 || loc.coords.h == 0) {
+        ++m_stats.hits;
+        return true;
+    }
+    assert(loc.page < m_pages.size());
+    auto& page = m_pages[loc.page];
+    if (page.epoch != loc.epoch) {
+        ++m_stats.rerasterizations;
+        return false;
+    }
+    page.last_used = ++m_clock;
+    ++m_stats.hits;
+    return true;
+}
+
+
+auto GlyphAtlas::insert(Vec2u size, Location& loc) -> InsertResult
+{
+    ++m_stats.misses;
+
+    // empty bitmap -> zero coords
+    if (size.x == 0 || size.y == 0) {
+        loc = {};
+        return InsertResult::Inserted;
+    }
+
+    // doesn't fit even into empty page - don't evict anything
+    if (size.x + 2 * c_padding > m_page_size || size.y + 2 * c_padding > m_page_size)
+        return InsertResult::TooLarge;
+
+    // try the page of last insert, then the others
+    if (m_current < m_pages.size() && insert_into(m_pages[m_current], size, loc))
+        return InsertResult::Inserted;
+    for (auto& page : m_pages) {
+        if (insert_into(page, size, loc))
+            return InsertResult::Inserted;
+    }
+
+    // add new page
+    if (m_pages.size() < m_max_pages) {
+        auto& page = m_pages.emplace_back();
+        page.binpack = std::make_unique<rbp::MaxRectsBinPack>();
+        reset_page(page);
+        insert_into(page, size, loc);
+        return InsertResult::Inserted;
+    }
+
+    // evict least recently used page, unless it's used in current frame
+    auto& lru = *std::min_element(m_pages.begin(), m_pages.end(),
+            [](const Page& a, const Page& b) { return a.last_used < b.last_used; });
+    if (m_frame_start != UINT64_MAX && lru.last_used > m_frame_start) {
+        ++m_stats.overflows;
+        ++m_frame_overflows;
+        return InsertResult::Full;
+    }
+    reset_page(lru);
+    ++lru.epoch;
+    ++m_stats.evictions;
+    insert_into(lru, size, loc);
+    return InsertResult::Evicted;
+}
+
+
+int GlyphAtlas::add_full_page()
+{
+    if (m_pages.size() >= m_max_pages)
+        return -1;
+    auto& page = m_pages.emplace_back();
+    page.binpack = std::make_unique<rbp::MaxRectsBinPack>();
+    reset_page(page);
+    // occupy whole page
+    page.binpack->Insert(int(m_page_size), int(m_page_size),
+                         rbp::MaxRectsBinPack::RectBestShortSideFit);
+    page.last_used = ++m_clock;
+    return int(m_pages.size() - 1);
+}
+
+
+bool GlyphAtlas::is_valid(const Location& loc) const
+{
+    if (loc.coords.w == 0 || loc.coords.h == 0)
+        return true;
+    return loc.page < m_pages.size() && m_pages[loc.page].epoch == loc.epoch;
+}
+
+
+void GlyphAtlas::begin_frame(uint64_t frame)
+{
+    if (frame == m_frame)
+        return;  // already started by another user of the atlas
+    m_frame = frame;
+    m_frame_start = m_clock;
+    m_frame_overflows = 0;
+}
+
+
+void GlyphAtlas::clear()
+{
+    for (auto& page : m_pages) {
+        reset_page(page);
+        ++page.epoch;
+    }
+    m_current = 0;
+}
+
+
+bool GlyphAtlas::insert_into(Page& page, Vec2u size, Location& loc)
+{
+    constexpr int p = c_padding;
+    constexpr int pp = 2 * p;
+    rbp::Rect rect = page.binpack->Insert(int(size.x) + pp, int(size.y) + pp,
+                                          rbp::MaxRectsBinPack::RectBestShortSideFit);
+    if (rect.height == 0 || rect.width == 0)
+        return false;
+    assert(rect.x >= 0);
+    assert(rect.y >= 0);
+
+    const auto page_index = uint32_t(&page - m_pages.data());
+    loc.coords = {unsigned(rect.x + p), unsigned(rect.y + p), size.x, size.y};
+    loc.page = page_index;
+    loc.epoch = page.epoch;
+    page.last_used = ++m_clock;
+    m_current = page_index;
+    return true;
+}
+
+
+void GlyphAtlas::reset_page(Page& page)
+{
+    page.binpack->Init(int(m_page_size), int(m_page_size), /*allowFlip=*/false);
+}
+
+
+} // namespace xci::text
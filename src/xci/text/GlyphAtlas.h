@@ -0,0 +1,130 @@
+// GlyphAtlas.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_TEXT_GLYPH_ATLAS_H
+#define XCI_TEXT_GLYPH_ATLAS_H
+
+#include <xci/core/geometry.h>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace rbp { class MaxRectsBinPack; }
+
+namespace xci::text {
+
+using core::Vec2u;
+using core::Rect_u;
+
+
+/// Allocates space for glyph bitmaps in pages of fixed size.
+/// This is the CPU side of FontTexture, it doesn't touch the textures.
+///
+/// New pages are added up to `max_pages`. When all pages are full,
+/// the least recently used page is evicted: its space is reset
+/// and all glyphs placed in it become stale. Each glyph location
+/// remembers the epoch of its page, which is incremented on eviction,
+/// so stale glyphs are detected on lookup and can be rasterized again.
+///
+/// Pages used in the current frame (since `begin_frame`) are pinned,
+/// they are never evicted, because the glyphs may be already referenced
+/// by sprites of the frame. When all pages are pinned, the glyph is not
+/// inserted (InsertResult::Full). Without `begin_frame`, nothing is pinned.
+/// The frame is identified by a number (e.g. `Window::frame_number`),
+/// so all users of a shared atlas can call `begin_frame` - only the first
+/// call in the frame starts it.
+
+class GlyphAtlas {
+public:
+    explicit GlyphAtlas(unsigned page_size = 512, unsigned max_pages = 4);
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator =(const GlyphAtlas&) = delete;
+
+    struct Location {
+        Rect_u coords;
+        uint32_t page = 0;
+        uint32_t epoch = 0;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;              // lookup found the glyph
+        uint64_t misses = 0;            // glyph was inserted (includes re-rasterizations)
+        uint64_t evictions = 0;         // pages evicted
+        uint64_t rerasterizations = 0;  // lookup found stale glyph (its page was evicted)
+        uint64_t overflows = 0;         // insert failed, all pages are pinned by current frame
+    };
+
+    enum class InsertResult {
+        Inserted,
+        Evicted,    // inserted into evicted page, the page should be cleared
+        TooLarge,   // glyph doesn't fit into empty page
+        Full,       // all pages are full and used in current frame
+    };
+
+    /// Check that the glyph is still present (its page wasn't evicted)
+    /// and mark the page as recently used.
+    bool lookup(const Location& loc);
+
+    /// Allocate space for a glyph bitmap. Evicts LRU page when all pages are full.
+    /// \param size     IN size of glyph bitmap
+    /// \param loc      OUT page and coords of the bitmap
+    InsertResult insert(Vec2u size, Location& loc);
+
+    /// Add a page which is already filled, e.g. with glyphs loaded from a cache.
+    /// No more glyphs are placed into the page until it's evicted.
+    /// \returns index of the new page, or -1 when `max_pages` was reached
+    int add_full_page();
+
+    /// Check that the glyph is still present, without touching the page or stats.
+    bool is_valid(const Location& loc) const;
+
+    /// Current epoch of the page, for creating locations of restored glyphs.
+    uint32_t page_epoch(uint32_t page) const { return m_pages[page].epoch; }
+
+    /// Start new frame: pages used from now on are pinned until next frame.
+    /// Repeated calls with the same `frame` do nothing.
+    void begin_frame(uint64_t frame);
+
+    /// Number of failed inserts in current frame (see InsertResult::Full).
+    unsigned frame_overflows() const { return m_frame_overflows; }
+
+    /// Drop all glyphs, reset all pages.
+    void clear();
+
+    unsigned page_size() const { return m_page_size; }
+    unsigned page_count() const { return unsigned(m_pages.size()); }
+    unsigned max_pages() const { return m_max_pages; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    static constexpr unsigned c_padding = 1;
+
+    struct Page {
+        std::unique_ptr<rbp::MaxRectsBinPack> binpack;
+        uint64_t last_used = 0;  // LRU clock value
+        uint32_t epoch = 0;  // incremented on eviction
+    };
+    bool insert_into(Page& page, Vec2u size, Location& loc);
+    void reset_page(Page& page);
+
+    std::vector<Page> m_pages;
+    unsigned m_page_size;
+    unsigned m_max_pages;
+    uint32_t m_current = 0;  // page of last insert, it's tried first
+    uint64_t m_clock = 0;  // LRU clock, incremented on each use
+    uint64_t m_frame_start = UINT64_MAX;  // LRU clock at begin_frame, pages used later are pinned
+    uint64_t m_frame = UINT64_MAX;  // number of current frame
+    unsigned m_frame_overflows = 0;
+    Stats m_stats;
+};
+
+
+} // namespace xci::text
+
+#endif // include guard
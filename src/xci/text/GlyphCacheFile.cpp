@@ -0,0 +1,113 @@
+// GlyphCacheFile.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "GlyphCacheFile.h"
+
+#include <xci/core/file.h>
+#include <xci/core/log.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace xci::text {
+
+using namespace xci::core;
+
+
+bool GlyphCacheFile::read(const std::string& path)
+{
+    m_header = nullptr;
+    m_buffer = map_file(path);
+    if (!m_buffer)
+        return false;  // no cache yet
+    const byte* data = m_buffer->data();
+    const size_t size = m_buffer->size();
+
+    // validate header and size of the tables
+    const auto* header = (const Header*) data;
+    if (size < sizeof(Header) || header->magic != c_magic || header->version != c_version) {
+        log::warning("GlyphCacheFile: Invalid cache file: {}", path);
+        m_buffer.reset();
+        return false;
+    }
+    const size_t page_bytes = size_t(header->page_size) * header->page_size;
+    const size_t glyphs_offset = sizeof(Header) + size_t(header->face_count) * sizeof(Face);
+    const size_t pixels_offset = glyphs_offset + size_t(header->glyph_count) * sizeof(Glyph);
+    // the size of pixels is divided, multiplication could overflow
+    const size_t pixels_size = size - std::min(size, pixels_offset);
+    if (pixels_offset > size || header->page_size == 0
+    || pixels_size % page_bytes != 0 || pixels_size / page_bytes != header->page_count) {
+        log::warning("GlyphCacheFile: Invalid cache file: {}", path);
+        m_buffer.reset();
+        return false;
+    }
+
+    m_header = header;
+    m_faces = (const Face*) (data + sizeof(Header));
+    m_glyphs = (const Glyph*) (data + glyphs_offset);
+    m_pixels = (const uint8_t*) (data + pixels_offset);
+    return true;
+}
+
+
+bool GlyphCacheFile::write(const std::string& path, uint32_t page_size,
+                           const std::vector<Face>& faces, const std::vector<Glyph>& glyphs,
+                           const std::vector<const uint8_t*>& pages)
+{
+    const Header header {
+            c_magic, c_version, page_size, uint32_t(pages.size()),
+            uint32_t(faces.size()), uint32_t(glyphs.size())};
+    // The existing file may be mapped by another process (or by `read`),
+    // don't overwrite it in place. Also a crash doesn't leave it truncated.
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+    f.write((const char*) &header, sizeof(header));
+    f.write((const char*) faces.data(), std::streamsize(faces.size() * sizeof(Face)));
+    f.write((const char*) glyphs.data(), std::streamsize(glyphs.size() * sizeof(Glyph)));
+    const size_t page_bytes = size_t(page_size) * page_size;
+    for (const uint8_t* pixels : pages)
+        f.write((const char*) pixels, std::streamsize(page_bytes));
+    f.close();
+    if (!f) {
+        log::error("GlyphCacheFile: Could not write cache file: {}", tmp_path);
+        std::error_code ec;
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        log::error("GlyphCacheFile: Could not replace cache file: {}: {}", path, ec.message());
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+
+const uint8_t* GlyphCacheFile::page_pixels(uint32_t page) const
+{
+    return m_pixels + size_t(page) * m_header->page_size * m_header->page_size;
+}
+
+
+bool GlyphCacheFile::is_valid(const Glyph& glyph) const
+{
+    if (glyph.face >= m_header->face_count
+    || glyph.size >= c_key_limit || glyph.code_point >= c_key_limit)
+        return false;
+    if (glyph.w == 0 || glyph.h == 0)
+        return true;
+    // written to not overflow with corrupted values
+    const uint32_t page_size = m_header->page_size;
+    return glyph.page < m_header->page_count
+        && glyph.x <= page_size && glyph.w <= page_size - glyph.x
+        && glyph.y <= page_size && glyph.h <= page_size - glyph.y;
+}
+
+
+} // namespace xci::text
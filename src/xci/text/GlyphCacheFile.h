@@ -0,0 +1,101 @@
+// GlyphCacheFile.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_TEXT_GLYPH_CACHE_FILE_H
+#define XCI_TEXT_GLYPH_CACHE_FILE_H
+
+#include <xci/core/Buffer.h>
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xci::text {
+
+
+/// Persistent glyph cache file (see Font::load_cache):
+///     Header
+///     Face[face_count]
+///     Glyph[glyph_count]
+///     page pixels: [page_count][page_size * page_size]
+/// All values are in native byte order (mismatch is detected by magic).
+///
+/// This is the file format only, it doesn't touch fonts or textures.
+/// The file is mapped to memory, the tables point into the mapping.
+/// It's replaced atomically by `write` (via temporary file).
+
+class GlyphCacheFile {
+public:
+    struct Face {
+        uint64_t hash;  // FNV-1a of font file content
+        int32_t face_index;
+        uint32_t render_mode;  // Font::RenderMode
+    };
+
+    // Size and code point are packed into 24 bits of Font's glyph key
+    static constexpr uint32_t c_key_limit = 0x1000000;
+
+    struct Glyph {
+        uint32_t face;  // index into Face table
+        uint32_t size;
+        uint32_t code_point;  // or glyph index with Font::glyph_index_flag
+        uint32_t page;
+        uint32_t x, y, w, h;
+        int32_t bearing_x, bearing_y;
+        float advance;
+    };
+
+    /// Map the file and validate the header and the size of the tables.
+    /// \returns    false when the file is missing or invalid (logged)
+    bool read(const std::string& path);
+
+    /// Write new cache file.
+    /// \param pages    pixels of each page (page_size * page_size)
+    /// \returns        false on I/O error (logged)
+    static bool write(const std::string& path, uint32_t page_size,
+                      const std::vector<Face>& faces, const std::vector<Glyph>& glyphs,
+                      const std::vector<const uint8_t*>& pages);
+
+    uint32_t page_size() const { return m_header->page_size; }
+    uint32_t page_count() const { return m_header->page_count; }
+    std::span<const Face> faces() const { return {m_faces, m_header->face_count}; }
+    std::span<const Glyph> glyphs() const { return {m_glyphs, m_header->glyph_count}; }
+    const uint8_t* page_pixels(uint32_t page) const;
+
+    /// Check that the glyph refers to a face in the table
+    /// and that its bitmap lies within an existing page.
+    /// Empty glyphs (zero w or h) need only a valid face.
+    /// Size and code point have to be below `c_key_limit`.
+    bool is_valid(const Glyph& glyph) const;
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t page_size;
+        uint32_t page_count;
+        uint32_t face_count;
+        uint32_t glyph_count;
+    };
+    static_assert(sizeof(Header) == 24);
+    static_assert(sizeof(Face) == 16);
+    static_assert(sizeof(Glyph) == 44);
+
+    static constexpr uint32_t c_magic = 0x43474358;  // "XGCC" in little endian
+    static constexpr uint32_t c_version = 1;
+
+    core::BufferPtr m_buffer;
+    const Header* m_header = nullptr;
+    const Face* m_faces = nullptr;
+    const Glyph* m_glyphs = nullptr;
+    const uint8_t* m_pixels = nullptr;
+};
+
+
+} // namespace xci::text
+
+#endif // include guard
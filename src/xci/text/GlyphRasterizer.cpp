@@ -0,0 +1,143 @@
+// GlyphRasterizer.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "GlyphRasterizer.h"
+#include <xci/core/log.h>
+
+#include <algorithm>
+#include <map>
+
+namespace xci::text {
+
+using namespace xci::core;
+
+
+GlyphRasterizer::GlyphRasterizer(unsigned num_threads)
+{
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    m_workers.reserve(num_threads);
+    for (unsigned i = 0; i != num_threads; ++i)
+        m_workers.emplace_back([this]{ worker(); });
+}
+
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_quit = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_workers)
+        t.join();
+}
+
+
+void GlyphRasterizer::submit(std::vector<Job> jobs)
+{
+    if (jobs.empty())
+        return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_pending += jobs.size();
+        m_queue.insert(m_queue.end(), jobs.begin(), jobs.end());
+    }
+    m_cv.notify_all();
+}
+
+
+void GlyphRasterizer::collect(std::vector<Result>& out)
+{
+    if (!has_results())
+        return;
+    std::lock_guard lock(m_mutex);
+    if (out.empty())
+        out.swap(m_results);
+    else
+        out.insert(out.end(),
+                std::make_move_iterator(m_results.begin()), std::make_move_iterator(m_results.end()));
+    m_results.clear();
+    m_has_results.store(false, std::memory_order_release);
+}
+
+
+size_t GlyphRasterizer::pending() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_pending;
+}
+
+
+void GlyphRasterizer::wait()
+{
+    std::unique_lock lock(m_mutex);
+    m_done_cv.wait(lock, [this]{ return m_pending == 0; });
+}
+
+
+void GlyphRasterizer::worker()
+{
+    // this thread's copies of the faces, with currently set size
+    struct FaceCopy {
+        std::unique_ptr<FontFace> face;
+        unsigned size = 0;
+    };
+    std::map<const FontFace*, FaceCopy> faces;
+    // the default instance is thread-local
+    auto library = FontLibrary::default_instance();
+
+    std::vector<Job> batch;
+    std::vector<Result> results;
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this]{ return m_quit || !m_queue.empty(); });
+        if (m_quit)
+            break;
+
+        // take a batch of jobs from the queue
+        const size_t n = std::min(m_queue.size(), c_batch_size);
+        batch.assign(m_queue.begin(), m_queue.begin() + ptrdiff_t(n));
+        m_queue.erase(m_queue.begin(), m_queue.begin() + ptrdiff_t(n));
+        lock.unlock();
+
+        for (const Job& job : batch) {
+            auto& copy = faces[job.face];
+            if (!copy.face) {
+                copy.face = job.face->clone(library);
+                if (!copy.face) {
+                    log::error("GlyphRasterizer: Couldn't clone font face");
+                    continue;
+                }
+            }
+            if (copy.size != job.size) {
+                copy.face->set_size(job.size);
+                copy.size = job.size;
+            }
+            const GlyphIndex glyph_index = copy.face->get_glyph_index(job.code_point);
+            FontFace::Glyph glyph;
+            if (!copy.face->render_glyph(glyph_index, glyph))
+                continue;
+            const size_t bitmap_bytes = size_t(glyph.bitmap_size.x) * glyph.bitmap_size.y;
+            results.push_back({job.key, glyph_index, glyph.bitmap_size,
+                               glyph.bearing, glyph.advance,
+                               {glyph.bitmap_buffer, glyph.bitmap_buffer + bitmap_bytes}});
+        }
+
+        lock.lock();
+        m_results.insert(m_results.end(),
+                std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+        results.clear();
+        if (!m_results.empty())
+            m_has_results.store(true, std::memory_order_release);
+        m_pending -= n;
+        if (m_pending == 0)
+            m_done_cv.notify_all();
+    }
+}
+
+
+} // namespace xci::text
@@ -0,0 +1,96 @@
+// GlyphRasterizer.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_TEXT_GLYPH_RASTERIZER_H
+#define XCI_TEXT_GLYPH_RASTERIZER_H
+
+#include <xci/text/FontFace.h>
+#include <xci/core/geometry.h>
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+namespace xci::text {
+
+
+/// Pool of worker threads rendering glyph bitmaps in background.
+///
+/// FreeType objects are not thread-safe, so each worker has its own
+/// FontLibrary and its own clone of each FontFace, created on first use.
+/// The source faces are only read when cloning, they must outlive
+/// the rasterizer.
+///
+/// The rendered bitmaps are collected on the caller thread (see `collect`),
+/// which then places them into the texture.
+
+class GlyphRasterizer {
+public:
+    /// \param num_threads  number of worker threads, 0 = number of CPU cores
+    explicit GlyphRasterizer(unsigned num_threads = 0);
+    ~GlyphRasterizer();
+
+    GlyphRasterizer(const GlyphRasterizer&) = delete;
+    GlyphRasterizer& operator =(const GlyphRasterizer&) = delete;
+
+    struct Job {
+        const FontFace* face;
+        unsigned size;          // pixel size (FontFace::set_size)
+        CodePoint code_point;
+        uint64_t key;           // passed to Result, not used by rasterizer
+    };
+
+    struct Result {
+        uint64_t key;
+        GlyphIndex glyph_index;
+        core::Vec2u bitmap_size;
+        core::Vec2i bearing;
+        core::Vec2f advance;
+        std::vector<uint8_t> bitmap;  // bitmap_size.x * bitmap_size.y bytes
+    };
+
+    unsigned num_threads() const { return unsigned(m_workers.size()); }
+
+    /// Enqueue glyphs for rendering.
+    void submit(std::vector<Job> jobs);
+
+    /// Move rendered glyphs to `out` (appended). Doesn't block.
+    /// Glyphs which failed to render are not reported.
+    void collect(std::vector<Result>& out);
+
+    /// Check if there are any results to collect, without locking.
+    bool has_results() const { return m_has_results.load(std::memory_order_acquire); }
+
+    /// Number of jobs not yet rendered (queued or in progress).
+    size_t pending() const;
+
+    /// Block until all submitted jobs are rendered.
+    void wait();
+
+private:
+    void worker();
+
+    static constexpr size_t c_batch_size = 32;  // jobs taken by worker at once
+
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_queue;  // FIFO
+    std::vector<Result> m_results;
+    mutable std::mutex m_mutex;  // for queue and results
+    std::condition_variable m_cv;
+    std::condition_variable m_done_cv;
+    size_t m_pending = 0;  // jobs in queue + being rendered
+    std::atomic_bool m_has_results {false};
+    bool m_quit = false;
+};
+
+
+} // namespace xci::text
+
+#endif // include guard
@@ -19,10 +19,16 @@
 #include <xci/graphics/View.h>
 #include <xci/graphics/Window.h>
 
+#include <xci/core/string.h>
+
+#include <map>
+#include <algorithm>
+#include <tuple>
 #include <cassert>
 
 namespace xci::text::layout {
 
+using xci::core::to_utf32;
 using xci::graphics::Color;
 using xci::graphics::View;
 using namespace xci::graphics::unit_literals;
@@ -32,53 +38,158 @@ void Layout::clear()
 {
     m_page.clear();
     m_elements.clear();
+    m_glyph_batches.clear();
+    m_checkpoints.clear();
+    m_typeset_applied = 0;
+    m_typeset_valid = 0;
 }
 
 
 void Layout::set_default_page_width(ViewportUnits width)
 {
     m_default_width = width;
-    m_page.clear();
+    invalidate(0);
 }
 
 
 void Layout::set_default_font(Font* font)
 {
     m_default_style.set_font(font);
-    m_page.clear();
+    invalidate(0);
 }
 
 
 void Layout::set_default_font_size(ViewportUnits size)
 {
     m_default_style.set_size(size);
-    m_page.clear();
+    invalidate(0);
 }
 
 
 void Layout::set_default_color(const graphics::Color& color)
 {
     m_default_style.set_color(color);
-    m_page.clear();
+    invalidate(0);
+}
+
+
+void Layout::set_word(ElementIndex index, std::string_view string)
+{
+    assert(m_elements.op(index) == ElementOp::AddWord);
+    m_elements.set_string(index, string);
+    invalidate(index);
+}
+
+
+void Layout::truncate(ElementIndex index)
+{
+    if (index >= m_elements.size())
+        return;
+    m_elements.truncate(index);
+    invalidate(index);
 }
 
+
 void Layout::typeset(const graphics::View& target)
 {
-    m_page.clear();
-    m_page.set_target(&target);
-    m_page.set_width(m_default_width);
-    m_page.set_style(m_default_style);
+    // Metrics depend on the target size, recompute everything when it changes
+    if (&target != m_typeset_target
+    || target.screen_size() != m_typeset_screen_size
+    || target.framebuffer_size() != m_typeset_framebuffer_size
+    || target.viewport_size() != m_typeset_viewport_size) {
+        m_typeset_target = &target;
+        m_typeset_screen_size = target.screen_size();
+        m_typeset_framebuffer_size = target.framebuffer_size();
+        m_typeset_viewport_size = target.viewport_size();
+        invalidate(0);
+    }
+
+    // Drop strings released by editing. This moves the strings,
+    // the page has to be rebuilt.
+    if (m_elements.needs_compact()) {
+        m_elements.compact();
+        invalidate(0);
+    }
+
+    if (m_typeset_applied > m_typeset_valid) {
+        // Roll back to last checkpoint before the first changed element
+        auto cp = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), m_typeset_valid,
+                [](ElementIndex index, const auto& item) { return index < item.first; });
+        if (cp == m_checkpoints.begin()) {
+            m_typeset_applied = 0;
+        } else {
+            --cp;
+            m_page.restore(cp->second);
+            m_typeset_applied = cp->first;
+            ++cp;
+        }
+        m_checkpoints.erase(cp, m_checkpoints.end());
+    }
+
+    if (m_typeset_applied == 0) {
+        m_page.clear();
+        m_page.set_target(&target);
+        m_page.set_width(m_default_width);
+        m_page.set_style(m_default_style);
+        m_checkpoints.clear();
+    }
+
+    size_t line_count = m_page.line_count();
+    for (auto i = m_typeset_applied; i != m_elements.size(); ++i) {
+        m_elements.apply(i, m_page);
+        if (m_page.line_count() != line_count) {
+            line_count = m_page.line_count();
+            m_checkpoints.emplace_back(i + 1, m_page.checkpoint());
+        }
+    }
+    m_typeset_applied = m_elements.size();
+    m_typeset_valid = m_elements.size();
+}
+
+void Layout::prerasterize(const graphics::View& target)
+{
+    // collect code points by font and size
+    std::map<std::pair<Font*, unsigned>, std::u32string> code_points;
+    m_page.foreach_word([&](const Word& word) {
+        auto* font = word.style().font();
+        if (!font)
+            return;
+        const auto size = target.size_to_framebuffer(word.style().size()).as<unsigned>();
+        code_points[{font, size}] += to_utf32(word.string());
+    });
 
-    for (auto& elem : m_elements) {
-        elem->apply(m_page);
+    // keep the size of each font as it was
+    std::map<Font*, unsigned> orig_sizes;
+    for (auto& [font_size, chars] : code_points) {
+        auto [font, size] = font_size;
+        orig_sizes.try_emplace(font, font->size());
+        font->set_size(size);
+        font->prerasterize(chars);
     }
+    for (auto [font, size] : orig_sizes)
+        font->set_size(size);
 }
 
+
 void Layout::update(const graphics::View& target)
 {
-    m_page.foreach_word([&](Word& word) {
-        word.update(target);
+    if (m_visible_region) {
+        std::tie(m_first_line, m_last_line) = m_page.find_lines(
+                m_visible_region->top(), m_visible_region->bottom());
+    } else {
+        m_first_line = 0;
+        m_last_line = m_page.line_count();
+    }
+
+    m_glyph_batches.clear();
+    auto* batches = m_batched ? &m_glyph_batches : nullptr;
+    const auto frame = target.window()->frame_number();
+    m_page.foreach_word(m_first_line, m_last_line, [&](Word& word) {
+        if (Font* font = word.style().font())
+            font->begin_frame(frame);  // no-op if already started in this frame
+        word.update(target, batches);
     });
+    m_glyph_batches.update();
 
     // setup debug rectangles
 
@@ -139,99 +250,114 @@ void Layout::draw(View& target, const ViewportCoords& pos) const
         shape.draw(target, pos);
     }
 
-    m_page.foreach_word([&](const Word& word) {
-        word.draw(target, pos);
-    });
+    if (!m_batched) {
+        // Cull the lines outside of the view (the batches are drawn as a whole)
+        ViewportRect view_rect {target.viewport_center() - 0.5f * target.viewport_size(),
+                                target.viewport_size()};
+        if (target.has_crop())
+            view_rect = view_rect.intersection(target.get_crop());
+        view_rect = view_rect.moved(-(target.offset() + pos));
+        auto [first, last] = m_page.find_lines(view_rect.top(), view_rect.bottom());
+        first = std::max(first, m_first_line);
+        last = std::min(last, m_last_line);
+        if (first < last) {
+            m_page.foreach_word(first, last, [&](const Word& word) {
+                word.draw(target, pos);
+            });
+        }
+    }
+
+    m_glyph_batches.draw(target, pos);
 }
 
 
 void Layout::set_page_width(ViewportUnits width)
 {
-    m_elements.push_back(std::make_unique<SetPageWidth>(width));
+    m_elements.add(ElementOp::SetPageWidth, width);
 }
 
 
 void Layout::set_alignment(Alignment alignment)
 {
-    m_elements.push_back(std::make_unique<SetAlignment>(alignment));
+    m_elements.add(ElementOp::SetAlignment, alignment);
 }
 
 
 void Layout::add_tab_stop(ViewportUnits x)
 {
-    m_elements.push_back(std::make_unique<AddTabStop>(x));
+    m_elements.add(ElementOp::AddTabStop, x);
 }
 
 
 void Layout::reset_tab_stops()
 {
-    m_elements.push_back(std::make_unique<ResetTabStops>());
+    m_elements.add(ElementOp::ResetTabStops);
 }
 
 
 void Layout::set_offset(const ViewportSize& offset)
 {
-    m_elements.push_back(std::make_unique<SetOffset>(offset));
+    m_elements.add(ElementOp::SetOffset, offset);
 }
 
 
 void Layout::set_font(Font* font)
 {
-    m_elements.push_back(std::make_unique<SetFont>(font));
+    m_elements.add(ElementOp::SetFont, font);
 }
 
 
 void Layout::set_font_size(ViewportUnits size)
 {
-    m_elements.push_back(std::make_unique<SetFontSize>(size));
+    m_elements.add(ElementOp::SetFontSize, size);
 }
 
 
 void Layout::set_color(const graphics::Color& color)
 {
-    m_elements.push_back(std::make_unique<SetColor>(color));
+    m_elements.add(ElementOp::SetColor, color);
 }
 
 
 void Layout::reset_color()
 {
-    m_elements.push_back(std::make_unique<SetColor>(m_default_style.color()));
+    m_elements.add(ElementOp::SetColor, m_default_style.color());
 }
 
 
-void Layout::add_word(const std::string& string)
+void Layout::add_word(std::string_view string)
 {
-    m_elements.push_back(std::make_unique<AddWord>(string));
+    m_elements.add(ElementOp::AddWord, string);
 }
 
 
 void Layout::add_space()
 {
-    m_elements.push_back(std::make_unique<AddSpace>());
+    m_elements.add(ElementOp::AddSpace);
 }
 
 
 void Layout::add_tab()
 {
-    m_elements.push_back(std::make_unique<AddTab>());
+    m_elements.add(ElementOp::AddTab);
 }
 
 
 void Layout::finish_line()
 {
-    m_elements.push_back(std::make_unique<FinishLine>());
+    m_elements.add(ElementOp::FinishLine);
 }
 
 
 void Layout::begin_span(const std::string& name)
 {
-    m_elements.push_back(std::make_unique<BeginSpan>(name));
+    m_elements.add(ElementOp::BeginSpan, name);
 }
 
 
 void Layout::end_span(const std::string& name)
 {
-    m_elements.push_back(std::make_unique<EndSpan>(name));
+    m_elements.add(ElementOp::EndSpan, name);
 }
 
 
@@ -27,7 +27,10 @@
 #include <xci/core/container/ChunkedStack.h>
 
 #include <string>
+#include <optional>
+#include <string_view>
 #include <utility>
+#include <algorithm>
 #include <vector>
 
 namespace xci::text {
@@ -51,6 +54,13 @@ public:
 
     const Style& default_style() const { return m_default_style; }
 
+    // Batched mode (default): glyphs of all words are collected into
+    // one vertex stream per font texture and color, drawn with a single
+    // draw call each. When disabled, each word has its own sprites
+    // and is drawn separately.
+    void set_batched(bool batched) { m_batched = batched; }
+    bool is_batched() const { return m_batched; }
+
     // ------------------------------------------------------------------------
     // Control elements
     //
@@ -87,7 +97,8 @@ public:
     // Word should be actual word. Punctuation can be attached to it
     // or pushed separately as another "word". No whitespace should be contained
     // in the word, unless it is meant to behave as hard, unbreakable space.
-    void add_word(const std::string& string);
+    // Each distinct word is stored only once (see ElementStream).
+    void add_word(std::string_view string);
 
     // Add a space after last word. Does nothing if current line is empty.
     void add_space();
@@ -112,6 +123,25 @@ public:
     // Returns NULL if the span does not exist.
     Span* get_span(const std::string& name);
 
+    // ------------------------------------------------------------------------
+    // Editing
+    //
+    // Elements are numbered from 0, in order of addition.
+    // Next `typeset` continues from the first changed element,
+    // the page content before it is kept. Replaced and removed words
+    // are kept in memory until there are more of them than elements,
+    // then they are dropped and the whole page is typeset again.
+
+    // Number of elements in the stream (i.e. index of next element).
+    ElementIndex element_count() const { return m_elements.size(); }
+
+    // Replace the word at `index`. The element must have been added by `add_word`.
+    void set_word(ElementIndex index, std::string_view string);
+
+    // Remove elements from `index` to the end.
+    // New elements can be added after that as usual.
+    void truncate(ElementIndex index);
+
     // ------------------------------------------------------------------------
     // Typeset and draw
 
@@ -119,25 +149,62 @@ public:
     // positions and sizes.
     // Should be called on every change of framebuffer size
     // and after addition of new elements.
+    // Only the elements added or changed since last call are processed,
+    // unless the target size or default style have changed.
     void typeset(const graphics::View& target);
 
+    // Submit all glyphs of the typeset page for rendering in background
+    // threads (see Font::prerasterize). Call after `typeset`, some time
+    // before `update`, to avoid rendering many new glyphs in `update`.
+    void prerasterize(const graphics::View& target);
+
     // Recreate graphics objects. Must be called at least once before draw.
     void update(const graphics::View& target);
 
     // Draw whole layout to target
     void draw(graphics::View& target, const ViewportCoords& pos) const;
 
+    // Restrict `update` to lines which intersect the region (in page
+    // coordinates, i.e. relative to `pos` in `draw`). The lines outside
+    // are not updated nor drawn, until the region is moved over them
+    // and `update` is called again. This makes very long pages cheap,
+    // when only a small part of them is visible at a time.
+    // Default: no region, whole page is updated.
+    // Independently of this, `draw` in non-batched mode skips lines
+    // outside of the target view.
+    void set_visible_region(const ViewportRect& region) { m_visible_region = region; }
+    void reset_visible_region() { m_visible_region.reset(); }
+
     // ------------------------------------------------------------------------
     // Metrics
 
     ViewportRect bbox() const;
 
 private:
+    void invalidate(ElementIndex index) { m_typeset_valid = std::min(m_typeset_valid, index); }
+
     Page m_page;
-    std::vector<std::unique_ptr<Element>> m_elements;
+    ElementStream m_elements;
+
+    // incremental typesetting
+    ElementIndex m_typeset_applied = 0;  // number of elements applied to m_page
+    ElementIndex m_typeset_valid = 0;  // the elements before this are unchanged
+    const graphics::View* m_typeset_target = nullptr;
+    graphics::ScreenSize m_typeset_screen_size;
+    graphics::FramebufferSize m_typeset_framebuffer_size;
+    ViewportSize m_typeset_viewport_size;
+    // page state after each element which started a new line
+    std::vector<std::pair<ElementIndex, Page::Checkpoint>> m_checkpoints;
 
     Style m_default_style;
     ViewportUnits m_default_width = 0;
+    bool m_batched = true;
+    std::optional<ViewportRect> m_visible_region;
+    // lines updated by last `update`
+    size_t m_first_line = 0;
+    size_t m_last_line = 0;
+
+    GlyphBatches m_glyph_batches;
 
     mutable core::ChunkedStack<graphics::Shape> m_debug_shapes;
 };
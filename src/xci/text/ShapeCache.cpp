@@ -0,0 +1,78 @@
+// ShapeCache.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "ShapeCache.h"
+
+#include <cassert>
+
+namespace xci::text {
+
+
+void ShapeCache::set_capacity(size_t capacity)
+{
+    m_capacity = capacity;
+    while (m_index.size() > m_capacity)
+        evict();
+}
+
+
+void ShapeCache::clear()
+{
+    m_index.clear();
+    m_lru.clear();
+}
+
+
+const ShapedRun* ShapeCache::find(const Key& key)
+{
+    make_key(key);
+    auto it = m_index.find(m_key_buffer);
+    if (it == m_index.end()) {
+        ++m_stats.misses;
+        return nullptr;
+    }
+    ++m_stats.hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return &it->second->run;
+}
+
+
+const ShapedRun& ShapeCache::insert(const Key& key, ShapedRun run)
+{
+    if (m_capacity == 0) {
+        m_uncached = std::move(run);
+        return m_uncached;
+    }
+    while (m_index.size() >= m_capacity)
+        evict();
+
+    make_key(key);
+    assert(m_index.find(m_key_buffer) == m_index.end());
+    m_lru.push_front({m_key_buffer, std::move(run)});
+    m_index.emplace(m_lru.front().key, m_lru.begin());
+    return m_lru.front().run;
+}
+
+
+void ShapeCache::make_key(const Key& key)
+{
+    // fixed-size head + the text
+    const uint32_t head[] = {key.face, key.size, key.features};
+    m_key_buffer.assign((const char*) head, sizeof(head));
+    m_key_buffer.append(key.text);
+}
+
+
+void ShapeCache::evict()
+{
+    assert(!m_lru.empty());
+    m_index.erase(m_lru.back().key);
+    m_lru.pop_back();
+    ++m_stats.evictions;
+}
+
+
+} // namespace xci::text
@@ -0,0 +1,79 @@
+// ShapeCache.h created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#ifndef XCI_TEXT_SHAPE_CACHE_H
+#define XCI_TEXT_SHAPE_CACHE_H
+
+#include <xci/text/FontFace.h>
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace xci::text {
+
+
+/// Cache of shaped runs, with least recently used runs evicted.
+///
+/// The runs are keyed by face, size, features (an ID given by Font)
+/// and the text itself. Repeated words are shaped only once.
+
+class ShapeCache {
+public:
+    explicit ShapeCache(size_t capacity = 4096) : m_capacity(capacity) {}
+
+    // Maximum number of runs. Zero disables the cache.
+    void set_capacity(size_t capacity);
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_index.size(); }
+
+    void clear();
+
+    struct Key {
+        uint32_t face;
+        uint32_t size;
+        uint32_t features;
+        std::string_view text;
+    };
+
+    /// Find the run and mark it as most recently used.
+    /// \returns    nullptr if not found
+    const ShapedRun* find(const Key& key);
+
+    /// Insert newly shaped run, evicting the least recently used one when full.
+    /// \returns    reference to the inserted run, valid until next insert
+    const ShapedRun& insert(const Key& key, ShapedRun run);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+    const Stats& stats() const { return m_stats; }
+
+private:
+    void make_key(const Key& key);  // to m_key_buffer
+    void evict();
+
+    struct Entry {
+        std::string key;
+        ShapedRun run;
+    };
+    size_t m_capacity;
+    std::list<Entry> m_lru;  // most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;  // keys point to Entry::key
+    std::string m_key_buffer;
+    ShapedRun m_uncached;  // capacity = 0
+    Stats m_stats;
+};
+
+
+} // namespace xci::text
+
+#endif // include guard
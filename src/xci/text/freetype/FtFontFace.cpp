@@ -14,8 +14,15 @@
 // limitations under the License.
 
 #include <xci/core/log.h>
+#include <xci/core/file.h>
 #include "FtFontFace.h"
 #include "FtFontLibrary.h"
+#include <xci/core/string.h>
+
+#ifdef XCI_WITH_HARFBUZZ
+#include <hb-ft.h>
+#endif
+
 #include <cassert>
 
 namespace xci::text {
@@ -41,12 +48,17 @@ FtFontFace::~FtFontFace()
     if (m_stroker != nullptr) {
         FT_Stroker_Done(m_stroker);
     }
+#ifdef XCI_WITH_HARFBUZZ
+    hb_buffer_destroy(m_hb_buffer);
+    hb_font_destroy(m_hb_font);
+#endif
 }
 
 
 bool FtFontFace::load_from_file(string_view file_path, int face_index)
 {
-    return load_face(file_path.data(), nullptr, 0, face_index);
+    m_file_path = file_path;
+    return load_face(m_file_path.c_str(), nullptr, 0, face_index);
 }
 
 
@@ -57,6 +69,28 @@ bool FtFontFace::load_from_memory(core::BufferPtr buffer, int face_index)
 }
 
 
+std::unique_ptr<FontFace> FtFontFace::clone(FontLibraryPtr library) const
+{
+    auto face = std::make_unique<FtFontFace>(std::move(library));
+    // the memory buffer is read-only, it can be shared by both faces
+    const bool ok = m_memory_buffer
+            ? face->load_from_memory(m_memory_buffer, m_face_index)
+            : face->load_from_file(m_file_path, m_face_index);
+    if (!ok)
+        return nullptr;
+    face->set_render_mode(m_render_mode);
+    return face;
+}
+
+
+core::BufferPtr FtFontFace::content() const
+{
+    if (m_memory_buffer)
+        return m_memory_buffer;
+    return map_file(m_file_path);
+}
+
+
 bool FtFontFace::set_size(unsigned pixel_size)
 {
     /*auto wh = float_to_ft(size);
@@ -71,6 +105,7 @@ bool FtFontFace::set_size(unsigned pixel_size)
         return false;
     }
 
+    m_hb_font_changed = true;
     return true;
 }
 
@@ -92,6 +127,15 @@ bool FtFontFace::set_outline()
 }
 
 
+bool FtFontFace::set_render_mode(RenderMode mode)
+{
+    m_render_mode = mode;
+    if (mode == RenderMode::Sdf && !m_distance_field)
+        m_distance_field = std::make_unique<DistanceField>();
+    return true;
+}
+
+
 FontStyle FtFontFace::style() const
 {
     assert(m_face != nullptr);
@@ -140,9 +184,76 @@ GlyphIndex FtFontFace::get_glyph_index(CodePoint code_point) const
 }
 
 
+float FtFontFace::glyph_advance(GlyphIndex glyph_index)
+{
+    auto glyph_slot = load_glyph(glyph_index);
+    if (glyph_slot == nullptr)
+        return 0.f;
+    return ft_to_float(glyph_slot->advance.x);
+}
+
+
+bool FtFontFace::shape(std::string_view text, std::string_view features, ShapedRun& run)
+{
+#ifdef XCI_WITH_HARFBUZZ
+    if (m_hb_font == nullptr) {
+        m_hb_font = hb_ft_font_create_referenced(m_face);
+        m_hb_buffer = hb_buffer_create();
+    } else if (m_hb_font_changed) {
+        hb_ft_font_changed(m_hb_font);  // sync scale with the new size
+    }
+    m_hb_font_changed = false;
+
+    std::vector<hb_feature_t> hb_features;
+    while (!features.empty()) {
+        const auto comma = features.find(',');
+        const auto item = features.substr(0, comma);
+        hb_feature_t feature;
+        if (hb_feature_from_string(item.data(), int(item.size()), &feature))
+            hb_features.push_back(feature);
+        else
+            log::warning("FtFontFace: Invalid font feature: {}", item);
+        features.remove_prefix(comma == std::string_view::npos ? features.size() : comma + 1);
+    }
+
+    hb_buffer_clear_contents(m_hb_buffer);
+    hb_buffer_add_utf8(m_hb_buffer, text.data(), int(text.size()), 0, int(text.size()));
+    hb_buffer_guess_segment_properties(m_hb_buffer);
+    hb_shape(m_hb_font, m_hb_buffer, hb_features.data(), unsigned(hb_features.size()));
+
+    unsigned count = 0;
+    const auto* infos = hb_buffer_get_glyph_infos(m_hb_buffer, &count);
+    const auto* positions = hb_buffer_get_glyph_positions(m_hb_buffer, &count);
+    run.clear();
+    run.reserve(count);
+    for (unsigned i = 0; i != count; ++i) {
+        const auto& info = infos[i];
+        const auto& pos = positions[i];
+        // hb_glyph_info_t::codepoint is the glyph index after shaping
+        const GlyphIndex glyph_index = info.codepoint;
+        // nominal glyph of the cluster's code point can share the cache with unshaped text
+        CodePoint code_point = utf8_codepoint(text.data() + info.cluster);
+        if (get_glyph_index(code_point) != glyph_index)
+            code_point = 0;
+        run.push_back({glyph_index, code_point,
+                       {ft_to_float(pos.x_offset), -ft_to_float(pos.y_offset)},
+                       {ft_to_float(pos.x_advance), -ft_to_float(pos.y_advance)}});
+    }
+    return true;
+#else
+    (void) text; (void) features; (void) run;
+    return false;
+#endif
+}
+
+
 FT_GlyphSlot FtFontFace::load_glyph(GlyphIndex glyph_index)
 {
-    int err = FT_Load_Glyph(m_face, glyph_index, FT_LOAD_DEFAULT | FT_LOAD_TARGET_LIGHT);
+    // SDF is scaled, hinting for the render size would only distort it
+    const auto flags = m_render_mode == RenderMode::Sdf
+            ? FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING
+            : FT_LOAD_DEFAULT | FT_LOAD_TARGET_LIGHT;
+    int err = FT_Load_Glyph(m_face, glyph_index, flags);
     if (err) {
         log::error("FT_Load_Glyph error: {}", err);
         return nullptr;
@@ -173,6 +284,17 @@ bool FtFontFace::render_glyph(GlyphIndex glyph_index, Glyph& glyph)
     glyph.bitmap_size = {bitmap.width, bitmap.rows};
     glyph.bitmap_buffer = bitmap.buffer;
     glyph.bearing = {glyph_slot->bitmap_left, glyph_slot->bitmap_top};
+
+    // Convert the coverage to distance field. FreeType has its own SDF
+    // renderers (FT_RENDER_MODE_SDF), but they are two orders of magnitude slower.
+    if (m_render_mode == RenderMode::Sdf && bitmap.width != 0 && bitmap.rows != 0) {
+        const int spread = int(m_distance_field->spread());
+        glyph.bitmap_size = m_distance_field->generate(bitmap.buffer, glyph.bitmap_size);
+        glyph.bitmap_buffer = m_distance_field->data();
+        glyph.bearing.x -= spread;
+        glyph.bearing.y += spread;
+    }
+
     glyph.advance = {ft_to_float(glyph_slot->advance.x),
                      ft_to_float(glyph_slot->advance.y)};
     return true;
@@ -192,6 +314,7 @@ bool FtFontFace::load_face(const char* file_path, const byte* buffer, size_t buf
         log::error("FontFace: Reloading not supported! Create new instance instead.");
         return false;
     }
+    m_face_index = face_index;
     FT_Error err;
     if (buffer) {
         err = FT_New_Memory_Face(ft_library(), reinterpret_cast<const FT_Byte*>(buffer), buffer_size, face_index, &m_face);
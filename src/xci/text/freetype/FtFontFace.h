@@ -17,12 +17,19 @@
 #define XCI_TEXT_FREETYPE_FONTFACE_H
 
 #include <xci/text/FontFace.h>
+#include <xci/text/DistanceField.h>
 #include <xci/core/Buffer.h>
 
+#include <string>
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_STROKER_H
 
+// HarfBuzz (optional, see XCI_WITH_HARFBUZZ)
+struct hb_font_t;
+struct hb_buffer_t;
+
 namespace xci::text {
 
 
@@ -34,10 +41,17 @@ public:
     bool load_from_file(std::string_view file_path, int face_index) override;
     bool load_from_memory(core::BufferPtr buffer, int face_index) override;
 
+    std::unique_ptr<FontFace> clone(FontLibraryPtr library) const override;
+
+    core::BufferPtr content() const override;
+    int face_index() const override { return m_face_index; }
+
     bool set_size(unsigned pixel_size) override;
 
     bool set_outline() override;  // TODO
 
+    bool set_render_mode(RenderMode mode) override;
+
     FontStyle style() const override;
     float line_height() const override;
     float max_advance() override;
@@ -45,9 +59,12 @@ public:
     float descender() const override;
 
     GlyphIndex get_glyph_index(CodePoint code_point) const override;
+    float glyph_advance(GlyphIndex glyph_index) override;
 
     bool render_glyph(GlyphIndex glyph_index, Glyph& glyph) override;
 
+    bool shape(std::string_view text, std::string_view features, ShapedRun& run) override;
+
 private:
     FT_Library ft_library();
     bool load_face(const char* file_path, const byte* buffer, size_t buffer_size, int face_index);
@@ -57,8 +74,15 @@ private:
 
 private:
     core::BufferPtr m_memory_buffer;
+    std::string m_file_path;  // when loaded from file (for clone)
+    int m_face_index = 0;
+    RenderMode m_render_mode = RenderMode::Normal;
+    std::unique_ptr<DistanceField> m_distance_field;  // SDF mode
     FT_Face m_face = nullptr;
     FT_Stroker m_stroker = nullptr;
+    hb_font_t* m_hb_font = nullptr;  // created on first `shape`
+    hb_buffer_t* m_hb_buffer = nullptr;
+    bool m_hb_font_changed = false;  // set_size was called since last `shape`
 };
 
 
@@ -0,0 +1,242 @@
+// Element.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include "Element.h"
+
+#include <algorithm>
+#include <functional>
+#include <bit>
+#include <cstring>
+#include <cassert>
+
+namespace xci::text::layout {
+
+
+// The element refers to the string pool or to the offset table
+static bool has_reference(ElementOp op)
+{
+    return op == ElementOp::AddWord || op == ElementOp::BeginSpan
+        || op == ElementOp::EndSpan || op == ElementOp::SetOffset;
+}
+
+
+void ElementStream::clear()
+{
+    m_elements.clear();
+    m_offsets.clear();
+    m_fonts.clear();
+    m_pool.clear();
+    m_pool_size = 0;
+    m_pool_free = 0;
+    m_strings.clear();
+    m_string_table.clear();
+    m_released = 0;
+}
+
+
+void ElementStream::truncate(ElementIndex index)
+{
+    for (auto i = index; i < m_elements.size(); ++i) {
+        if (has_reference(m_elements[i].op))
+            ++m_released;
+    }
+    m_elements.resize(index);
+}
+
+
+void ElementStream::compact()
+{
+    ElementStream live;
+    live.m_elements.reserve(m_elements.size());
+    live.m_fonts = m_fonts;  // there are only a few
+    for (Element elem : m_elements) {
+        switch (elem.op) {
+            case ElementOp::AddWord:
+            case ElementOp::BeginSpan:
+            case ElementOp::EndSpan:
+                elem.arg = live.intern(m_strings[elem.arg]);
+                break;
+            case ElementOp::SetOffset:
+                live.m_offsets.push_back(m_offsets[elem.arg]);
+                elem.arg = uint32_t(live.m_offsets.size() - 1);
+                break;
+            default:
+                break;
+        }
+        live.m_elements.push_back(elem);
+    }
+    *this = std::move(live);
+}
+
+
+void ElementStream::add(ElementOp op, ViewportUnits value)
+{
+    uint32_t arg;
+    std::memcpy(&arg, &value.value, sizeof(arg));
+    m_elements.push_back({op, arg});
+}
+
+
+void ElementStream::add(ElementOp op, graphics::Color color)
+{
+    static_assert(sizeof(color) == sizeof(uint32_t));
+    m_elements.push_back({op, std::bit_cast<uint32_t>(color)});
+}
+
+
+void ElementStream::add(ElementOp op, const ViewportSize& offset)
+{
+    m_elements.push_back({op, uint32_t(m_offsets.size())});
+    m_offsets.push_back(offset);
+}
+
+
+void ElementStream::add(ElementOp op, Font* font)
+{
+    // there are only a few fonts, linear search is fine
+    auto it = std::find(m_fonts.begin(), m_fonts.end(), font);
+    if (it == m_fonts.end())
+        it = m_fonts.insert(it, font);
+    m_elements.push_back({op, uint32_t(it - m_fonts.begin())});
+}
+
+
+void ElementStream::set_string(ElementIndex index, std::string_view string)
+{
+    auto& elem = m_elements[index];
+    assert(elem.op == ElementOp::AddWord || elem.op == ElementOp::BeginSpan
+           || elem.op == ElementOp::EndSpan);
+    elem.arg = intern(string);
+    ++m_released;
+}
+
+
+void ElementStream::apply(ElementIndex index, Page& page) const
+{
+    const auto& elem = m_elements[index];
+    const auto as_float = [&elem] {
+        float value;
+        std::memcpy(&value, &elem.arg, sizeof(value));
+        return value;
+    };
+    switch (elem.op) {
+        case ElementOp::SetPageWidth:
+            page.set_width(as_float());
+            break;
+        case ElementOp::SetAlignment:
+            page.set_alignment(Alignment(elem.arg));
+            break;
+        case ElementOp::AddTabStop:
+            page.add_tab_stop(as_float());
+            break;
+        case ElementOp::ResetTabStops:
+            page.reset_tab_stops();
+            break;
+        case ElementOp::SetOffset:
+            page.set_pen_offset(m_offsets[elem.arg]);
+            break;
+        case ElementOp::SetFont:
+            page.set_font(m_fonts[elem.arg]);
+            break;
+        case ElementOp::SetFontSize:
+            page.set_font_size(as_float());
+            break;
+        case ElementOp::SetColor:
+            page.set_color(std::bit_cast<graphics::Color>(elem.arg));
+            break;
+        case ElementOp::AddWord:
+            page.add_word(m_strings[elem.arg]);
+            break;
+        case ElementOp::AddSpace:
+            page.add_space();
+            break;
+        case ElementOp::AddTab:
+            page.add_tab();
+            break;
+        case ElementOp::FinishLine:
+            page.finish_line();
+            break;
+        case ElementOp::BeginSpan:
+            page.begin_span(std::string(m_strings[elem.arg]));
+            break;
+        case ElementOp::EndSpan:
+            page.end_span(std::string(m_strings[elem.arg]));
+            break;
+    }
+}
+
+
+size_t ElementStream::memory_size() const
+{
+    return m_elements.capacity() * sizeof(Element)
+         + m_offsets.capacity() * sizeof(ViewportSize)
+         + m_fonts.capacity() * sizeof(Font*)
+         + m_pool_size
+         + m_strings.capacity() * sizeof(std::string_view)
+         + m_string_table.capacity() * sizeof(uint32_t);
+}
+
+
+uint32_t ElementStream::intern(std::string_view string)
+{
+    const auto hash = std::hash<std::string_view>{}(string);
+    if (!m_string_table.empty()) {
+        const size_t mask = m_string_table.size() - 1;
+        for (size_t i = hash & mask; m_string_table[i] != 0; i = (i + 1) & mask) {
+            const uint32_t id = m_string_table[i] - 1;
+            if (m_strings[id] == string)
+                return id;
+        }
+    }
+
+    // keep load factor <= 1/2
+    if (2 * (m_strings.size() + 1) > m_string_table.size()) {
+        m_string_table.assign(std::max<size_t>(64, 2 * m_string_table.size()), 0);
+        const size_t mask = m_string_table.size() - 1;
+        for (uint32_t id = 0; id != m_strings.size(); ++id) {
+            size_t i = std::hash<std::string_view>{}(m_strings[id]) & mask;
+            while (m_string_table[i] != 0)
+                i = (i + 1) & mask;
+            m_string_table[i] = id + 1;
+        }
+    }
+
+    const auto id = uint32_t(m_strings.size());
+    m_strings.push_back(store(string));
+    const size_t mask = m_string_table.size() - 1;
+    size_t i = hash & mask;
+    while (m_string_table[i] != 0)
+        i = (i + 1) & mask;
+    m_string_table[i] = id + 1;
+    return id;
+}
+
+
+std::string_view ElementStream::store(std::string_view string)
+{
+    if (string.empty())
+        return {};
+    if (string.size() > m_pool_free) {
+        if (string.size() > pool_chunk_size / 4) {
+            // big string - own allocation, keep filling the current chunk
+            auto it = m_pool.empty() ? m_pool.end() : m_pool.end() - 1;
+            it = m_pool.insert(it, std::make_unique<char[]>(string.size()));
+            m_pool_size += string.size();
+            std::memcpy(it->get(), string.data(), string.size());
+            return {it->get(), string.size()};
+        }
+        m_pool.push_back(std::make_unique<char[]>(pool_chunk_size));
+        m_pool_size += pool_chunk_size;
+        m_pool_free = pool_chunk_size;
+    }
+    char* dest = m_pool.back().get() + pool_chunk_size - m_pool_free;
+    std::memcpy(dest, string.data(), string.size());
+    m_pool_free -= string.size();
+    return {dest, string.size()};
+}
+
+
+} // namespace xci::text::layout
@@ -18,176 +18,110 @@
 
 #include "Page.h"
 
-#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace xci::text::layout {
 
 
-class Element {
-public:
-    virtual ~Element() = default;
-    virtual void apply(Page& page) = 0;
-};
-
-
-// ------------------------------------------------------------------------
-// Control elements - change page attributes
-
-
-class SetPageWidth: public Element {
-public:
-    explicit SetPageWidth(ViewportUnits width) : m_width(width) {}
-    void apply(Page& page) override {
-        page.set_width(m_width);
-    }
-
-private:
-    float m_width;
+// Element opcodes, with the payload stored in the element
+enum class ElementOp: uint8_t {
+    // Control elements - change page attributes
+    SetPageWidth,   // width (float)
+    SetAlignment,   // Alignment
+    AddTabStop,     // x (float)
+    ResetTabStops,
+    SetOffset,      // index to offset table
+    SetFont,        // index to font table
+    SetFontSize,    // size (float)
+    SetColor,       // RGBA
+    // Text elements
+    AddWord,        // string ID
+    AddSpace,
+    AddTab,
+    FinishLine,
+    BeginSpan,      // string ID (span name)
+    EndSpan,        // string ID (span name)
 };
 
 
-class SetAlignment: public Element {
-public:
-    explicit SetAlignment(Alignment alignment) : m_alignment(alignment) {}
-    void apply(Page& page) override {
-        page.set_alignment(m_alignment);
-    }
-
-private:
-    Alignment m_alignment;
-};
-
-
-class AddTabStop: public Element {
-public:
-    explicit AddTabStop(ViewportUnits tab_stop) : m_tab_stop(tab_stop) {}
-    void apply(Page& page) override {
-        page.add_tab_stop(m_tab_stop);
-    }
-
-private:
-    float m_tab_stop;
-};
-
-
-class ResetTabStops: public Element {
-public:
-    void apply(Page& page) override {
-        page.reset_tab_stops();
-    }
-};
-
-
-class SetOffset: public Element {
-public:
-    explicit SetOffset(const ViewportSize& offset) : m_offset(offset) {}
-    void apply(Page& page) override {
-        page.set_pen_offset(m_offset);
-    }
-
-private:
-    const ViewportSize m_offset;
-};
-
-
-class SetFont: public Element {
-public:
-    explicit SetFont(Font* font) : m_font(font) {}
-    void apply(Page& page) override {
-        page.set_font(m_font);
-    }
-
-private:
-    Font* m_font;
-};
-
-
-class SetFontSize: public Element {
-public:
-    explicit SetFontSize(ViewportUnits size) : m_size(size) {}
-    void apply(Page& page) override {
-        page.set_font_size(m_size);
-    }
-
-private:
-    float m_size;
-};
-
-
-class SetColor: public Element {
-public:
-    explicit SetColor(graphics::Color color) : m_color(color) {}
-    void apply(Page& page) override {
-        page.set_color(m_color);
-    }
-
-private:
-    graphics::Color m_color;
-};
-
-
-// ------------------------------------------------------------------------
-// Text elements
-
-
-// Single word, consisting of letters (glyphs), font and style.
-class AddWord: public Element {
-public:
-    explicit AddWord(std::string string) : m_string(std::move(string)) {}
-    void apply(Page& page) override {
-        page.add_word(m_string);
-    }
-
-private:
-    std::string m_string;
-};
-
+// Packed stream of layout elements (text and control).
+//
+// Each element takes 8 bytes: the opcode and 32-bit payload.
+// Larger payloads (offsets, fonts) are kept in small side tables,
+// the element refers to them by index.
+//
+// Strings (words, span names) are interned in a string pool - each distinct
+// string is stored once and the element refers to it by ID. The pool
+// is only appended to, the strings keep their address until `clear`
+// or `compact`, so Page can refer to them without making copies.
+//
+// Strings and offsets released by `set_string` and `truncate` stay
+// in the pool. When the released references outnumber the elements,
+// `needs_compact` is true and Layout compacts the stream before next
+// typeset, so the pool is at most about twice the size of live data.
 
-class AddSpace: public Element {
+class ElementStream {
 public:
-    void apply(Page& page) override {
-        page.add_space();
-    }
-};
+    void clear();
 
+    ElementIndex size() const { return m_elements.size(); }
+    ElementOp op(ElementIndex index) const { return m_elements[index].op; }
 
-class AddTab: public Element {
-public:
-    void apply(Page& page) override {
-        page.add_tab();
-    }
-};
-
+    void add(ElementOp op) { m_elements.push_back({op, 0}); }
+    void add(ElementOp op, ViewportUnits value);
+    void add(ElementOp op, Alignment alignment) { m_elements.push_back({op, uint32_t(alignment)}); }
+    void add(ElementOp op, graphics::Color color);
+    void add(ElementOp op, const ViewportSize& offset);
+    void add(ElementOp op, Font* font);
+    void add(ElementOp op, std::string_view string) { m_elements.push_back({op, intern(string)}); }
 
-class FinishLine: public Element {
-public:
-    void apply(Page& page) override {
-        page.finish_line();
-    }
-};
+    // Replace string payload of the element
+    void set_string(ElementIndex index, std::string_view string);
 
+    // Remove elements from `index` to the end (the pool is kept)
+    void truncate(ElementIndex index);
 
-class BeginSpan: public Element {
-public:
-    explicit BeginSpan(std::string name) : m_name(std::move(name)) {}
-    void apply(Page& page) override {
-        page.begin_span(m_name);
-    }
+    // Rebuild the pool and side tables with only the data referenced
+    // by the elements. The strings are moved, views into the pool are invalidated.
+    void compact();
+    bool needs_compact() const { return m_released > m_elements.size(); }
 
-private:
-    std::string m_name;
-};
+    // Apply the element to the page
+    void apply(ElementIndex index, Page& page) const;
 
+    // String pool
+    std::string_view string(uint32_t id) const { return m_strings[id]; }
+    size_t string_count() const { return m_strings.size(); }
 
-class EndSpan: public Element {
-public:
-    explicit EndSpan(std::string name) : m_name(std::move(name)) {}
-    void apply(Page& page) override {
-        page.end_span(m_name);
-    }
+    // Total bytes allocated by the stream
+    size_t memory_size() const;
 
 private:
-    std::string m_name;
+    uint32_t intern(std::string_view string);
+    std::string_view store(std::string_view string);
+
+    struct Element {
+        ElementOp op;
+        uint32_t arg;
+    };
+    static_assert(sizeof(Element) == 8);
+    std::vector<Element> m_elements;
+
+    // side tables
+    std::vector<ViewportSize> m_offsets;
+    std::vector<Font*> m_fonts;
+
+    // string pool
+    static constexpr size_t pool_chunk_size = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> m_pool;  // chunks, or single big strings
+    size_t m_pool_size = 0;  // allocated bytes
+    size_t m_pool_free = 0;  // free bytes at end of last chunk
+    std::vector<std::string_view> m_strings;  // by ID, pointing into m_pool
+    std::vector<uint32_t> m_string_table;  // hash table of ID+1 (0 = empty slot), size is power of two
+    size_t m_released = 0;  // string and offset references dropped since last compact
 };
 
 
@@ -18,6 +18,7 @@
 #include <xci/core/string.h>
 #include <xci/core/log.h>
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -31,8 +32,8 @@ using xci::graphics::View;
 using xci::graphics::Color;
 
 
-Word::Word(Page& page, std::string string)
-    : m_string(std::move(string)), m_style(page.style())
+Word::Word(Page& page, std::string_view string)
+    : m_string(string), m_style(page.style())
 {
     auto* font = m_style.font();
     if (!font) {
@@ -49,13 +50,9 @@ Word::Word(Page& page, std::string string)
     // Measure word (metrics are affected by string, font, size)
     ViewportCoords pen;
     m_bbox = {0, ViewportUnits{0} - m_baseline, 0, font_height};
-    for (CodePoint code_point : to_utf32(m_string)) {
-        auto* glyph = font->get_glyph(code_point);
-        if (glyph == nullptr)
-            continue;
-
+    for (const ShapedGlyph& shaped : font->shape(m_string)) {
         // Expand text bounds by glyph bounds
-        auto advance_vp = page.target().size_to_viewport(FramebufferPixels{glyph->advance()});
+        auto advance_vp = page.target().size_to_viewport(FramebufferPixels{shaped.advance.x});
         ViewportRect rect{pen.x ,
                           pen.y - m_baseline,
                           advance_vp,
@@ -79,7 +76,7 @@ Word::Word(Page& page, std::string string)
 }
 
 
-void Word::update(const graphics::View& target)
+void Word::update(const graphics::View& target, GlyphBatches* batches)
 {
     auto* font = m_style.font();
     if (!font) {
@@ -94,7 +91,7 @@ void Word::update(const graphics::View& target)
 
     const auto fb_1px = target.size_to_viewport(1_fb);
     m_debug_shapes.clear();
-    m_sprites.reset();
+    m_sprites.clear();
 
     if (target.has_debug_flag(View::Debug::WordBBox)) {
         m_debug_shapes.emplace_back(renderer,
@@ -111,31 +108,38 @@ void Word::update(const graphics::View& target)
                 Color(250, 50, 50));
     }
 
-    m_sprites.emplace(renderer, font->texture(), m_style.color());
+    auto& sprites = batches ? *batches : m_sprites;
+    const float scale = font->glyph_scale();
+    const auto shader = font->sprite_shader();
 
     ViewportCoords pen = m_pos;
-    for (CodePoint code_point : to_utf32(m_string)) {
-        auto* glyph = font->get_glyph(code_point);
-        if (glyph == nullptr)
+    for (const ShapedGlyph& shaped : font->shape(m_string)) {
+        const auto advance = target.size_to_viewport(FramebufferSize{shaped.advance});
+        auto* glyph = font->get_glyph(shaped);
+        if (glyph == nullptr) {
+            pen += advance;
             continue;
+        }
 
-        auto bearing = target.size_to_viewport(FramebufferSize{glyph->bearing()});
-        auto glyph_size = target.size_to_viewport(FramebufferSize{glyph->size()});
-        ViewportRect rect{pen.x + bearing.x,
-                          pen.y - bearing.y,
+        auto bearing = target.size_to_viewport(FramebufferSize{Vec2f(glyph->bearing()) * scale});
+        auto glyph_size = target.size_to_viewport(FramebufferSize{Vec2f(glyph->size()) * scale});
+        auto offset = target.size_to_viewport(FramebufferSize{shaped.offset});
+        ViewportRect rect{pen.x + offset.x + bearing.x,
+                          pen.y + offset.y - bearing.y,
                           glyph_size.x,
                           glyph_size.y};
-        m_sprites->add_sprite(rect, glyph->tex_coords());
+        sprites.get(renderer, font->texture(glyph->page()), m_style.color(), shader)
+                .add_sprite(rect, glyph->tex_coords());
         if (show_bboxes)
             m_debug_shapes.back().add_rectangle(rect, fb_1px);
 
-        pen.x += target.size_to_viewport(FramebufferPixels{glyph->advance()});
+        pen += advance;
     }
 
     if (show_bboxes)
         m_debug_shapes.back().update();
 
-    m_sprites->update();
+    m_sprites.update();
 
     if (target.has_debug_flag(View::Debug::WordBasePoint)) {
         const auto sc_1px = target.size_to_viewport(1_sc);
@@ -154,8 +158,7 @@ void Word::draw(graphics::View& target, const ViewportCoords& pos) const
         shape.draw(target, pos);
     }
 
-    if (m_sprites)
-        m_sprites->draw(target, pos);
+    m_sprites.draw(target, pos);
 
     if (target.has_debug_flag(View::Debug::WordBasePoint)
     && !m_debug_shapes.empty()) {
@@ -165,6 +168,39 @@ void Word::draw(graphics::View& target, const ViewportCoords& pos) const
 }
 
 
+graphics::Sprites& GlyphBatches::get(graphics::Renderer& renderer,
+                                     graphics::Texture& texture, const graphics::Color& color,
+                                     graphics::ShaderId shader)
+{
+    auto match = [&](const Key& key) {
+        return key.texture == &texture && key.color == color;
+    };
+    if (m_last < m_keys.size() && match(m_keys[m_last]))
+        return *m_keys[m_last].sprites;
+    auto it = std::find_if(m_keys.begin(), m_keys.end(), match);
+    m_last = it - m_keys.begin();
+    if (it != m_keys.end())
+        return *it->sprites;
+    m_sprites.emplace_back(renderer, texture, color, shader);
+    m_keys.push_back({&texture, color, &m_sprites.back()});
+    return m_sprites.back();
+}
+
+
+void GlyphBatches::update()
+{
+    for (auto& sprites : m_sprites)
+        sprites.update();
+}
+
+
+void GlyphBatches::draw(graphics::View& target, const ViewportCoords& pos) const
+{
+    for (auto& sprites : m_sprites)
+        sprites.draw(target, pos);
+}
+
+
 const ViewportRect& Line::bbox() const
 {
     if (m_bbox_valid)
@@ -217,6 +253,15 @@ void Span::adjust_style(const std::function<void(Style& word_style)>& fn_adjust)
 }
 
 
+void Span::truncate(size_t num_parts, size_t last_part_words, bool open)
+{
+    assert(num_parts > 0 && num_parts <= m_parts.size());
+    m_parts.resize(num_parts);
+    m_parts.back().truncate(last_part_words);
+    m_open = open;
+}
+
+
 Page::Page()
 {
     m_lines.emplace_back();
@@ -247,6 +292,50 @@ void Page::clear()
     m_lines.emplace_back();
     m_spans.clear();
     m_words.clear();
+    m_num_words = 0;
+}
+
+
+auto Page::checkpoint() const -> Checkpoint
+{
+    Checkpoint cp {m_pen, m_pen_offset, m_style, m_width, m_alignment, m_tab_stops,
+                   m_num_words, m_lines.size(), m_lines.back().words().size()};
+    cp.spans.reserve(m_spans.size());
+    for (const auto& [name, span] : m_spans)
+        cp.spans.push_back({name, span.parts().size(), span.parts().back().words().size(),
+                            span.is_open()});
+    return cp;
+}
+
+
+void Page::restore(const Checkpoint& cp)
+{
+    m_pen = cp.pen;
+    m_pen_offset = cp.pen_offset;
+    m_style = cp.style;
+    m_width = cp.width;
+    m_alignment = cp.alignment;
+    m_tab_stops = cp.tab_stops;
+
+    // drop the content added after the checkpoint
+    assert(cp.num_words <= m_num_words && cp.num_lines <= m_lines.size());
+    for (; m_num_words != cp.num_words; --m_num_words)
+        m_words.pop();
+    m_lines.resize(cp.num_lines);
+    m_lines.back().truncate(cp.last_line_words);
+
+    // both are sorted by name
+    auto state = cp.spans.begin();
+    for (auto it = m_spans.begin(); it != m_spans.end(); ) {
+        if (state == cp.spans.end() || it->first != state->name) {
+            it = m_spans.erase(it);  // begun after the checkpoint
+            continue;
+        }
+        it->second.truncate(state->num_parts, state->last_part_words, state->open);
+        ++state;
+        ++it;
+    }
+    assert(state == cp.spans.end());
 }
 
 
@@ -310,9 +399,10 @@ void Page::add_tab()
 }
 
 
-void Page::add_word(const std::string& string)
+void Page::add_word(std::string_view string)
 {
     m_words.emplace_back(*this, string);
+    ++m_num_words;
 
     // Add word to current line
     auto& line = m_lines.back();
@@ -334,7 +424,7 @@ ViewportUnits Page::space_width()
     auto font_size = target().size_to_framebuffer(m_style.size());
     font->set_size(font_size.as<unsigned int>());
     auto* glyph = font->get_glyph(' ');
-    return target().size_to_viewport(FramebufferPixels{glyph->advance()});
+    return target().size_to_viewport(FramebufferPixels{glyph->advance() * font->glyph_scale()});
 }
 
 
@@ -401,6 +491,42 @@ void Page::foreach_line(const std::function<void(const Line& line)>& cb) const
 }
 
 
+std::pair<size_t, size_t> Page::find_lines(ViewportUnits top, ViewportUnits bottom) const
+{
+    // Only the last line may be empty (see finish_line), it has no bbox
+    auto end = m_lines.end();
+    if (m_lines.back().is_empty())
+        --end;
+    auto first = std::partition_point(m_lines.begin(), end,
+            [top](const Line& line) { return line.bbox().bottom() <= top; });
+    auto last = std::partition_point(first, end,
+            [bottom](const Line& line) { return line.bbox().top() < bottom; });
+    return {first - m_lines.begin(), last - m_lines.begin()};
+}
+
+
+void Page::foreach_word(size_t first_line, size_t last_line,
+                        const std::function<void(Word& word)>& cb)
+{
+    if (!cb) return;
+    for (auto i = first_line; i != last_line; ++i) {
+        for (Word* word : m_lines[i].words())
+            cb(*word);
+    }
+}
+
+
+void Page::foreach_word(size_t first_line, size_t last_line,
+                        const std::function<void(const Word& word)>& cb) const
+{
+    if (!cb) return;
+    for (auto i = first_line; i != last_line; ++i) {
+        for (const Word* word : m_lines[i].words())
+            cb(*word);
+    }
+}
+
+
 void Page::foreach_span(const std::function<void(const Span& span)>& cb) const
 {
     if (!cb) return;
@@ -23,8 +23,11 @@
 #include <xci/core/container/ChunkedStack.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
+#include <map>
+#include <utility>
 
 namespace xci::graphics { class View; }
 namespace xci::text { class Font; }
@@ -52,25 +55,64 @@ enum class Alignment {
 };
 
 
+// Glyph sprites grouped by font texture (page) and color.
+// Each group is a single vertex stream, drawn with one draw call.
+// Used for the whole page in batched mode, or for single Word.
+class GlyphBatches {
+public:
+    void clear() { m_keys.clear(); m_sprites.clear(); }
+    bool empty() const { return m_keys.empty(); }
+    size_t size() const { return m_keys.size(); }
+
+    // Find or create the batch for a texture and color.
+    // The shader is used only for new batch, it's given by the texture (font).
+    graphics::Sprites& get(graphics::Renderer& renderer,
+                           graphics::Texture& texture, const graphics::Color& color,
+                           graphics::ShaderId shader = graphics::ShaderId::Sprite);
+
+    // Upload all batches (after all words were added)
+    void update();
+
+    void draw(graphics::View& target, const ViewportCoords& pos) const;
+
+private:
+    struct Key {
+        graphics::Texture* texture;
+        graphics::Color color;
+        graphics::Sprites* sprites;  // points into m_sprites
+    };
+    std::vector<Key> m_keys;
+    size_t m_last = 0;  // consecutive words usually share the batch
+    mutable core::ChunkedStack<graphics::Sprites> m_sprites;
+};
+
+
 class Word {
 public:
-    Word(Page& page, std::string string);
+    // The string is not copied, it must outlive the word
+    // (Layout keeps it in the string pool of its ElementStream).
+    Word(Page& page, std::string_view string);
 
+    std::string_view string() const { return m_string; }
     const ViewportRect& bbox() const { return m_bbox; }
     ViewportUnits baseline() const { return m_baseline; }
     Style& style() { return m_style; }
+    const Style& style() const { return m_style; }
 
-    void update(const graphics::View& target);
+    // Recreate graphics objects for the word.
+    // With `batches`, the glyph quads are added to the page-wide batches
+    // instead of word's own sprites.
+    void update(const graphics::View& target, GlyphBatches* batches = nullptr);
     void draw(graphics::View& target, const ViewportCoords& pos) const;
 
 private:
-    std::string m_string;
+    std::string_view m_string;
     Style m_style;
     ViewportCoords m_pos;  // relative to page origin (top-left corner)
     ViewportRect m_bbox;
     ViewportUnits m_baseline = 0;  // relative to bbox top
 
-    mutable std::optional<graphics::Sprites> m_sprites;
+    GlyphBatches m_sprites;
     mutable core::ChunkedStack<graphics::Shape> m_debug_shapes;
 };
 
@@ -79,6 +121,10 @@ class Line {
 public:
     void add_word(Word& word) { m_words.push_back(&word); m_bbox_valid = false; }
     std::vector<Word*>& words() { return m_words; }
+    const std::vector<Word*>& words() const { return m_words; }
+
+    // Keep only first `num_words` words
+    void truncate(size_t num_words) { m_words.resize(num_words); m_bbox_valid = false; }
 
     bool is_empty() const { return m_words.empty(); }
 
@@ -112,6 +158,9 @@ public:
     void close() { m_open = false; }
     bool is_open() const { return m_open; }
 
+    // Revert to previous state: `num_parts` parts, the last one with `last_part_words`
+    void truncate(size_t num_parts, size_t last_part_words, bool open);
+
     // Restyle all words in span.
     // The callback will be run on each word in the span,
     // with reference to the word's current style to be adjusted.
@@ -135,6 +184,32 @@ public:
     // Reset all state
     void clear();
 
+    // Running state and size of content at some point of typesetting.
+    // Restoring it drops all content added after the checkpoint,
+    // so the typesetting can continue from there (see Layout::typeset).
+    struct Checkpoint {
+        ViewportCoords pen;
+        ViewportSize pen_offset;
+        Style style;
+        ViewportUnits width = 0;
+        Alignment alignment = Alignment::Left;
+        std::vector<ViewportUnits> tab_stops;
+        size_t num_words = 0;
+        size_t num_lines = 0;
+        size_t last_line_words = 0;
+        struct SpanState {
+            std::string name;
+            size_t num_parts;
+            size_t last_part_words;
+            bool open;
+        };
+        std::vector<SpanState> spans;  // sorted by name
+    };
+    Checkpoint checkpoint() const;
+    void restore(const Checkpoint& cp);
+
+    size_t line_count() const { return m_lines.size(); }
+
     // ------------------------------------------------------------------------
 
     // Text style
@@ -181,8 +256,9 @@ public:
     // Put horizontal tab onto line. It takes all space up to next tabstop.
     void add_tab();
 
-    // Add word bbox to line bbox
-    void add_word(const std::string& string);
+    // Add word bbox to line bbox.
+    // The string must outlive the page, see Word.
+    void add_word(std::string_view string);
 
     // ------------------------------------------------------------------------
     // Spans allow to name part of the text and change its attributes later
@@ -202,6 +278,17 @@ public:
     void foreach_word(const std::function<void(Word& word)>& cb);
     void foreach_word(const std::function<void(const Word& word)>& cb) const;
     void foreach_line(const std::function<void(const Line& line)>& cb) const;
+
+    // Lines which intersect vertical range [top, bottom), as [first, last) indexes.
+    // The lines are stacked from top to bottom, their bboxes serve as an index
+    // for binary search.
+    std::pair<size_t, size_t> find_lines(ViewportUnits top, ViewportUnits bottom) const;
+
+    // Words in lines [first_line, last_line)
+    void foreach_word(size_t first_line, size_t last_line,
+                      const std::function<void(Word& word)>& cb);
+    void foreach_word(size_t first_line, size_t last_line,
+                      const std::function<void(const Word& word)>& cb) const;
     void foreach_span(const std::function<void(const Span& span)>& cb) const;
 
 private:
@@ -222,6 +309,7 @@ private:
 
     // page content
     core::ChunkedStack<Word> m_words;
+    size_t m_num_words = 0;  // ChunkedStack::size() is not O(1)
     std::vector<Line> m_lines;
     std::map<std::string, Span> m_spans;
 };
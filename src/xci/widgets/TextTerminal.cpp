@@ -522,7 +522,6 @@ void terminal::Caret::draw(View& view, const ViewportCoords& pos)
 
 TextTerminal::TextTerminal(Theme& theme)
         : Widget(theme),
-          m_sprites(theme.renderer(), theme.font().texture(), Color(7)),
           m_boxes(theme.renderer(), Color(0)),
           m_caret(theme.renderer()),
           m_frame(theme.renderer(), Color::Transparent(), Color::Transparent())
@@ -757,10 +756,15 @@ void TextTerminal::update(View& view, State state)
 
     auto& font = theme().font();
     font.set_size(m_font_size.as<unsigned>());
+    font.begin_frame(view.window()->frame_number());
 
     size_t expected_num_cells = m_cells.x * m_cells.y / 2;
-    m_sprites.clear();
-    m_sprites.reserve(expected_num_cells);
+    if (m_sprites.empty())
+        m_sprites.push_back(std::make_unique<ColoredSprites>(theme().renderer(), font.texture(0),
+                Color::White(), font.colored_sprite_shader()));
+    for (auto& sprites : m_sprites)
+        sprites->clear();
+    m_sprites[0]->reserve(expected_num_cells);
     m_boxes.clear();
     m_boxes.reserve(0, expected_num_cells, 0);
 
@@ -782,7 +786,6 @@ void TextTerminal::update(View& view, State state)
 
         // Reset attributes
         font.set_style(text::FontStyle::Regular);
-        m_sprites.set_color(Color(7));
         m_boxes.set_fill_color(Color(0));
         auto ascender = font.ascender();
 
@@ -790,8 +793,8 @@ void TextTerminal::update(View& view, State state)
         public:
             // capture by ref
             LineRenderer(ViewportCoords& pen, size_t& column,
-                    graphics::ColoredSprites& sprites, graphics::Shape& boxes,
-                    text::Font& font, float& ascender,
+                    std::vector<std::unique_ptr<graphics::ColoredSprites>>& sprites,
+                    graphics::Shape& boxes, text::Font& font, float& ascender,
                     const ViewportSize& cell_size, View& view)
                     : pen(pen), column(column), sprites(sprites), boxes(boxes),
                       font(font), ascender(ascender),
@@ -807,7 +810,7 @@ void TextTerminal::update(View& view, State state)
                 //(void) mode; // TODO
             }
             void set_fg_color(Color fg) override {
-                sprites.set_color(fg);
+                fg_color = fg;
             }
             void set_bg_color(Color bg) override {
                 boxes.set_fill_color(bg);
@@ -822,10 +825,13 @@ void TextTerminal::update(View& view, State state)
                 if (glyph == nullptr)
                     glyph = font.get_glyph(' ');
 
-                auto bearing = view.size_to_viewport(FramebufferSize{glyph->bearing()});
+                const float scale = font.glyph_scale();
+                auto bearing = view.size_to_viewport(FramebufferSize{Vec2f(glyph->bearing()) * scale});
                 auto ascender_vp = view.size_to_viewport(FramebufferPixels{ascender});
-                auto glyph_size = view.size_to_viewport(FramebufferSize{glyph->size()});
-                sprites.add_sprite({
+                auto glyph_size = view.size_to_viewport(FramebufferSize{Vec2f(glyph->size()) * scale});
+                auto& page_sprites = get_sprites(glyph->page());
+                page_sprites.set_color(fg_color);
+                page_sprites.add_sprite({
                         pen.x + bearing.x,
                         pen.y + (ascender_vp - bearing.y),
                         glyph_size.x,
@@ -839,9 +845,20 @@ void TextTerminal::update(View& view, State state)
             }
 
         private:
+            // glyphs from each font texture page go into separate sprites
+            graphics::ColoredSprites& get_sprites(unsigned page) {
+                while (sprites.size() <= page) {
+                    sprites.push_back(std::make_unique<ColoredSprites>(
+                            view.window()->renderer(), font.texture(unsigned(sprites.size())),
+                            Color::White(), font.colored_sprite_shader()));
+                }
+                return *sprites[page];
+            }
+
             ViewportCoords& pen;
             size_t& column;
-            graphics::ColoredSprites& sprites;
+            Color fg_color {7};
+            std::vector<std::unique_ptr<graphics::ColoredSprites>>& sprites;
             graphics::Shape& boxes;
             text::Font& font;
             float& ascender;
@@ -872,7 +889,8 @@ void TextTerminal::update(View& view, State state)
         pen.y += m_cell_size.y;
     }
     m_boxes.update();
-    m_sprites.update();
+    for (auto& sprites : m_sprites)
+        sprites->update();
 
     m_caret.update(view, {m_cell_size.x * m_cursor.x, m_cell_size.y * m_cursor.y,
                           m_cell_size.x, m_cell_size.y});
@@ -892,7 +910,8 @@ void TextTerminal::update(View& view, State state)
 void TextTerminal::draw(View& view)
 {
     m_boxes.draw(view, position());
-    m_sprites.draw(view, position());
+    for (auto& sprites : m_sprites)
+        sprites->draw(view, position());
     m_caret.draw(view, position());
 
     if (m_bell_time > 0ns) {
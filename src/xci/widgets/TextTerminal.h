@@ -26,6 +26,7 @@
 #include <xci/core/geometry.h>
 #include <string_view>
 #include <vector>
+#include <memory>
 #include <chrono>
 #include <bitset>
 
@@ -410,7 +411,7 @@ private:
     terminal::Attributes m_attrs;  // current attributes
     std::chrono::nanoseconds m_bell_time {0};
 
-    graphics::ColoredSprites m_sprites;
+    std::vector<std::unique_ptr<graphics::ColoredSprites>> m_sprites;  // one per font texture page
     graphics::Shape m_boxes;
     terminal::Caret m_caret;  // visual indicator of cursor position
     graphics::Shape m_frame;  // for visual bell
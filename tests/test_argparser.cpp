@@ -8,6 +8,8 @@
 
 #include <xci/core/ArgParser.h>
 #include <array>
+#include <filesystem>
+#include <fstream>
 
 using namespace xci::core;
 using namespace xci::core::argparser;
@@ -407,3 +409,103 @@ TEST_CASE( "Gather rest of the args", "[ArgParser]" )
         CHECK(rest[1] == "bb");
     }
 }
+
+
+TEST_CASE( "Response file", "[ArgParser]" )
+{
+    bool verbose = false;
+    std::vector<const char*> files;
+    std::vector<std::string_view> rest;
+    ArgParser ap {
+            Option("-v, --verbose", "Enable verbosity", verbose),
+            Option("FILE...", "Input files", files),
+            Option("-- REST ...", "Passthrough args", rest),
+    };
+    ap.enable_response_files();
+
+    const auto path = (std::filesystem::temp_directory_path() / "xci_test_argparser.rsp").string();
+    const std::string arg = "@" + path;
+    auto write_file = [&path](const char* content) {
+        std::ofstream f(path, std::ios::binary);
+        f << content;
+    };
+
+    SECTION("arguments one per line") {
+        write_file("f1\n-v\r\n\nfile with spaces\nf3");  // no newline at end
+        const char* args[] = {"f0", arg.c_str(), "f4", nullptr};
+        ap.parse_args(args);
+        CHECK(verbose);
+        REQUIRE(files.size() == 5);
+        CHECK(files[0] == std::string_view("f0"));
+        CHECK(files[1] == std::string_view("f1"));
+        CHECK(files[2] == std::string_view("file with spaces"));
+        CHECK(files[3] == std::string_view("f3"));
+        CHECK(files[4] == std::string_view("f4"));
+    }
+
+    SECTION("remainder in response file continues in argv") {
+        write_file("f1\n--\n-v\naa\n");
+        const char* args[] = {arg.c_str(), "bb", nullptr};
+        CHECK(ap.parse_args(args) == ArgParser::Stop);
+        CHECK(!verbose);
+        REQUIRE(files.size() == 1);
+        CHECK(rest == std::vector<std::string_view>{"-v", "aa", "bb"});
+    }
+
+    SECTION("self-referencing file") {
+        write_file(("f1\n" + arg + "\n").c_str());
+        const char* args[] = {arg.c_str(), nullptr};
+        CHECK_THROWS_WITH(ap.parse_args(args), "Response file includes itself: " + path);
+    }
+
+    SECTION("nesting too deep") {
+        // chain of files, each including the next one
+        const auto depth = ArgParser::max_response_file_depth + 1;
+        std::vector<std::string> chain;
+        for (unsigned i = 0; i != depth; ++i)
+            chain.push_back(path + std::to_string(i));
+        for (unsigned i = 0; i != depth; ++i) {
+            std::ofstream f(chain[i], std::ios::binary);
+            if (i + 1 != depth)
+                f << '@' << chain[i + 1] << '\n';
+        }
+        const std::string chain_arg = "@" + chain[0];
+        const char* args[] = {chain_arg.c_str(), nullptr};
+        CHECK_THROWS_WITH(ap.parse_args(args), "Response files nested too deep: " + chain.back());
+        for (const auto& p : chain)
+            std::filesystem::remove(p);
+    }
+
+    SECTION("missing file") {
+        std::filesystem::remove(path);
+        const char* args[] = {arg.c_str(), nullptr};
+        CHECK_THROWS_AS(ap.parse_args(args), BadArgument);
+    }
+
+    std::filesystem::remove(path);
+}
+
+
+TEST_CASE( "Remainder in bulk", "[ArgParser]" )
+{
+    SECTION("pointers are appended at once") {
+        std::vector<const char*> rest;
+        ArgParser ap { Option("-- ...", "Passthrough args", rest) };
+        const char* args[] = {"--", "a", "b", "c", nullptr};
+        CHECK(ap.parse_args(args) == ArgParser::Stop);
+        REQUIRE(rest.size() == 3);
+        CHECK(rest[0] == args[1]);
+        CHECK(rest[2] == args[3]);
+    }
+
+    SECTION("values are parsed") {
+        std::vector<int> numbers;
+        ArgParser ap { Option("-- NUMBER ...", "Numbers", numbers) };
+        const char* args[] = {"--", "1", "2", "3", nullptr};
+        CHECK(ap.parse_args(args) == ArgParser::Stop);
+        CHECK(numbers == std::vector<int>{1, 2, 3});
+
+        const char* bad_args[] = {"--", "1", "x", nullptr};
+        CHECK_THROWS_AS(ap.parse_args(bad_args), BadArgument);
+    }
+}
@@ -22,6 +22,7 @@ TEST_CASE( "LEB128", "[coding]" )
         auto* iter = buffer;
         encode_leb128(iter, v_in);
         CHECK(iter - buffer == 1);  // encoded in 1B
+        CHECK(leb128_length(v_in) == 1);
         CHECK(unsigned(buffer[0]) < 0x80);    // high-order bit not set
         iter = buffer;
         auto v_out = decode_leb128<uint32_t>(iter);
@@ -39,6 +40,7 @@ TEST_CASE( "LEB128", "[coding]" )
         encode_leb128(iter, v_in);
         auto b_in = iter - buffer;
         CHECK(b_in == (v_bits + 6) / 7);
+        CHECK(leb128_length(v_in) == size_t(b_in));
         CHECK(unsigned(buffer[0]) >= 0x80);    // high-order bit is set
         iter = buffer;
         auto v_out = decode_leb128<uint64_t>(iter);
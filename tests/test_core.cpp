@@ -11,9 +11,14 @@
 
 #ifndef _WIN32
 #include <xci/core/FileTree.h>
+#include <unistd.h>
 #endif
 
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
 #include <cstdio>
 #include <sys/stat.h>
 
@@ -51,6 +56,143 @@ TEST_CASE( "Format char type", "[log]" )
 }
 
 
+struct FormatCounter { int& count; };
+template <> struct fmt::formatter<FormatCounter> : formatter<int> {
+    template <typename FormatContext>
+    auto format(const FormatCounter& c, FormatContext& ctx) {
+        return formatter<int>::format(++c.count, ctx);
+    }
+};
+
+static std::string s_last_log_msg;
+
+TEST_CASE( "Log level filtering", "[log]" )
+{
+    auto& logger = Logger::default_instance();
+    logger.set_handler([](Logger::Level, std::string_view msg) { s_last_log_msg = msg; });
+    logger.set_level(Logger::Level::Info);
+
+    // message below level is not even formatted
+    int count = 0;
+    log::debug("count {}", FormatCounter{count});
+    CHECK(count == 0);
+    CHECK(s_last_log_msg.empty());
+
+    log::info("count {}", FormatCounter{count});
+    CHECK(count == 1);
+    CHECK(s_last_log_msg == "count 1");
+
+    logger.set_level(Logger::Level::Trace);
+    logger.set_handler(Logger::default_handler);
+}
+
+
+struct LoggingFormatter {};
+template <> struct fmt::formatter<LoggingFormatter> : formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const LoggingFormatter&, FormatContext& ctx) {
+        log::info("nested {}", 42);
+        return formatter<std::string_view>::format("outer", ctx);
+    }
+};
+
+static std::vector<std::string> s_log_msgs;
+
+TEST_CASE( "Nested logging", "[log]" )
+{
+    using namespace std::string_view_literals;
+    auto& logger = Logger::default_instance();
+    logger.set_handler([](Logger::Level, std::string_view msg) {
+        // log from the handler before using the message (same arg types)
+        if (msg == "outer done")
+            log::info("{} {}", "from"sv, "handler"sv);
+        s_log_msgs.emplace_back(msg);
+    });
+
+    log::info("{} {}", "outer"sv, "done"sv);
+    CHECK(s_log_msgs == std::vector<std::string>{"from handler", "outer done"});
+
+    // log from formatter of an argument
+    s_log_msgs.clear();
+    log::info("{} {}", LoggingFormatter{}, "done"sv);
+    CHECK(s_log_msgs == std::vector<std::string>{"nested 42", "from handler", "outer done"});
+
+    logger.set_handler(Logger::default_handler);
+}
+
+
+TEST_CASE( "AsyncLogSink", "[log]" )
+{
+    auto& logger = Logger::default_instance();
+    {
+        AsyncLogSink sink(logger, 256);
+        // message which can't fit into the buffer is dropped
+        log::info("{:300}", "long message");
+        CHECK(sink.dropped() == 1);
+        // other messages are delivered from the threads
+        std::thread t([] { log::info("async message from thread"); });
+        t.join();
+        log::info("async message");
+        sink.flush();
+        CHECK(sink.dropped() == 1);
+    }
+    // the handler falls back to synchronous logging when there is no sink
+    AsyncLogSink::handler(Logger::Level::Info, "sync message");
+}
+
+
+#ifndef _WIN32
+TEST_CASE( "AsyncLogSink destruction", "[log]" )
+{
+    // Threads keep logging while the sink is destroyed, no message is lost.
+    // Stderr is redirected to a file to count the messages.
+    auto& logger = Logger::default_instance();
+    logger.set_level(Logger::Level::Info);
+    constexpr int n_threads = 4;
+    constexpr int max_messages = 10000;  // per thread, fits into the buffer
+    std::atomic<size_t> total {0};
+    FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    const int saved_stderr = dup(STDERR_FILENO);
+    dup2(fileno(out), STDERR_FILENO);
+    {
+        auto sink = std::make_unique<AsyncLogSink>(logger, 1024 * 1024);
+        std::atomic<bool> destroyed {false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t != n_threads; ++t) {
+            threads.emplace_back([&destroyed, &total] {
+                for (int i = 0; i != max_messages && !destroyed; ++i) {
+                    log::info("destruction test {}", i);
+                    ++total;
+                    std::this_thread::yield();  // keep logging until the sink is destroyed
+                }
+            });
+        }
+        while (total < 1000)
+            std::this_thread::yield();
+        sink.reset();
+        destroyed = true;
+        for (auto& t : threads)
+            t.join();
+    }
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+
+    std::rewind(out);
+    std::string content;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), out)) != 0)
+        content.append(buf, n);
+    std::fclose(out);
+    size_t count = 0;
+    for (size_t pos = 0; (pos = content.find("destruction test ", pos)) != std::string::npos; ++pos)
+        ++count;
+    CHECK(count == total);
+}
+#endif
+
+
 TEST_CASE( "read_binary_file", "[file]" )
 {
     std::string filename = get_self_path();
@@ -117,6 +259,110 @@ TEST_CASE( "utf8_length", "[string]" )
 TEST_CASE( "to_utf32", "[string]" )
 {
     CHECK(to_utf32(UTF8("Červeňoučký 🦞")) == U"Červeňoučký 🦞");
+
+    // long strings, crossing SIMD blocks
+    std::string s;
+    std::u32string expected;
+    for (int i = 0; i != 20; ++i) {
+        s += UTF8("The quick brown fox jumps over the lazy dog. 河北梆子 🦞 ");
+        expected += U"The quick brown fox jumps over the lazy dog. 河北梆子 🦞 ";
+    }
+    CHECK(to_utf32(s) == expected);
+    CHECK(utf8_length(s) == expected.size());
+
+    // invalid input
+    CHECK(to_utf32(s + "\xff").empty());
+}
+
+
+TEST_CASE( "utf8_validate", "[string]" )
+{
+    CHECK(utf8_validate(""));
+    CHECK(utf8_validate(UTF8("Červeňoučký 🦞")));
+    CHECK(utf8_validate(std::string(100, 'a') + UTF8("河北梆子")));
+    CHECK(utf8_validate(UTF8("\u07FF \uFFFD \U0010FFFF")));
+    CHECK_FALSE(utf8_validate(std::string(100, 'a') + "\x80"));  // stray continuation byte
+    CHECK_FALSE(utf8_validate("\xc3"));  // truncated
+    CHECK_FALSE(utf8_validate("\xe6\xb2" "a"));  // truncated, followed by ASCII
+    CHECK_FALSE(utf8_validate("\xc0\xaf"));  // overlong
+    CHECK_FALSE(utf8_validate("\xe0\x80\xaf"));  // overlong
+    CHECK_FALSE(utf8_validate("\xed\xa0\x80"));  // surrogate U+D800
+    CHECK_FALSE(utf8_validate("\xf4\x90\x80\x80"));  // above U+10FFFF
+    CHECK_FALSE(utf8_validate("\xff"));
+}
+
+
+// Reference validator, straight from the definition of UTF-8
+static bool utf8_validate_ref(std::string_view str)
+{
+    for (size_t pos = 0; pos != str.size(); ) {
+        const auto c0 = (unsigned char) str[pos];
+        size_t len;
+        char32_t cp;
+        if (c0 < 0x80) { len = 1; cp = c0; }
+        else if ((c0 & 0xe0) == 0xc0) { len = 2; cp = c0 & 0x1f; }
+        else if ((c0 & 0xf0) == 0xe0) { len = 3; cp = c0 & 0x0f; }
+        else if ((c0 & 0xf8) == 0xf0) { len = 4; cp = c0 & 0x07; }
+        else return false;
+        if (pos + len > str.size())
+            return false;
+        for (size_t i = 1; i != len; ++i) {
+            const auto c = (unsigned char) str[pos + i];
+            if ((c & 0xc0) != 0x80)
+                return false;
+            cp = (cp << 6) | (c & 0x3f);
+        }
+        const char32_t min_cp[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (cp < min_cp[len] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+            return false;
+        pos += len;
+    }
+    return true;
+}
+
+
+TEST_CASE( "utf8_validate sequences", "[string]" )
+{
+    // All sequences of up to 3 bytes (and 4-byte with valid continuations),
+    // placed across the boundary of 16-byte blocks and before/after
+    // a 64-byte ASCII run
+    size_t mismatches = 0;
+    auto check = [&mismatches](const std::string& seq) {
+        for (size_t offset : {0, 13, 14, 15, 30, 62, 127}) {
+            std::string s(offset, 'a');
+            s += seq;
+            if (utf8_validate(s) != utf8_validate_ref(s))
+                ++mismatches;
+            s += std::string(70, 'b');
+            if (utf8_validate(s) != utf8_validate_ref(s))
+                ++mismatches;
+        }
+    };
+    for (unsigned c0 = 0x80; c0 != 0x100; ++c0) {
+        check({char(c0)});
+        for (unsigned c1 = 0; c1 != 0x100; ++c1) {
+            check({char(c0), char(c1)});
+            if (c0 < 0xe0 || c0 > 0xf4 || (c1 & 0xc0) != 0x80)
+                continue;
+            for (unsigned c2 = 0; c2 != 0x100; ++c2)
+                check({char(c0), char(c1), char(c2)});
+            for (unsigned c3 : {0x00, 0x7f, 0x80, 0xbf, 0xc0, 0xff})
+                check({char(c0), char(c1), char(0x80), char(c3)});
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // Long valid text, then an error in each position
+    std::string text;
+    for (int i = 0; i != 8; ++i)
+        text += UTF8("Příliš žluťoučký kůň 河北梆子 🦞 ");
+    REQUIRE(utf8_validate(text));
+    for (size_t pos = 0; pos != text.size(); ++pos) {
+        std::string bad = text;
+        bad[pos] = '\xff';
+        CHECK_FALSE(utf8_validate(bad));
+        CHECK_FALSE(utf8_validate(text.substr(0, pos) + "\xf0\x9f"));  // truncated
+    }
 }
 
 
@@ -218,6 +464,43 @@ TEST_CASE( "rsplit", "[string]" )
 }
 
 
+TEST_CASE( "split_view", "[string]" )
+{
+    using l = std::vector<std::string_view>;
+    auto to_vector = [](SplitView&& view) { return l(view.begin(), view.end()); };
+    CHECK(to_vector(split_view("one\ntwo\nthree", '\n')) == l{"one", "two", "three"});
+    CHECK(to_vector(split_view("\none\ntwo\n\nthree\n", '\n')) == l{"", "one", "two", "", "three", ""});
+    CHECK(to_vector(split_view("one, two, three", ',', 1)) == l{"one", " two, three"});
+    CHECK(to_vector(split_view("", ',')) == l{""});
+    CHECK(to_vector(split_view("a,b;c d", ",; ")) == l{"a", "b", "c", "d"});
+    CHECK(to_vector(split_view("a,b;c d", ",; ", 2)) == l{"a", "b", "c d"});
+
+    // long input, crossing SIMD blocks
+    std::string long_str(100, 'x');
+    long_str[20] = ';';
+    long_str[70] = ',';
+    CHECK(to_vector(split_view(long_str, ",;")) ==
+          l{long_str.substr(0, 20), long_str.substr(21, 49), long_str.substr(71)});
+}
+
+
+TEST_CASE( "CharSet", "[string]" )
+{
+    CharSet set("/\\:");
+    CHECK(set.contains('/'));
+    CHECK(set.contains(':'));
+    CHECK_FALSE(set.contains('a'));
+    CHECK(set.find_in("abc") == std::string_view::npos);
+    CHECK(set.find_in("abc:def/") == 3);
+    CHECK(set.find_in("abc:def/", 4) == 7);
+    CHECK(set.find_in(std::string(40, 'a') + "\\") == 40);
+    // more chars than the SIMD search handles
+    CharSet ws(whitespace_chars);
+    CHECK(ws.find_in(std::string(40, 'a') + "\v") == 40);
+    CHECK(CharSet("").find_in("abc") == std::string_view::npos);
+}
+
+
 TEST_CASE( "remove_prefix", "[string]" )
 {
     std::string s;
@@ -274,6 +557,19 @@ TEST_CASE( "rstrip", "[string]" )
 }
 
 
+TEST_CASE( "strip_view", "[string]" )
+{
+    const std::string s = "  /ab/cdef/ \n";
+    CHECK(strip_view(s) == "/ab/cdef/");
+    CHECK(lstrip_view(s) == "/ab/cdef/ \n");
+    CHECK(rstrip_view(s) == "  /ab/cdef/");
+    CHECK(strip_view(strip_view(s), '/') == "ab/cdef");
+    CHECK(rstrip_view("///", '/').empty());
+    // the views point to the original string
+    CHECK(strip_view(s).data() == s.data() + 2);
+}
+
+
 TEST_CASE( "align_to", "[memory]" )
 {
     CHECK(align_to(0, 4) == 0);
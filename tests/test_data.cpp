@@ -102,6 +102,66 @@ TEST_CASE( "Node tree: dump/save/load", "[data]" )
 }
 
 
+struct SchemaNode
+{
+    std::string name;
+    Option option = Option(-1);
+    std::vector<SchemaNode> child;
+    double f = 0.0;
+
+    XCI_ARCHIVE_SCHEMA(SchemaNode, name, option, child, f)
+};
+
+
+TEST_CASE( "Schema save/load", "[data]" )
+{
+    // Same layout as Node, but serialized by compile-time schema
+    SchemaNode root{"root", Option::Zero, {
+        SchemaNode{"child1", Option::One, {}, 1.1},
+        SchemaNode{"child2", Option::Two, {}, 2.2},
+    }, 0.0};
+    Node node{"root", Option::Zero, {
+        Node{"child1", Option::One, {}, 1.1},
+        Node{"child2", Option::Two, {}, 2.2},
+    }, 0.0};
+
+    // dump - names are available
+    std::ostringstream dump_schema(""), dump_node("");
+    {
+        Dumper dumper(dump_schema);
+        dumper(root);
+    }
+    {
+        Dumper dumper(dump_node);
+        dumper(node);
+    }
+    CHECK(dump_schema.str() == dump_node.str());
+
+    // save - binary output is the same as with serialize()
+    std::stringstream s(""), s_node("");
+    {
+        BinaryWriter writer(s);
+        writer(root);
+    }
+    {
+        BinaryWriter writer(s_node);
+        writer(node);
+    }
+    CHECK(s.str() == s_node.str());
+
+    // load
+    SchemaNode loaded;
+    BinaryReader reader(s);
+    reader(loaded);
+    reader.finish_and_check();
+    CHECK(loaded.name == "root");
+    REQUIRE(loaded.child.size() == 2);
+    CHECK(loaded.child[1].name == "child2");
+    CHECK(loaded.child[1].option == Option::Two);
+    CHECK(loaded.child[1].f == 2.2);
+}
+
+
 struct PlainRecord {
     int id;
     std::string name;
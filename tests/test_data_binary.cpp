@@ -8,9 +8,14 @@
 
 #include <xci/data/BinaryWriter.h>
 #include <xci/data/BinaryReader.h>
+#include <xci/data/BinaryBufferReader.h>
+#include <xci/data/Crc32.h>
 
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <vector>
+#include <random>
 
 using namespace xci::data;
 
@@ -141,13 +146,117 @@ TEST_CASE( "BinaryWriter", "[data]" )
         Crc32 crc;
         expected.append(1, '\x41');
         crc.feed(expected.data(), expected.size());
-        expected.append((char*)&crc, sizeof(crc));
+        expected.append((const char*)crc.data(), crc.size());
 
         CHECK(buf.str() == expected);
     }
 }
 
 
+struct NestedRecord {
+    std::vector<MasterRecord> records;
+    std::string text;
+
+    template <class Archive>
+    void serialize(Archive& ar) {
+        ar(records, text);
+    }
+};
+
+
+TEST_CASE( "BinaryWriter single pass", "[data]" )
+{
+    const bool crc32 = GENERATE(false, true);
+    std::stringstream buffered("");
+    std::stringstream single_pass("");
+
+    SECTION( "empty archive" ) {
+        { BinaryWriter writer(buffered, crc32); }
+        { BinaryWriter writer(single_pass, crc32); writer.write_single_pass(); }
+        CHECK(single_pass.str() == buffered.str());
+    }
+
+    SECTION( "nested groups" ) {
+        NestedRecord rec;
+        rec.records.resize(1000);
+        for (int32_t i = 0; i != 1000; ++i)
+            rec.records[i].rec1.id = i;
+        rec.text = std::string(3 * BinaryWriter::chunk_size / 2, 'x');  // larger than chunk buffer
+        uint32_t x = 123;
+        {
+            BinaryWriter writer(buffered, crc32);
+            writer(rec, x);
+        }
+        {
+            BinaryWriter writer(single_pass, crc32);
+            writer.write_single_pass(rec, x);
+        }
+        CHECK(single_pass.str().size() > BinaryWriter::chunk_size);
+        CHECK(single_pass.str() == buffered.str());
+
+        NestedRecord rec_read;
+        uint32_t x_read = 0;
+        BinaryReader reader(single_pass);
+        reader(rec_read, x_read);
+        reader.finish_and_check();
+        CHECK(rec_read.records.size() == 1000);
+        CHECK(rec_read.records.back().rec1.id == 999);
+        CHECK(rec_read.text == rec.text);
+        CHECK(x_read == x);
+    }
+}
+
+
+TEST_CASE( "BinaryWriter streaming", "[data]" )
+{
+    std::stringstream log("");
+    BinaryWriter writer(log);
+    MasterRecord rec;
+    rec.rec1.id = 0;
+    writer.write_record(rec);
+#if BYTE_ORDER == LITTLE_ENDIAN
+    CHECK(log.str().substr(0, 5) == std::string("\xCB\xDF\x30\x81\x00", 5));  // UnknownSize, SIZE=0
+#endif
+
+    BinaryReader reader(log);
+    CHECK(reader.is_stream());
+    MasterRecord rec_read;
+    CHECK(reader.read_record(rec_read));
+    CHECK(rec_read.rec1.id == 0);
+    CHECK_FALSE(reader.read_record(rec_read));
+
+    // tail the stream - records are readable as soon as they are written
+    for (int32_t i = 1; i != 100; ++i) {
+        rec.rec1.id = i;
+        writer.write_record(rec);
+    }
+    for (int32_t i = 1; i != 100; ++i) {
+        REQUIRE(reader.read_record(rec_read));
+        CHECK(rec_read.rec1.id == i);
+        CHECK(rec_read.rec2.flag);
+    }
+    CHECK_FALSE(reader.read_record(rec_read));
+
+    // incomplete record is not consumed
+    const std::string complete = log.str();
+    rec.rec1.id = 1000;
+    writer.write_record(rec);
+    const std::string last = log.str().substr(complete.size());
+    std::stringstream tail("");
+    tail.write(complete.data(), complete.size());
+    tail.write(last.data(), 3);
+    BinaryReader tail_reader(tail);
+    for (int32_t i = 0; i != 100; ++i)
+        REQUIRE(tail_reader.read_record(rec_read));
+    CHECK_FALSE(tail_reader.read_record(rec_read));
+    CHECK_FALSE(tail_reader.read_record(rec_read));
+    tail.write(last.data() + 3, last.size() - 3);
+    CHECK(tail_reader.read_record(rec_read));
+    CHECK(rec_read.rec1.id == 1000);
+    CHECK_FALSE(tail_reader.read_record(rec_read));
+}
+
+
 TEST_CASE( "BinaryReader", "[data]" )
 {
     std::stringstream buf("");
@@ -269,7 +378,7 @@ TEST_CASE( "BinaryReader", "[data]" )
 
         Crc32 crc;
         crc.feed(input.data(), input.size());
-        input.append((char*)&crc, sizeof(crc));
+        input.append((const char*)crc.data(), crc.size());
 
         buf.str(input);
 
@@ -291,3 +400,309 @@ TEST_CASE( "BinaryReader", "[data]" )
         CHECK(buf);
     }
 }
+
+
+TEST_CASE( "BinaryBufferReader", "[data]" )
+{
+    std::stringstream buf("");
+    const bool crc32 = GENERATE(false, true);
+
+    MasterRecord rec;
+    rec.rec1.id = 111;
+    rec.rec2.id = -222;
+    std::string str = "hello";
+    std::string_view sv = "zero-copy";
+    const std::byte blob_data[] {std::byte(1), std::byte(2), std::byte(3)};
+    std::span<const std::byte> blob = blob_data;
+    {
+        BinaryWriter writer(buf, crc32);
+        writer(rec, str, sv, blob);
+    }
+    const std::string data = buf.str();
+    const std::span<const std::byte> input {(const std::byte*) data.data(), data.size()};
+
+    SECTION( "read" ) {
+        MasterRecord rec_read {{0, false}, {0, false}};
+        std::string str_read;
+        std::string_view sv_read;
+        std::span<const std::byte> blob_read;
+        BinaryBufferReader reader(input);
+        reader(rec_read, str_read, sv_read, blob_read);
+        reader.finish_and_check();
+        CHECK(reader.position() == data.size());
+        CHECK(rec_read.rec1.id == 111);
+        CHECK(!rec_read.rec1.flag);
+        CHECK(rec_read.rec2.id == -222);
+        CHECK(rec_read.rec2.flag);
+        CHECK(str_read == str);
+        CHECK(sv_read == sv);
+        CHECK(sv_read.data() >= data.data());  // points into the buffer
+        CHECK(sv_read.data() < data.data() + data.size());
+        REQUIRE(blob_read.size() == 3);
+        CHECK(blob_read[2] == std::byte(3));
+    }
+
+    SECTION( "skip unknown" ) {
+        // only read the last field
+        std::span<const std::byte> blob_read;
+        BinaryBufferReader reader(input);
+        reader(ArchiveField{3, blob_read});
+        reader.finish_and_check();
+        CHECK(blob_read.size() == 3);
+    }
+
+    SECTION( "truncated" ) {
+        // content size in header doesn't match the buffer
+        CHECK_THROWS_AS(BinaryBufferReader(input.first(input.size() / 2)), ArchiveUnexpectedEnd);
+    }
+
+    SECTION( "bad checksum" ) {
+        if (!crc32)
+            return;
+        std::string corrupted = data;
+        corrupted[10] ^= 1;
+        BinaryBufferReader reader(std::span{(const std::byte*) corrupted.data(), corrupted.size()});
+        MasterRecord rec_read;
+        reader(rec_read);
+        CHECK_THROWS_AS(reader.finish_and_check(), ArchiveBadChecksum);
+    }
+}
+
+
+TEST_CASE( "Chunk index", "[data]" )
+{
+    const bool crc32 = GENERATE(false, true);
+    const unsigned depth = GENERATE(1, 2, 3);
+    CAPTURE(crc32, depth);
+
+    NestedRecord rec;
+    rec.records.resize(100);
+    for (int32_t i = 0; i != 100; ++i) {
+        rec.records[i].rec1.id = i;
+        rec.records[i].rec2.id = -i;
+    }
+    rec.text = "text";
+    Record last {42, true};
+
+    std::stringstream buf("");
+    {
+        BinaryWriter writer(buf, crc32);
+        writer.enable_chunk_index(depth);
+        writer(rec, last);
+    }
+    const std::string data = buf.str();
+
+    // single pass writer produces the same index
+    {
+        std::stringstream buf_single("");
+        BinaryWriter writer(buf_single, crc32);
+        writer.enable_chunk_index(depth);
+        writer.write_single_pass(rec, last);
+        CHECK(buf_single.str() == data);
+    }
+
+    // sequential reading is not affected
+    {
+        NestedRecord rec_read;
+        Record last_read;
+        BinaryReader reader(buf);
+        reader(rec_read, last_read);
+        reader.finish_and_check();
+        CHECK(rec_read.records.size() == 100);
+        CHECK(last_read.id == 42);
+    }
+
+    BinaryBufferReader reader(std::span{(const std::byte*) data.data(), data.size()});
+    CHECK(reader.has_chunk_index());
+
+    // top-level objects
+    Record last_read;
+    CHECK(reader.read_at({{1}}, last_read));
+    CHECK(last_read.id == 42);
+    CHECK(last_read.flag);
+    CHECK(!reader.read_at({{2}}, last_read));
+    CHECK(!reader.read_at({{1, 1}}, last_read));
+
+    // items of vector
+    MasterRecord master;
+    CHECK(reader.read_at({{0}, {0, 57}}, master) == (depth >= 2));
+    if (depth >= 2) {
+        CHECK(master.rec1.id == 57);
+        CHECK(master.rec2.id == -57);
+    }
+    CHECK(!reader.read_at({{0}, {0, 100}}, master));
+
+    // members of the items
+    Record record;
+    CHECK(reader.read_at({{0}, {0, 99}, {1}}, record) == (depth >= 3));
+    if (depth >= 3)
+        CHECK(record.id == -99);
+
+    // sequential reading continues from the beginning
+    NestedRecord rec_read;
+    reader(rec_read, last_read);
+    reader.finish_and_check();
+    CHECK(rec_read.records.size() == 100);
+    CHECK(rec_read.text == "text");
+}
+
+
+TEST_CASE( "Crc32", "[data]" )
+{
+    const std::string check = "123456789";
+    CHECK(Crc32{}(check) == 0xCBF43926);
+    CHECK(Crc32{Crc32::Variant::Castagnoli}(check) == 0xE3069283);
+
+    // feeding by parts, crossing the 8-byte steps
+    std::string data(1000, '\0');
+    for (size_t i = 0; i != data.size(); ++i)
+        data[i] = char(i * 7 + 3);
+    const auto variant = GENERATE(Crc32::Variant::Ieee, Crc32::Variant::Castagnoli);
+    Crc32 whole(variant);
+    whole(data);
+    Crc32 parts(variant);
+    for (size_t pos = 0, n = 1; pos < data.size(); pos += n, n = n % 13 + 1)
+        parts.feed(data.data() + pos, std::min(n, data.size() - pos));
+    CHECK(parts.as_uint32() == whole.as_uint32());
+
+    SECTION( "CRC-32C software and hardware" ) {
+        // both implementations are tested, whatever is selected at runtime
+        using xci::data::detail::crc32c_sw;
+        using xci::data::detail::crc32c_hw;
+        const auto* check_data = (const std::byte*) check.data();
+        CHECK(~crc32c_sw(~0u, check_data, check.size()) == 0xE3069283);
+        CHECK(~crc32c_hw(~0u, check_data, check.size()) == 0xE3069283);
+
+        // random lengths and alignments
+        std::mt19937 rng(42);
+        std::vector<std::byte> buf(300);
+        for (auto& b : buf)
+            b = std::byte(rng());
+        size_t mismatches = 0;
+        for (size_t offset = 0; offset != 8; ++offset) {
+            for (size_t size = 0; size + offset <= buf.size(); size += 1 + rng() % 7) {
+                const uint32_t init = rng();
+                if (crc32c_sw(init, buf.data() + offset, size) != crc32c_hw(init, buf.data() + offset, size))
+                    ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    SECTION( "archive with CRC-32C" ) {
+        std::stringstream buf("");
+        MasterRecord rec;
+        rec.rec2.id = 7;
+        {
+            BinaryWriter writer(buf, Crc32::Variant::Castagnoli);
+            writer(rec);
+        }
+        const std::string out = buf.str();
+        CHECK((out[3] & 0b1100) == 0b1100);  // FLAGS: CRC32C
+
+        MasterRecord rec_read;
+        BinaryReader reader(buf);
+        reader(rec_read);
+        CHECK_NOTHROW(reader.finish_and_check());
+        CHECK(rec_read.rec2.id == 7);
+
+        std::string corrupted = out;
+        corrupted[10] ^= 1;  // rec1.id
+        BinaryBufferReader buf_reader(std::span{(const std::byte*) corrupted.data(), corrupted.size()});
+        buf_reader(rec_read);
+        CHECK_THROWS_AS(buf_reader.finish_and_check(), ArchiveBadChecksum);
+    }
+}
+
+
+TEST_CASE( "Bulk array", "[data]" )
+{
+    std::stringstream buf("");
+#if BYTE_ORDER == LITTLE_ENDIAN
+    std::string header = "\xCB\xDF\x30\x01";
+#else
+    std::string header = "\xCB\xDF\x30\x02";
+#endif
+
+    SECTION( "write" ) {
+        std::vector<uint32_t> v {1, 2, 3};
+        std::vector<uint32_t> empty;
+        {
+            BinaryWriter writer(buf);
+            writer(v, empty);
+        }
+        std::string expected = header;
+        expected.append("\x0f\xB0\x0d\x40", 4);  // SIZE=15, Array/0, LEN=13, SUBTYPE=UInt32
+        expected.append((const char*) v.data(), 12);
+        CHECK(buf.str() == expected);
+    }
+
+    SECTION( "write & read" ) {
+        std::vector<float> floats(10000);
+        for (size_t i = 0; i != floats.size(); ++i)
+            floats[i] = float(i) / 3;
+        std::vector<int64_t> ints {-1, 0, 1};
+        std::vector<uint8_t> bytes {7, 8};
+        {
+            BinaryWriter writer(buf, true);
+            writer(floats, ints, bytes);
+        }
+        CHECK(buf.str().size() < 10000 * 4 + 64);  // not 5 bytes per item
+
+        std::vector<float> floats_read;
+        std::vector<int64_t> ints_read;
+        std::vector<uint8_t> bytes_read;
+        BinaryReader reader(buf);
+        reader(floats_read, ints_read, bytes_read);
+        reader.finish_and_check();
+        CHECK(floats_read == floats);
+        CHECK(ints_read == ints);
+        CHECK(bytes_read == bytes);
+
+        const std::string data = buf.str();
+        BinaryBufferReader buf_reader(std::span{(const std::byte*) data.data(), data.size()});
+        floats_read.clear();
+        buf_reader(floats_read);
+        CHECK(floats_read == floats);
+    }
+
+    SECTION( "read items in separate chunks" ) {
+        // archives written before Array chunks were introduced
+        uint32_t v[] = {1, 2};
+        std::string input = header;
+        input.append("\x0a\x40", 2);  // SIZE=10, UInt32/0
+        input.append((const char*) &v[0], 4);
+        input.append("\x40", 1);
+        input.append((const char*) &v[1], 4);
+        buf.str(input);
+
+        std::vector<uint32_t> v_read;
+        BinaryReader reader(buf);
+        reader(v_read);
+        reader.finish_and_check();
+        CHECK(v_read == std::vector<uint32_t>{1, 2});
+    }
+
+    SECTION( "foreign byte order" ) {
+        std::string input = header;
+        input[3] ^= 3;  // swap LE/BE flag
+        auto foreign = [](uint32_t v) {
+            std::string s((const char*) &v, 4);
+            std::reverse(s.begin(), s.end());
+            return s;
+        };
+        input.append("\x10\x40", 2);  // SIZE=16, UInt32/0
+        input.append(foreign(1));
+        input.append("\xB1\x09\x40", 3);  // Array/1, LEN=9, SUBTYPE=UInt32
+        input.append(foreign(2));
+        input.append(foreign(3));
+        buf.str(input);
+
+        uint32_t x = 0;
+        std::vector<uint32_t> v_read;
+        BinaryReader reader(buf);
+        reader(x, v_read);
+        CHECK(x == 1);
+        CHECK(v_read == std::vector<uint32_t>{2, 3});
+    }
+}
@@ -7,6 +7,7 @@
 #include <catch2/catch.hpp>
 
 #include <xci/core/event.h>
+#include <xci/core/event/TimerWheel.h>
 #include <xci/core/dispatch.h>
 #include <xci/core/log.h>
 #include <xci/core/chrono.h>
@@ -16,6 +17,10 @@
 #include <thread>
 #include <fstream>
 #include <string>
+#include <future>
+#include <atomic>
+#include <set>
+#include <mutex>
 
 using namespace xci::core;
 using std::this_thread::sleep_for;
@@ -49,6 +54,131 @@ TEST_CASE( "IO events", "[core][event][IOWatch]" )
 #endif
 
 
+TEST_CASE( "EventLoopPool tasks", "[core][event][EventLoopPool]" )
+{
+    std::atomic<int> counter {0};
+    std::mutex mutex;
+    std::set<std::thread::id> thread_ids;
+    std::vector<int> order;
+    {
+        EventLoopPool pool(4, false);
+        REQUIRE(pool.size() == 4);
+        for (int i = 0; i != 1000; ++i) {
+            pool.post([&] {
+                ++counter;
+                std::lock_guard lock(mutex);
+                thread_ids.insert(std::this_thread::get_id());
+            });
+        }
+        // tasks posted to same loop are run in order
+        for (int i = 0; i != 100; ++i)
+            pool.post_to(pool.loop(1), [&order, i] { order.push_back(i); });
+        // the destructor runs all pending tasks
+    }
+    CHECK(counter == 1000);
+    CHECK(thread_ids.size() == 4);
+    REQUIRE(order.size() == 100);
+    CHECK(std::is_sorted(order.begin(), order.end()));
+}
+
+
+#ifndef _WIN32
+TEST_CASE( "EventLoopPool IO events", "[core][event][EventLoopPool]" )
+{
+    EventLoopPool pool(2, false);
+
+    int pipe_rw[2];
+    REQUIRE(::pipe(pipe_rw) == 0);
+
+    std::promise<std::thread::id> loop_thread;
+    pool.post_to(pool.loop_for_fd(pipe_rw[0]), [&loop_thread] {
+        loop_thread.set_value(std::this_thread::get_id());
+    });
+
+    std::promise<std::thread::id> event_thread;
+    auto io = std::make_unique<IOWatch>(pool.loop_for_fd(pipe_rw[0]), pipe_rw[0], IOWatch::Read,
+            [&event_thread](int fd, IOWatch::Event ev) {
+                char c;
+                CHECK(::read(fd, &c, 1) == 1);
+                CHECK(ev == IOWatch::Event::Read);
+                event_thread.set_value(std::this_thread::get_id());
+            });
+
+    char data[] = {1, 0};
+    (void) ::write(pipe_rw[1], data, 1u);
+
+    // the event was received in the thread of the assigned loop
+    CHECK(event_thread.get_future().get() == loop_thread.get_future().get());
+
+    // destroy the watch in its loop
+    std::promise<void> destroyed;
+    pool.post_to(pool.loop_for_fd(pipe_rw[0]), [&io, &destroyed] {
+        io.reset();
+        destroyed.set_value();
+    });
+    destroyed.get_future().wait();
+
+    ::close(pipe_rw[0]);
+    ::close(pipe_rw[1]);
+}
+#endif
+
+
+#ifdef __linux__
+TEST_CASE( "TimerWheel", "[core][event][TimerWheel]" )
+{
+    struct DummyWatch: Watch {
+        using Watch::Watch;
+        void _notify(uint32_t) override {}
+    };
+    EventLoop loop;
+    DummyWatch watch(loop);
+
+    TimerWheel wheel;
+    CHECK(wheel.next_expiry() == TimerWheel::no_expiry);
+
+    // expiries spanning all levels of the wheel
+    const TimerWheel::Tick expiries[] = {
+            1, 2, 255, 256, 257, 1000, 65535, 65536, 65537, 100000,
+            (1u << 24) - 1, 1u << 24, (1u << 24) + 300, 5'000'000'000,
+    };
+    std::vector<std::unique_ptr<TimerWheel::Entry>> entries;
+    for (auto exp : expiries) {
+        entries.push_back(std::make_unique<TimerWheel::Entry>(watch));
+        wheel.add(*entries.back(), exp);
+    }
+    // removed timer never fires
+    TimerWheel::Entry removed(watch);
+    wheel.add(removed, 500);
+    wheel.remove(removed);
+    CHECK(!removed.is_active());
+    CHECK(wheel.size() == std::size(expiries));
+
+    std::vector<TimerWheel::Tick> fired;
+    TimerWheel::Tick t = 0;
+    while (!wheel.empty()) {
+        t = std::min(wheel.next_expiry(), t + 7777);
+        wheel.advance(t, [&](TimerWheel::Entry& entry) {
+            CHECK(wheel.now() == entry.expires());
+            fired.push_back(entry.expires());
+        });
+    }
+    CHECK(fired == std::vector<TimerWheel::Tick>(std::begin(expiries), std::end(expiries)));
+
+    // restart from the callback (periodic timer)
+    TimerWheel::Entry periodic(watch);
+    int count = 0;
+    wheel.add(periodic, wheel.now() + 10);
+    wheel.advance(wheel.now() + 100, [&](TimerWheel::Entry& entry) {
+        ++count;
+        wheel.add(entry, entry.expires() + 10);
+    });
+    CHECK(count == 10);
+    wheel.remove(periodic);
+}
+#endif
+
+
 TEST_CASE( "Timer events", "[.][core][event][TimerWatch]" )
 {
     EventLoop loop;
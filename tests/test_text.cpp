@@ -0,0 +1,553 @@
+// test_text.cpp created on 2026-10-19 as part of xcikit project
+// https://github.com/rbrich/xcikit
+//
+// Copyright 2026 Radek Brich
+// Licensed under the Apache License, Version 2.0 (see LICENSE file)
+
+#include <catch2/catch.hpp>
+
+#include <xci/text/GlyphAtlas.h>
+#include <xci/text/GlyphCacheFile.h>
+#include <xci/text/DistanceField.h>
+#include <xci/text/ShapeCache.h>
+#include <xci/text/layout/Element.h>
+#include <xci/text/GlyphRasterizer.h>
+#include <xci/text/FontLibrary.h>
+#include <xci/core/Vfs.h>
+#include <xci/config.h>
+
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace xci::text;
+using namespace xci::text::layout;
+using xci::core::Vfs;
+using Result = GlyphAtlas::InsertResult;
+
+
+TEST_CASE( "Glyph atlas pages", "[GlyphAtlas]" )
+{
+    // each page fits exactly 4 glyphs of 30x30 (+ padding)
+    GlyphAtlas atlas(64, 2);
+    GlyphAtlas::Location loc[10];
+
+    for (int i = 0; i != 4; ++i) {
+        CHECK(atlas.insert({30, 30}, loc[i]) == Result::Inserted);
+        CHECK(loc[i].page == 0);
+    }
+    CHECK(atlas.page_count() == 1);
+
+    // page 0 is full -> new page
+    CHECK(atlas.insert({30, 30}, loc[4]) == Result::Inserted);
+    CHECK(loc[4].page == 1);
+    CHECK(atlas.page_count() == 2);
+    CHECK(loc[4].coords.x == 1);
+    CHECK(loc[4].coords.y == 1);
+    CHECK(loc[4].coords.size() == xci::core::Vec2u{30, 30});
+
+    // empty glyph doesn't take any space
+    GlyphAtlas::Location empty;
+    CHECK(atlas.insert({0, 10}, empty) == Result::Inserted);
+    CHECK(atlas.lookup(empty));
+
+    // too large
+    GlyphAtlas::Location large;
+    CHECK(atlas.insert({64, 64}, large) == Result::TooLarge);
+
+    CHECK(atlas.stats().misses == 7);
+    CHECK(atlas.stats().evictions == 0);
+}
+
+
+TEST_CASE( "Glyph atlas LRU eviction", "[GlyphAtlas]" )
+{
+    GlyphAtlas atlas(64, 2);
+    GlyphAtlas::Location loc[10];
+    for (int i = 0; i != 8; ++i)
+        REQUIRE(atlas.insert({30, 30}, loc[i]) == Result::Inserted);
+    CHECK(atlas.page_count() == 2);
+
+    // use page 0, so page 1 becomes least recently used
+    CHECK(atlas.lookup(loc[0]));
+    CHECK(atlas.stats().hits == 1);
+
+    // both pages full -> evict page 1
+    CHECK(atlas.insert({30, 30}, loc[8]) == Result::Evicted);
+    CHECK(loc[8].page == 1);
+    CHECK(atlas.stats().evictions == 1);
+
+    // glyphs from page 0 are still there, page 1 glyphs are stale
+    CHECK(atlas.lookup(loc[3]));
+    CHECK(!atlas.lookup(loc[4]));
+    CHECK(!atlas.lookup(loc[7]));
+    CHECK(atlas.lookup(loc[8]));
+    CHECK(atlas.stats().rerasterizations == 2);
+
+    // re-insert the stale glyph - fits into page 1 again
+    CHECK(atlas.insert({30, 30}, loc[4]) == Result::Inserted);
+    CHECK(loc[4].page == 1);
+    CHECK(atlas.lookup(loc[4]));
+
+    // clear drops everything
+    atlas.clear();
+    CHECK(!atlas.lookup(loc[0]));
+    CHECK(!atlas.lookup(loc[8]));
+    CHECK(atlas.insert({30, 30}, loc[0]) == Result::Inserted);
+    CHECK(loc[0].page == 0);
+    CHECK(atlas.page_count() == 2);
+}
+
+
+TEST_CASE( "Glyph atlas pages pinned by frame", "[GlyphAtlas]" )
+{
+    GlyphAtlas atlas(64, 2);
+    GlyphAtlas::Location loc[10];
+    for (int i = 0; i != 8; ++i)
+        REQUIRE(atlas.insert({30, 30}, loc[i]) == Result::Inserted);
+
+    // only page 0 is used in the frame -> page 1 can be evicted
+    atlas.begin_frame(1);
+    CHECK(atlas.lookup(loc[0]));
+    CHECK(atlas.insert({30, 30}, loc[8]) == Result::Evicted);
+    CHECK(loc[8].page == 1);
+
+    // both pages are used in the frame -> nothing is evicted
+    for (int i = 0; i != 3; ++i)
+        REQUIRE(atlas.insert({30, 30}, loc[9]) == Result::Inserted);
+    CHECK(atlas.insert({30, 30}, loc[9]) == Result::Full);
+    CHECK(atlas.insert({30, 30}, loc[9]) == Result::Full);
+    CHECK(atlas.frame_overflows() == 2);
+    CHECK(atlas.stats().overflows == 2);
+    CHECK(atlas.stats().evictions == 1);
+    CHECK(atlas.lookup(loc[0]));
+    CHECK(atlas.lookup(loc[8]));
+
+    // next frame uses only page 1 -> page 0 is evicted
+    atlas.begin_frame(2);
+    CHECK(atlas.frame_overflows() == 0);
+    CHECK(atlas.lookup(loc[8]));
+    CHECK(atlas.insert({30, 30}, loc[9]) == Result::Evicted);
+    CHECK(loc[9].page == 0);
+    CHECK(!atlas.lookup(loc[0]));
+}
+
+
+TEST_CASE( "Glyph atlas shared in frame", "[GlyphAtlas]" )
+{
+    // Two layouts share a font, each starts the frame when updated
+    GlyphAtlas atlas(64, 2);
+    GlyphAtlas::Location first[4], second[5];
+    for (auto& loc : first)
+        REQUIRE(atlas.insert({30, 30}, loc) == Result::Inserted);
+    CHECK(first[3].page == 0);
+
+    // frame 1: first layout uses its glyphs on page 0
+    atlas.begin_frame(1);
+    for (auto& loc : first)
+        CHECK(atlas.lookup(loc));
+    // second layout starts the same frame, page 0 stays pinned
+    atlas.begin_frame(1);
+    for (auto& loc : second)
+        CHECK(atlas.insert({30, 30}, loc) != Result::Evicted);
+    CHECK(atlas.frame_overflows() == 1);  // the last glyph doesn't fit
+    for (auto& loc : first)
+        CHECK(atlas.lookup(loc));
+
+    // frame 2: only the second layout is drawn, page 0 can be reused
+    atlas.begin_frame(2);
+    CHECK(atlas.frame_overflows() == 0);
+    for (int i = 0; i != 4; ++i)
+        CHECK(atlas.lookup(second[i]));
+    CHECK(atlas.insert({30, 30}, second[4]) == Result::Evicted);
+    CHECK(second[4].page == 0);
+    CHECK(!atlas.lookup(first[0]));
+}
+
+TEST_CASE( "Glyph atlas restored pages", "[GlyphAtlas]" )
+{
+    GlyphAtlas atlas(64, 2);
+    GlyphAtlas::Location loc[4];
+
+    // restored page doesn't accept new glyphs
+    CHECK(atlas.add_full_page() == 0);
+    loc[0] = {{1, 1, 30, 30}, 0, atlas.page_epoch(0)};
+    CHECK(atlas.is_valid(loc[0]));
+    CHECK(atlas.insert({30, 30}, loc[1]) == Result::Inserted);
+    CHECK(loc[1].page == 1);
+
+    // max_pages reached
+    CHECK(atlas.add_full_page() == -1);
+
+    // restored page is evicted as usual
+    CHECK(atlas.lookup(loc[1]));
+    for (int i = 0; i != 3; ++i)
+        CHECK(atlas.insert({30, 30}, loc[2]) == Result::Inserted);
+    CHECK(atlas.insert({30, 30}, loc[3]) == Result::Evicted);
+    CHECK(loc[3].page == 0);
+    CHECK(!atlas.is_valid(loc[0]));
+    CHECK(atlas.is_valid(loc[3]));
+    CHECK(atlas.stats().rerasterizations == 0);
+}
+
+
+TEST_CASE( "Signed distance field", "[DistanceField]" )
+{
+    // 10x10 square in 20x20 bitmap
+    std::vector<uint8_t> bitmap(20 * 20, 0);
+    for (unsigned y = 5; y != 15; ++y)
+        for (unsigned x = 5; x != 15; ++x)
+            bitmap[y * 20 + x] = 255;
+
+    DistanceField sdf(4);
+    const auto size = sdf.generate(bitmap.data(), {20, 20});
+    CHECK(size == xci::core::Vec2u{28, 28});
+    auto at = [&](unsigned x, unsigned y) { return int(sdf.data()[(y + 4) * 28 + x + 4]); };
+
+    // far inside / outside is saturated
+    CHECK(at(10, 10) == 255);
+    CHECK(at(0, 0) == 0);
+    CHECK(sdf.data()[0] == 0);
+    // hard edge lies between the pixels, the field is symmetric around it
+    CHECK(at(5, 10) > 128);
+    CHECK(at(4, 10) < 128);
+    CHECK(at(5, 10) + at(4, 10) == Approx(255).margin(1));
+    CHECK(at(3, 10) < at(4, 10));
+    // distance to the nearest glyph pixel (corner), spread is 4 px
+    CHECK(at(3, 3) == Approx(255 * (0.5 - std::sqrt(8.0) / 8)).margin(1));
+
+    // half covered pixels - the edge is in their middle
+    for (unsigned y = 5; y != 15; ++y)
+        bitmap[y * 20 + 15] = 128;
+    sdf.generate(bitmap.data(), {20, 20});
+    CHECK(at(15, 10) == Approx(128).margin(1));
+}
+
+
+TEST_CASE( "Element stream", "[ElementStream]" )
+{
+    ElementStream stream;
+    stream.add(ElementOp::SetColor, xci::graphics::Color(1, 2, 3));
+    stream.add(ElementOp::AddWord, "hello");
+    stream.add(ElementOp::AddSpace);
+    stream.add(ElementOp::AddWord, std::string("world"));
+    stream.add(ElementOp::AddWord, "hello");
+    stream.add(ElementOp::AddWord, std::string(20000, 'x'));  // bigger than pool chunk / 4
+    stream.add(ElementOp::AddWord, "");
+    CHECK(stream.size() == 7);
+    CHECK(stream.op(0) == ElementOp::SetColor);
+    CHECK(stream.op(2) == ElementOp::AddSpace);
+
+    // repeated strings are stored once
+    CHECK(stream.string_count() == 4);
+    CHECK(stream.string(0) == "hello");
+    CHECK(stream.string(1) == "world");
+    CHECK(stream.string(2).size() == 20000);
+    CHECK(stream.string(3).empty());
+
+    // the strings don't move when the pool grows
+    const auto* hello = stream.string(0).data();
+    for (int i = 0; i != 20000; ++i)
+        stream.add(ElementOp::AddWord, std::to_string(i));
+    CHECK(stream.string_count() == 20004);
+    CHECK(stream.string(0).data() == hello);
+    CHECK(stream.string(1) == "world");
+    CHECK(stream.string(20003) == "19999");
+
+    stream.set_string(3, "hello");
+    stream.truncate(5);
+    CHECK(stream.size() == 5);
+    CHECK(stream.string_count() == 20004);
+
+    // released references outnumber the elements -> compact
+    CHECK(stream.needs_compact());
+    const auto memory_size = stream.memory_size();
+    stream.compact();
+    CHECK(!stream.needs_compact());
+    CHECK(stream.size() == 5);
+    CHECK(stream.op(3) == ElementOp::AddWord);
+    CHECK(stream.string_count() == 1);
+    CHECK(stream.string(0) == "hello");
+    CHECK(stream.memory_size() < memory_size);
+
+    stream.clear();
+    CHECK(stream.size() == 0);
+    CHECK(stream.string_count() == 0);
+}
+
+
+TEST_CASE( "Shape cache LRU", "[ShapeCache]" )
+{
+    ShapeCache cache(2);
+    const ShapedRun run {{1, 'a', {}, {10.f, 0.f}}};
+    CHECK(cache.find({0, 12, 0, "a"}) == nullptr);
+    cache.insert({0, 12, 0, "a"}, run);
+    cache.insert({0, 12, 0, "b"}, run);
+
+    // the key includes face, size and features
+    CHECK(cache.find({0, 12, 0, "a"}) != nullptr);
+    CHECK(cache.find({1, 12, 0, "a"}) == nullptr);
+    CHECK(cache.find({0, 14, 0, "a"}) == nullptr);
+    CHECK(cache.find({0, 12, 1, "a"}) == nullptr);
+
+    // "b" is least recently used
+    cache.insert({0, 12, 0, "c"}, run);
+    CHECK(cache.size() == 2);
+    CHECK(cache.find({0, 12, 0, "b"}) == nullptr);
+    const auto* found = cache.find({0, 12, 0, "a"});
+    REQUIRE(found != nullptr);
+    CHECK(found->size() == 1);
+    CHECK((*found)[0].advance.x == 10.f);
+    CHECK(cache.stats().hits == 2);
+    CHECK(cache.stats().misses == 5);
+    CHECK(cache.stats().evictions == 1);
+
+    // disabled cache
+    cache.set_capacity(0);
+    CHECK(cache.size() == 0);
+    CHECK(cache.insert({0, 12, 0, "a"}, run).size() == 1);
+    CHECK(cache.find({0, 12, 0, "a"}) == nullptr);
+}
+
+
+TEST_CASE( "Glyph cache file", "[GlyphCacheFile]" )
+{
+    const auto path = (std::filesystem::temp_directory_path() / "xci_test_glyph_cache.bin").string();
+    constexpr uint32_t page_size = 16;
+    std::vector<uint8_t> pixels(2 * page_size * page_size);
+    for (size_t i = 0; i != pixels.size(); ++i)
+        pixels[i] = uint8_t(i * 7);
+    const std::vector<const uint8_t*> pages {pixels.data(), pixels.data() + page_size * page_size};
+    const std::vector<GlyphCacheFile::Face> faces {{0x1234, 0, 0}, {0x5678, 1, 1}};
+    std::vector<GlyphCacheFile::Glyph> glyphs {
+            {0, 12, 'a', 0, 1, 2, 5, 6, 1, 6, 7.5f},
+            {1, 12, 'b', 1, 10, 10, 6, 6, 0, 6, 6.0f},
+            {0, 12, ' ', 0, 0, 0, 0, 0, 0, 0, 4.0f},  // empty
+    };
+
+    SECTION("round-trip") {
+        REQUIRE(GlyphCacheFile::write(path, page_size, faces, glyphs, pages));
+        GlyphCacheFile file;
+        REQUIRE(file.read(path));
+        CHECK(file.page_size() == page_size);
+        CHECK(file.page_count() == 2);
+        REQUIRE(file.faces().size() == 2);
+        CHECK(file.faces()[1].hash == 0x5678);
+        CHECK(file.faces()[1].face_index == 1);
+        REQUIRE(file.glyphs().size() == 3);
+        CHECK(file.glyphs()[0].code_point == 'a');
+        CHECK(file.glyphs()[1].x == 10);
+        CHECK(file.glyphs()[0].advance == 7.5f);
+        for (const auto& glyph : file.glyphs())
+            CHECK(file.is_valid(glyph));
+        CHECK(std::equal(pixels.begin(), pixels.end(), file.page_pixels(0)));
+
+        // rewriting the file doesn't modify the mapped content
+        glyphs.pop_back();
+        REQUIRE(GlyphCacheFile::write(path, page_size, faces, glyphs, pages));
+        CHECK(file.glyphs().size() == 3);
+        CHECK(file.glyphs()[2].code_point == ' ');
+        CHECK(!std::filesystem::exists(path + ".tmp"));
+        GlyphCacheFile file2;
+        REQUIRE(file2.read(path));
+        CHECK(file2.glyphs().size() == 2);
+    }
+
+    SECTION("glyphs out of bounds") {
+        glyphs.push_back({0, 12, 'c', 0, 0xFFFFFFF0, 0, 0x20, 4, 0, 0, 1.0f});  // x + w wraps
+        glyphs.push_back({0, 12, 'd', 0, 0, 0xFFFFFFF0, 4, 0x20, 0, 0, 1.0f});  // y + h wraps
+        glyphs.push_back({0, 12, 'e', 0, 12, 0, 5, 4, 0, 0, 1.0f});  // doesn't fit
+        glyphs.push_back({0, 12, 'f', 2, 0, 0, 4, 4, 0, 0, 1.0f});  // no such page
+        glyphs.push_back({2, 12, 'g', 0, 0, 0, 4, 4, 0, 0, 1.0f});  // no such face
+        glyphs.push_back({0, 0x1000000, 'h', 0, 0, 0, 0, 0, 0, 0, 1.0f});  // size too large for key
+        glyphs.push_back({0, 12, 0x1000000, 0, 0, 0, 0, 0, 0, 0, 1.0f});  // code point too large for key
+        REQUIRE(GlyphCacheFile::write(path, page_size, faces, glyphs, pages));
+        GlyphCacheFile file;
+        REQUIRE(file.read(path));
+        REQUIRE(file.glyphs().size() == 10);
+        CHECK(file.is_valid(file.glyphs()[2]));
+        for (size_t i = 3; i != 10; ++i)
+            CHECK(!file.is_valid(file.glyphs()[i]));
+    }
+
+    SECTION("corrupt file") {
+        REQUIRE(GlyphCacheFile::write(path, page_size, faces, glyphs, pages));
+        std::string content;
+        {
+            std::ifstream f(path, std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(f), {});
+        }
+        auto rewrite = [&path](const std::string& data) {
+            std::ofstream f(path, std::ios::binary | std::ios::trunc);
+            f << data;
+        };
+        GlyphCacheFile file;
+
+        // truncated
+        rewrite(content.substr(0, content.size() - 1));
+        CHECK(!file.read(path));
+        rewrite(content.substr(0, 10));
+        CHECK(!file.read(path));
+
+        // bad magic
+        auto bad = content;
+        bad[0] ^= 0x7F;
+        rewrite(bad);
+        CHECK(!file.read(path));
+
+        // page count doesn't match the size (the product would overflow)
+        bad = content;
+        const uint32_t huge_count = 0xFFFFFFFF;
+        std::memcpy(&bad[12], &huge_count, sizeof(huge_count));
+        rewrite(bad);
+        CHECK(!file.read(path));
+
+        // glyph count too large
+        bad = content;
+        std::memcpy(&bad[20], &huge_count, sizeof(huge_count));
+        rewrite(bad);
+        CHECK(!file.read(path));
+
+        // missing file
+        std::filesystem::remove(path);
+        CHECK(!file.read(path));
+    }
+
+    std::filesystem::remove(path);
+}
+
+
+TEST_CASE( "Glyph rasterizer", "[GlyphRasterizer]" )
+{
+    Vfs vfs;
+    vfs.mount(XCI_SHARE);
+    auto file = vfs.read_file("fonts/ShareTechMono/ShareTechMono-Regular.ttf");
+    REQUIRE(file.is_open());
+    auto face = FontLibrary::default_instance()->create_font_face();
+    REQUIRE(face->load_from_memory(file.content(), 0));
+
+    // two sizes, the key identifies the job
+    std::vector<GlyphRasterizer::Job> jobs;
+    for (unsigned size : {12u, 32u})
+        for (CodePoint c = 0x21; c != 0x7F; ++c)
+            jobs.push_back({face.get(), size, c, jobs.size()});
+
+    GlyphRasterizer rasterizer(2);
+    CHECK(rasterizer.num_threads() == 2);
+    CHECK(rasterizer.pending() == 0);
+    rasterizer.submit(jobs);
+    CHECK(rasterizer.pending() <= jobs.size());
+    rasterizer.wait();
+    CHECK(rasterizer.pending() == 0);
+    CHECK(rasterizer.has_results());
+
+    std::vector<GlyphRasterizer::Result> results;
+    rasterizer.collect(results);
+    CHECK(!rasterizer.has_results());
+    REQUIRE(results.size() == jobs.size());
+
+    // same bitmaps as rendered synchronously
+    std::sort(results.begin(), results.end(),
+            [](const auto& a, const auto& b) { return a.key < b.key; });
+    for (size_t i = 0; i != jobs.size(); ++i) {
+        const auto& job = jobs[i];
+        const auto& res = results[i];
+        REQUIRE(res.key == job.key);
+        face->set_size(job.size);
+        FontFace::Glyph glyph;
+        const auto glyph_index = face->get_glyph_index(job.code_point);
+        REQUIRE(face->render_glyph(glyph_index, glyph));
+        CHECK(res.glyph_index == glyph_index);
+        CHECK(res.bitmap_size == glyph.bitmap_size);
+        CHECK(res.bearing == glyph.bearing);
+        CHECK(res.advance == glyph.advance);
+        const size_t bitmap_bytes = size_t(glyph.bitmap_size.x) * glyph.bitmap_size.y;
+        REQUIRE(res.bitmap.size() == bitmap_bytes);
+        CHECK(std::equal(res.bitmap.begin(), res.bitmap.end(), glyph.bitmap_buffer));
+    }
+
+    // nothing more to collect
+    rasterizer.collect(results);
+    CHECK(results.size() == jobs.size());
+}
+
+
+TEST_CASE( "Glyph advance", "[FontFace]" )
+{
+    Vfs vfs;
+    vfs.mount(XCI_SHARE);
+    auto file = vfs.read_file("fonts/Enriqueta/Enriqueta-Regular.ttf");
+    REQUIRE(file.is_open());
+    auto face = FontLibrary::default_instance()->create_font_face();
+    REQUIRE(face->load_from_memory(file.content(), 0));
+
+    // same as rendered glyph, without the bitmap
+    for (unsigned size : {12u, 30u}) {
+        REQUIRE(face->set_size(size));
+        for (CodePoint c : U"Wil 1.") {
+            const auto glyph_index = face->get_glyph_index(c);
+            const float advance = face->glyph_advance(glyph_index);
+            FontFace::Glyph glyph;
+            REQUIRE(face->render_glyph(glyph_index, glyph));
+            CHECK(advance == glyph.advance.x);
+            CHECK(advance > 0.f);
+        }
+    }
+}
+
+#ifdef XCI_WITH_HARFBUZZ
+TEST_CASE( "Text shaping", "[FontFace]" )
+{
+    Vfs vfs;
+    vfs.mount(XCI_SHARE);
+    auto file = vfs.read_file("fonts/ShareTechMono/ShareTechMono-Regular.ttf");
+    REQUIRE(file.is_open());
+    auto face = FontLibrary::default_instance()->create_font_face();
+    REQUIRE(face->load_from_memory(file.content(), 0));
+    REQUIRE(face->set_size(16));
+
+    ShapedRun run;
+    SECTION( "nominal glyphs" ) {
+        REQUIRE(face->shape("Hello", "", run));
+        REQUIRE(run.size() == 5);
+        for (size_t i = 0; i != run.size(); ++i) {
+            const CodePoint c = "Hello"[i];
+            CHECK(run[i].code_point == c);
+            CHECK(run[i].glyph_index == face->get_glyph_index(c));
+        }
+    }
+
+    SECTION( "ligature" ) {
+        // the font has "fi" and "fl" ligatures
+        REQUIRE(face->shape("fi", "", run));
+        REQUIRE(run.size() == 1);
+        CHECK(run[0].code_point == 0);
+        CHECK(run[0].glyph_index != face->get_glyph_index('f'));
+
+        REQUIRE(face->shape("fi", "-liga", run));
+        REQUIRE(run.size() == 2);
+        CHECK(run[0].glyph_index == face->get_glyph_index('f'));
+        CHECK(run[1].glyph_index == face->get_glyph_index('i'));
+    }
+
+    SECTION( "size change" ) {
+        REQUIRE(face->shape("x", "", run));
+        REQUIRE(run.size() == 1);
+        const float advance = run[0].advance.x;
+        CHECK(advance > 0.f);
+
+        // the shaper must pick up the new size
+        REQUIRE(face->set_size(32));
+        REQUIRE(face->shape("x", "", run));
+        REQUIRE(run.size() == 1);
+        CHECK(std::abs(run[0].advance.x - 2 * advance) <= 1.f);
+
+        // shaping again without resize gives the same result
+        REQUIRE(face->shape("x", "", run));
+        CHECK(std::abs(run[0].advance.x - 2 * advance) <= 1.f);
+    }
+}
+#endif
@@ -22,13 +22,230 @@
 #include <cstring>
 #include <utility>
 #include <string_view>
+#include <algorithm>
 
 #include <sys/types.h>
+#include <sys/mman.h>
 
 using namespace xci::core;
 using namespace xci::core::argparser;
 
 
+// Content is scanned in chunks of this size (Hyperscan streaming mode).
+// Files with NUL byte in the first chunk are considered binary and skipped.
+static constexpr size_t c_grep_chunk_size = 64 * 1024;
+
+
+struct Theme {
+    std::string normal;
+    std::string dir;
+    std::string file_dir;
+    std::string file_name;
+    std::string line_num;
+    std::string highlight;
+};
+
+
+static bool compile_pattern(const char* pattern, bool fixed, unsigned flags, unsigned mode,
+                            hs_database_t** db)
+{
+    hs_compile_error_t *re_compile_err;
+    if (fixed) {
+#ifdef HAVE_HS_COMPILE_LIT
+        if (hs_compile_lit(pattern, flags, strlen(pattern), mode, nullptr,
+                db, &re_compile_err) != HS_SUCCESS) {
+            fmt::print(stderr,"ff: hs_compile_lit({}): {}\n", pattern, re_compile_err->message);
+            hs_free_compile_error(re_compile_err);
+            return false;
+        }
+#endif
+    } else {
+        if (hs_compile(pattern, flags, mode, nullptr, db, &re_compile_err) != HS_SUCCESS) {
+            fmt::print(stderr,"ff: hs_compile({}): {}\n", pattern, re_compile_err->message);
+            hs_free_compile_error(re_compile_err);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// Collects content matches of a single file and formats them grep-like:
+/// <file>:<line number>:<line with highlighted matches>
+///
+/// Hyperscan reports matches ordered by end offset, so all matches on one line
+/// come in a row. The line is kept pending until a match on another line arrives.
+class GrepOutput {
+public:
+    /// \param som     Start of match is reported (HS_FLAG_SOM_LEFTMOST),
+    ///                 otherwise the matches are not highlighted.
+    GrepOutput(std::string_view content, std::string_view file_name,
+               const Theme& theme, bool som)
+        : m_content(content), m_file_name(file_name), m_theme(theme), m_som(som) {}
+
+    void add_match(size_t from, size_t to) {
+        const size_t pos = m_som ? from : (to == 0 ? 0 : to - 1);
+        if (!m_pending || pos >= m_line_end) {
+            flush_line();
+            open_line(pos);
+        }
+        if (!m_som)
+            return;
+        from = std::max(from, m_line_begin);
+        to = std::min(to, m_line_end);
+        if (from >= to)
+            return;
+        if (!m_highlights.empty() && from <= m_highlights.back().second) {
+            // overlapping or adjacent - merge
+            auto& last = m_highlights.back();
+            last.first = std::min(last.first, from);
+            last.second = std::max(last.second, to);
+            return;
+        }
+        m_highlights.emplace_back(from, to);
+    }
+
+    /// Write out the pending line and all buffered output
+    void finish() {
+        flush_line();
+        if (!m_out.empty())
+            fwrite(m_out.data(), 1, m_out.size(), stdout);
+        m_out.clear();
+    }
+
+private:
+    void open_line(size_t pos) {
+        const auto before = m_content.substr(m_counted_to, pos - m_counted_to);
+        const auto nl = before.rfind('\n');
+        m_line_begin = nl == std::string_view::npos ? m_counted_to : m_counted_to + nl + 1;
+        m_line_num += std::count(m_content.begin() + m_counted_to,
+                                 m_content.begin() + m_line_begin, '\n');
+        m_counted_to = m_line_begin;
+        m_line_end = m_content.find('\n', pos);
+        if (m_line_end == std::string_view::npos)
+            m_line_end = m_content.size();
+        m_pending = true;
+    }
+
+    void flush_line() {
+        if (!m_pending)
+            return;
+        m_out += m_theme.file_dir;
+        m_out += m_file_name;
+        m_out += m_theme.normal;
+        m_out += ':';
+        m_out += m_theme.line_num;
+        m_out += std::to_string(m_line_num);
+        m_out += m_theme.normal;
+        m_out += ':';
+        size_t pos = m_line_begin;
+        for (const auto& [so, eo] : m_highlights) {
+            m_out += m_content.substr(pos, so - pos);
+            m_out += m_theme.highlight;
+            m_out += m_content.substr(so, eo - so);
+            m_out += m_theme.normal;
+            pos = eo;
+        }
+        m_out += m_content.substr(pos, m_line_end - pos);
+        m_out += '\n';
+        m_highlights.clear();
+        m_pending = false;
+        // Don't let the output grow unbounded on big files with many matches.
+        // Each fwrite is atomic, so whole lines are never mixed with other threads.
+        if (m_out.size() >= c_grep_chunk_size) {
+            fwrite(m_out.data(), 1, m_out.size(), stdout);
+            m_out.clear();
+        }
+    }
+
+    std::string_view m_content;
+    std::string_view m_file_name;
+    const Theme& m_theme;
+    bool m_som;
+    std::string m_out;
+    std::vector<std::pair<size_t, size_t>> m_highlights;  // in pending line
+    size_t m_line_begin = 0;
+    size_t m_line_end = 0;  // points to '\n' or to the end of content
+    size_t m_line_num = 1;  // line number of pending line
+    size_t m_counted_to = 0;  // newlines before this offset are counted in m_line_num
+    bool m_pending = false;
+};
+
+
+/// Search content of a file using Hyperscan in streaming mode.
+/// The file is mmapped and scanned in chunks, the match offsets then point
+/// directly into the mapped content.
+static void grep_file(const FileTree::PathNode& path, const hs_database_t* db,
+                      const Theme& theme, bool som)
+{
+    thread_local hs_scratch_t *scratch = nullptr;
+    if (scratch == nullptr && hs_alloc_scratch(db, &scratch) != HS_SUCCESS) {
+        fmt::print(stderr,"ff: hs_alloc_scratch: Unable to allocate scratch space.\n");
+        return;
+    }
+
+    int fd = path.open_file();
+    if (fd == -1) {
+        fmt::print(stderr,"ff: open({}): {}\n", path.file_name(), errno_str());
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        fmt::print(stderr,"ff: stat({}): {}\n", path.file_name(), errno_str());
+        close(fd);
+        return;
+    }
+    // skip special files (fifo, devices) and empty files (can't be mmapped)
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+    const auto size = size_t(st.st_size);
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        fmt::print(stderr,"ff: mmap({}): {}\n", path.file_name(), errno_str());
+        return;
+    }
+    madvise(addr, size, MADV_SEQUENTIAL);
+    const auto* data = static_cast<const char*>(addr);
+
+    if (memchr(data, 0, std::min(size, c_grep_chunk_size)) != nullptr) {
+        munmap(addr, size);
+        return;  // binary file
+    }
+
+    const auto file_name = path.file_name();
+    GrepOutput output({data, size}, file_name, theme, som);
+    auto on_match = [] (unsigned int id, unsigned long long from,
+                        unsigned long long to, unsigned int flags, void *ctx)
+    {
+        static_cast<GrepOutput*>(ctx)->add_match(size_t(from), size_t(to));
+        return 0;
+    };
+
+    hs_stream_t* stream = nullptr;
+    if (hs_open_stream(db, 0, &stream) != HS_SUCCESS) {
+        fmt::print(stderr,"ff: hs_open_stream({}): Unable to open stream\n", file_name);
+        munmap(addr, size);
+        return;
+    }
+    for (size_t offset = 0; offset < size; offset += c_grep_chunk_size) {
+        const auto len = unsigned(std::min(size - offset, c_grep_chunk_size));
+        auto r = hs_scan_stream(stream, data + offset, len, 0, scratch, on_match, &output);
+        if (r != HS_SUCCESS) {
+            fmt::print(stderr,"ff: hs_scan_stream({}): Unable to scan ({})\n", file_name, r);
+            break;
+        }
+    }
+    // reports matches at end of data, e.g. "foo$"
+    hs_close_stream(stream, scratch, on_match, &output);
+
+    output.finish();
+    munmap(addr, size);
+}
+
+
 int main(int argc, const char* argv[])
 {
     bool fixed = false;
@@ -41,6 +258,7 @@ int main(int argc, const char* argv[])
     int jobs = 8;
     std::vector<const char*> files;
     const char* pattern = nullptr;
+    const char* grep_pattern = nullptr;
 
     TermCtl& term = TermCtl::stdout_instance();
 
@@ -49,6 +267,7 @@ int main(int argc, const char* argv[])
             Option("-F, --fixed", "Match literal string instead of (default) regex", fixed),
 #endif
             Option("-i, --ignore-case", "Enable case insensitive matching", ignore_case),
+            Option("-g, --grep PATTERN", "Search file content (skips binary files)", grep_pattern),
             Option("-H, --search-hidden", "Don't skip hidden files", show_hidden),
             Option("-D, --search-dirnames", "Don't skip directory entries", show_dirs),
             Option("-S, --search-in-special-dirs", "Allow descending into special directories: " + FileTree::default_ignore_list(", "), search_in_special_dirs),
@@ -60,7 +279,7 @@ int main(int argc, const char* argv[])
             Option("-h, --help", "Show help", show_help),
             Option("[PATTERN]", "File name pattern (Perl-style regex)", pattern),
             Option("-- FILE ...", "Files and/or directories to scan", files),
-    } (argv);
+    }.enable_response_files() (argv);
 
     if (show_version) {
         term.print("{t:bold}ff{t:normal} {}\n", "0.2");
@@ -74,41 +293,35 @@ int main(int argc, const char* argv[])
 
     hs_database_t *re_db = nullptr;
     if (pattern) {
-        int flags = 0;
+        unsigned flags = 0;
         if (ignore_case)
             flags |= HS_FLAG_CASELESS;
         // enable start offset only if we have color output
         if (term.is_tty())
             flags |= HS_FLAG_SOM_LEFTMOST;
-        hs_compile_error_t *re_compile_err;
-        if (fixed) {
-#ifdef HAVE_HS_COMPILE_LIT
-            if (hs_compile_lit(pattern, flags,
-                    strlen(pattern), HS_MODE_BLOCK, nullptr,
-                    &re_db, &re_compile_err) != HS_SUCCESS) {
-                fmt::print(stderr,"ff: hs_compile_lit({}): {}\n", pattern, re_compile_err->message);
-                hs_free_compile_error(re_compile_err);
-                return 1;
-            }
-#endif
-        } else {
-            if (hs_compile(pattern, flags | HS_FLAG_DOTALL | HS_FLAG_UTF8 | HS_FLAG_UCP,
-                    HS_MODE_BLOCK, nullptr,
-                    &re_db, &re_compile_err) != HS_SUCCESS) {
-                fmt::print(stderr,"ff: hs_compile({}): {}\n", pattern, re_compile_err->message);
-                hs_free_compile_error(re_compile_err);
-                return 1;
-            }
-        }
+        if (!fixed)
+            flags |= HS_FLAG_DOTALL | HS_FLAG_UTF8 | HS_FLAG_UCP;
+        if (!compile_pattern(pattern, fixed, flags, HS_MODE_BLOCK, &re_db))
+            return 1;
     }
 
-    struct Theme {
-        std::string normal;
-        std::string dir;
-        std::string file_dir;
-        std::string file_name;
-        std::string highlight;
-    };
+    hs_database_t *grep_db = nullptr;
+    if (grep_pattern) {
+        // Content is not required to be valid UTF-8, so no HS_FLAG_UTF8 here.
+        // Same as grep, '^' and '$' match at line boundaries.
+        unsigned flags = 0;
+        unsigned mode = HS_MODE_STREAM;
+        if (ignore_case)
+            flags |= HS_FLAG_CASELESS;
+        if (term.is_tty()) {
+            flags |= HS_FLAG_SOM_LEFTMOST;
+            mode |= HS_MODE_SOM_HORIZON_LARGE;
+        }
+        if (!fixed)
+            flags |= HS_FLAG_MULTILINE;
+        if (!compile_pattern(grep_pattern, fixed, flags, mode, &grep_db))
+            return 1;
+    }
 
     // "cyanide"
     Theme theme {
@@ -116,13 +329,15 @@ int main(int argc, const char* argv[])
         .dir = term.bold().cyan().seq(),
         .file_dir = term.cyan().seq(),
         .file_name = term.normal().seq(),
+        .line_num = term.green().seq(),
         .highlight = term.bold().yellow().seq(),
     };
 
     FlatSet<dev_t> dev_ids;
 
     FileTree ft(jobs-1, jobs,
-                [show_hidden, show_dirs, single_device, pattern, &re_db, &theme, &dev_ids]
+                [show_hidden, show_dirs, single_device, pattern, &re_db, &grep_db, &theme, &dev_ids,
+                 som = term.is_tty()]
                 (const FileTree::PathNode& path, FileTree::Type t)
     {
         if (!show_hidden && path.component[0] == '.')
@@ -143,6 +358,8 @@ int main(int argc, const char* argv[])
                         return false;  // skip (different device ID)
                     }
                 }
+                if (grep_db)
+                    return true;  // searching content, don't report dirs
                 FALLTHROUGH;
             case FileTree::File:
                 if (pattern) {
@@ -169,6 +386,10 @@ int main(int argc, const char* argv[])
                     }
                     if (matches.empty())
                         return true;  // not matched
+                    if (grep_db) {
+                        grep_file(path, grep_db, theme, som);
+                        return true;
+                    }
                     const auto so = matches[0].first;
                     const auto eo = matches[0].second;
 
@@ -191,6 +412,9 @@ int main(int argc, const char* argv[])
                     out += std::string_view(name + eo);
                     out += theme.normal;
                     puts(out.c_str());
+                } else if (grep_db) {
+                    if (t == FileTree::File)
+                        grep_file(path, grep_db, theme, som);
                 } else {
                     std::string out;
                     if (t == FileTree::Directory) {
@@ -232,5 +456,6 @@ int main(int argc, const char* argv[])
     ft.worker();
 
     hs_free_database(re_db);
+    hs_free_database(grep_db);
     return 0;
 }
@@ -245,9 +245,8 @@ int main(int argc, char* argv[])
             Option("--pp-types", "Stop after resolve_types pass", [&opts]{ opts.compiler_flags |= Compiler::PPTypes; }),
             Option("--pp-nonlocals", "Stop after resolve_nonlocals pass", [&opts]{ opts.compiler_flags |= Compiler::PPNonlocals; }),
             Option("--no-std", "Do not load standard library", [&opts]{ opts.with_std_lib = false; }),
-            Option("[INPUT ...]", "Input files", [&input_files](const char* arg)
-                { input_files.emplace_back(arg); return true; }),
-    } (argv);
+            Option("[INPUT ...]", "Input files", input_files),
+    }.enable_response_files() (argv);
 
     if (expr) {
         evaluate(env, expr, opts);